@@ -1,12 +1,17 @@
 /////////////////////////////////////////////////////////////////////////
 // Dynamic bitset definition
 //
-// The number of bits may change dynamically.
+// The number of bits may change dynamically. Bits are packed into 64-bit
+// words in the order they are added (the first bit is bit 0 of the first
+// word), which matches the bit order of bytes::stream. The first word is
+// stored inline, so bitsets of up to 64 bits never allocate.
 /////////////////////////////////////////////////////////////////////////
 #pragma once
 
 #include <cassert>
 #include <bitset>
+#include <cstdint>
+#include <functional>
 #include <vector>
 
 namespace bytes
@@ -14,81 +19,192 @@ namespace bytes
 	struct dynamic_bitset
 	{
 		public:
+			// Aliases
+			using word_t = std::uint64_t;
+			static constexpr std::size_t word_bits = 64;
+
 			// Constructor / destructor
-			explicit dynamic_bitset() : bits({}) {}
+			explicit dynamic_bitset() : _size(0), _inline(0), _words({}) {}
 			~dynamic_bitset() {}
 
 			// Construct and add bits from vector
-			explicit dynamic_bitset(std::vector<bool> value) : bits({})
+			explicit dynamic_bitset(std::vector<bool> value) : _size(0), _inline(0), _words({})
 			{
 				for (auto i = value.cbegin(); i != value.cend(); i++)
-					bits.push_back(std::bitset<1>(*i));
+					push_back(*i);
 			}
 
 			// Construct and add bits from bitset
-			template <std::size_t n> explicit dynamic_bitset(std::bitset<n> value) : bits({})
+			template <std::size_t n> explicit dynamic_bitset(std::bitset<n> value) : _size(0), _inline(0), _words({})
 			{
 				add<n>(value);
 			}
 
 			// Copy construction / assignment
-			dynamic_bitset(const dynamic_bitset& bitset) : bits(bitset.bits) {}
+			dynamic_bitset(const dynamic_bitset& bitset) : _size(bitset._size), _inline(bitset._inline), _words(bitset._words) {}
 			dynamic_bitset& operator=(const dynamic_bitset& bitset)
 			{
-				bits = bitset.bits;
+				_size = bitset._size;
+				_inline = bitset._inline;
+				_words = bitset._words;
 				return *this;
 			}
 
 			// Move construction / assignment
-			dynamic_bitset(dynamic_bitset&& bitset) : bits(std::move(bitset.bits)) {}
+			dynamic_bitset(dynamic_bitset&& bitset) : _size(bitset._size), _inline(bitset._inline), _words(std::move(bitset._words))
+			{
+				bitset.clear();
+			}
 			dynamic_bitset& operator=(dynamic_bitset&& bitset)
 			{
-				bits = std::move(bitset.bits);
+				_size = bitset._size;
+				_inline = bitset._inline;
+				_words = std::move(bitset._words);
+				bitset.clear();
 				return *this;
 			}
 
-			// Convert to number
+			// Size information
+			std::size_t size() const noexcept { return _size; }
+			bool empty() const noexcept { return _size == 0; }
+
+			// Word access, where bits beyond size() are always zero
+			std::size_t word_count() const noexcept { return (_size + word_bits - 1) / word_bits; }
+			word_t word(std::size_t index) const noexcept { return index == 0 ? _inline : _words[index - 1]; }
+
+			// Number of bits in use within a specific word
+			std::size_t word_size(std::size_t index) const noexcept
+			{
+				return index + 1 < word_count() ? word_bits : _size - index * word_bits;
+			}
+
+			// Access a single bit
+			bool test(std::size_t index) const noexcept
+			{
+				assert(index < _size);
+				return (word(index / word_bits) >> (index % word_bits)) & 1;
+			}
+
+			// Convert to number (the first bit is the most significant)
 			std::size_t to_uint() const noexcept { return append_bits(0); }
 
 			// Hash
 			std::size_t hash() const
 			{
-				// Append bits to 1 such that "10" and "010" will yield different hashes
-				return std::hash<std::size_t>{}(append_bits(1));
+				// Include the size such that "10" and "010" will yield different hashes
+				std::size_t result = std::hash<std::size_t>{}(_size);
+				for (std::size_t i = 0; i < word_count(); i++)
+					result ^= std::hash<word_t>{}(word(i)) + 0x9E3779B97F4A7C15ull + (result << 6) + (result >> 2);
+
+				return result;
+			}
+
+			// Remove all bits
+			void clear() noexcept
+			{
+				_size = 0;
+				_inline = 0;
+				_words.clear();
 			}
 
-			// Adding a bits
+			// Adding bits
+			void push_back(bool value) { add(value ? 1 : 0, 1); }
+
 			template <std::size_t n> inline void add(std::bitset<n> value);
 
 			void add(const dynamic_bitset& value)
 			{
-				bits.insert(bits.end(), value.bits.begin(), value.bits.end());
+				for (std::size_t i = 0; i < value.word_count(); i++)
+					add(value.word(i), value.word_size(i));
 			}
 
-			// The data
-			std::vector<std::bitset<1>> bits;
+			// Add the lowest count bits of a word, starting with bit 0
+			void add(word_t value, std::size_t count)
+			{
+				assert(count <= word_bits);
+				if (count == 0)
+					return;
+
+				if (count < word_bits)
+					value &= (word_t { 1 } << count) - 1;
+
+				auto offset = _size % word_bits;
+				if (offset == 0)
+				{
+					push_word(value);
+				}
+				else
+				{
+					last_word() |= value << offset;
+					if (offset + count > word_bits)
+						push_word(value >> (word_bits - offset));
+				}
+
+				_size += count;
+			}
+
+			// Reverse the order of the bits in a word
+			static constexpr word_t reverse(word_t value) noexcept
+			{
+				value = ((value >> 1) & 0x5555555555555555ull) | ((value & 0x5555555555555555ull) << 1);
+				value = ((value >> 2) & 0x3333333333333333ull) | ((value & 0x3333333333333333ull) << 2);
+				value = ((value >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((value & 0x0F0F0F0F0F0F0F0Full) << 4);
+				value = ((value >> 8) & 0x00FF00FF00FF00FFull) | ((value & 0x00FF00FF00FF00FFull) << 8);
+				value = ((value >> 16) & 0x0000FFFF0000FFFFull) | ((value & 0x0000FFFF0000FFFFull) << 16);
+				return (value >> 32) | (value << 32);
+			}
 
 		private:
-			// Appends bits to a value
+			// Appends bits to a value, one word at a time
 			std::size_t append_bits(std::size_t value) const
 			{
-				for (auto i = bits.cbegin(); i != bits.cend(); i++)
-					value = (value << 1) | i->count();
+				for (std::size_t i = 0; i < word_count(); i++)
+				{
+					auto count = word_size(i);
+					auto reversed = reverse(word(i)) >> (word_bits - count);
+					value = count < word_bits ? (value << count) | reversed : reversed;
+				}
 				return value;
 			}
-	};
 
-	// Specialization for adding a single bit
-	template <> inline void dynamic_bitset::add<1>(std::bitset<1> value)
-	{
-		bits.push_back(value);
-	}
+			// Start a new word (the inline word is used for the first 64 bits)
+			void push_word(word_t value)
+			{
+				if (_size == 0)
+					_inline = value;
+				else
+					_words.push_back(value);
+			}
+
+			word_t& last_word() { return _words.empty() ? _inline : _words.back(); }
 
-	// General template for adding bits
+			// The data
+			std::size_t _size;
+			word_t _inline;
+			std::vector<word_t> _words;
+	};
+
+	// Add the bits of a bitset, starting with the most significant bit
 	template <std::size_t n> inline void dynamic_bitset::add(std::bitset<n> value)
 	{
-		add(std::bitset<1>(value[n-1]));
-		add(std::bitset<n-1>(value.to_ulong()));
+		if constexpr (n <= word_bits)
+		{
+			if constexpr (n > 0)
+				add(reverse(value.to_ullong()) >> (word_bits - n), n);
+		}
+		else
+		{
+			// Add the bits in chunks of at most a word, from the most significant chunk
+			const std::bitset<n> mask { ~word_t { 0 } };
+			for (std::size_t remaining = n; remaining > 0;)
+			{
+				auto count = remaining < word_bits ? remaining : word_bits;
+				remaining -= count;
+
+				auto chunk = ((value >> remaining) & mask).to_ullong();
+				add(reverse(chunk) >> (word_bits - count), count);
+			}
+		}
 	}
 }
 
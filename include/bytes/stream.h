@@ -6,8 +6,10 @@
 #pragma once
 
 #include <cassert>
+#include <bit>
 #include <bitset>
 #include <cstdint>
+#include <cstring>
 #include <vector>
 
 namespace bytes
@@ -37,20 +39,37 @@ namespace bytes
 
 			// Public interface
 			inline void put_fast(byte_t byte);
+			inline void put_repeat(std::size_t distance, std::size_t count);
+			inline byte_t* put_span(std::size_t count);
 			void put(byte_t byte);
 			template <std::size_t n> inline void put_bits(std::bitset<n>);
 			void put_bits(const struct dynamic_bitset&);
+			void put_word(std::uint64_t word, std::size_t count);
+			void put_size(std::size_t size);
+			void put_bytes(const byte_t* data, std::size_t count);
 
 			byte_t read();
 			byte_t peek() const;
 			template <std::size_t n> std::bitset<n> read_bits();
 			template <std::size_t n> std::bitset<n> peek_bits() const;
+			std::uint64_t read_word(std::size_t count);
+			bool read_size(std::size_t& size);
+
+			// Peek the next 64 bits, where peek_word_fast requires 8 bytes to be available
+			std::uint64_t peek_word() const;
+			inline std::uint64_t peek_word_fast() const;
+			inline void skip_bits(std::size_t count);
 
 			void seek(std::size_t index, byte_t bitindex = 0);
+			void align();
+			void allocate(std::size_t count);
+			void clear();
+			buffer_t release();
 
 			bool at_end() const { return _index >= _buffer.size(); }
 			std::size_t index() const { return _index; }
 			byte_t bitindex() const { return _bitindex; }
+			std::size_t bits_remaining() const { return (_buffer.size() - _index) * 8 - _bitindex; }
 
 			const buffer_t& buffer() const { return _buffer; }
 
@@ -69,6 +88,59 @@ namespace bytes
 		_buffer[_index++] = byte;
 	}
 
+	// Repeat count bytes starting distance bytes back, where the repeated bytes may overlap the new ones
+	void stream::put_repeat(std::size_t distance, std::size_t count)
+	{
+		assert(distance > 0 && distance <= _index);
+		assert(_index + count <= _buffer.size());
+		assert(_bitindex == 0);
+
+		auto destination = _buffer.data() + _index;
+		_index += count;
+
+		// Copy the largest chunks that do not overlap, where every chunk doubles the repeated pattern
+		while (count > 0)
+		{
+			auto chunk = distance < count ? distance : count;
+			std::memcpy(destination, destination - distance, chunk);
+			destination += chunk;
+			count -= chunk;
+			distance += chunk;
+		}
+	}
+
+	// Move over count allocated bytes, returning where they start so that they can be written directly
+	stream::byte_t* stream::put_span(std::size_t count)
+	{
+		assert(_index + count <= _buffer.size());
+		assert(_bitindex == 0);
+
+		auto result = _buffer.data() + _index;
+		_index += count;
+		return result;
+	}
+
+	// Peek the next 64 bits without bounds checking (bits beyond the first 64 - bitindex are zero)
+	std::uint64_t stream::peek_word_fast() const
+	{
+		assert(_index + 8 <= _buffer.size());
+
+		std::uint64_t word;
+		std::memcpy(&word, _buffer.data() + _index, sizeof(word));
+		if constexpr (std::endian::native == std::endian::big)
+			word = __builtin_bswap64(word);
+
+		return word >> _bitindex;
+	}
+
+	// Move the position forward without reading
+	void stream::skip_bits(std::size_t count)
+	{
+		auto bits = _bitindex + count;
+		_index += bits / 8;
+		_bitindex = static_cast<byte_t>(bits % 8);
+	}
+
 	// Specialization for writing 1 bit to the stream
 	template <> inline void stream::put_bits(std::bitset<1> bits)
 	{
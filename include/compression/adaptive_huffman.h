@@ -0,0 +1,27 @@
+/////////////////////////////////////////////////////////////////////////
+// Adaptive Huffman coding compression algorithm
+//
+// Encodes the input without storing a code table. The encoder and decoder
+// both start from equal frequencies and rebuild their codes from the
+// symbols seen so far at fixed points in the stream. The end of the data
+// is marked by a dedicated symbol. The encoder first counts the bits of
+// the codes, and stores data that they would not make smaller as-is.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <bytes/stream.h>
+
+namespace compression
+{
+	class histogram;
+
+	class adaptive_huffman
+	{
+		public:
+			static bool compress(bytes::stream& input, bytes::stream& output);
+			static bool decompress(bytes::stream& input, bytes::stream& output);
+
+			// Approximate size in bytes of the compressed output for data with the given byte frequencies
+			static std::size_t estimate(const histogram& freqs);
+	};
+}
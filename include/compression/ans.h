@@ -0,0 +1,392 @@
+/////////////////////////////////////////////////////////////////////////
+// Tables for asymmetric numeral systems
+//
+// Normalized frequencies and the encoding and decoding tables built from
+// them, shared by the algorithms based on tANS. All tables have the same
+// number of states, so a coder may switch tables between symbols as long
+// as the decoder switches in the same way.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <bytes/stream.h>
+#include <compression/histogram.h>
+
+namespace compression::ans
+{
+	using byte = bytes::stream::byte_t;
+
+	// Number of bits of the coder state
+	constexpr std::size_t table_log = 11;
+	constexpr std::size_t table_size = std::size_t { 1 } << table_log;
+
+	using normalized_t = std::array<std::uint32_t, 256>;
+
+	// Number of values coded at a time, which bounds the memory of the coders besides the data
+	constexpr std::size_t chunk_size = std::size_t { 1 } << 16;
+
+	// Scale the frequencies to a total of table_size, keeping every occurring byte value
+	inline normalized_t normalize(const histogram& freqs)
+	{
+		normalized_t result {};
+		if (freqs.total() == 0)
+			return result;
+
+		std::int64_t sum { 0 };
+		for (std::size_t value = 0; value < result.size(); value++)
+		{
+			if (freqs[static_cast<byte>(value)] == 0)
+				continue;
+
+			auto scaled = static_cast<std::uint64_t>(freqs[static_cast<byte>(value)]) * table_size / freqs.total();
+			result[value] = static_cast<std::uint32_t>(std::max<std::uint64_t>(scaled, 1));
+			sum += result[value];
+		}
+
+		// Give the remainder to the most frequent value, or take the excess from the largest values
+		auto order = freqs.sorted();
+		if (sum < static_cast<std::int64_t>(table_size))
+			result[order.front()] += static_cast<std::uint32_t>(table_size - sum);
+
+		while (sum > static_cast<std::int64_t>(table_size))
+		{
+			for (auto i = order.cbegin(); i != order.cend() && sum > static_cast<std::int64_t>(table_size); i++)
+			{
+				if (result[*i] > 1)
+				{
+					--result[*i];
+					--sum;
+				}
+			}
+		}
+
+		// A single value leaves one state to another value, so that a run of it still takes a bit every
+		// table_size values, which bounds the count of a block by its bits
+		if (result[order.front()] == table_size)
+		{
+			--result[order.front()];
+			++result[static_cast<byte>(order.front() + 1)];
+		}
+
+		return result;
+	}
+
+	// Approximate number of bits for coding the counted bytes, which is the information content of their
+	// normalized frequencies
+	inline double cost(const histogram& freqs, const normalized_t& normalized)
+	{
+		double bits { 0 };
+		for (std::size_t value = 0; value < normalized.size(); value++)
+			if (freqs[static_cast<byte>(value)] > 0)
+				bits += static_cast<double>(freqs[static_cast<byte>(value)]) * (static_cast<double>(table_log) - std::log2(normalized[value]));
+
+		return bits;
+	}
+
+	// Spread the values over the states, each value getting as many states as its normalized frequency
+	inline std::array<byte, table_size> spread(const normalized_t& normalized)
+	{
+		constexpr std::size_t step = (table_size >> 1) + (table_size >> 3) + 3;
+
+		std::array<byte, table_size> result {};
+		std::size_t position { 0 };
+		for (std::size_t value = 0; value < normalized.size(); value++)
+		{
+			for (std::uint32_t i = 0; i < normalized[value]; i++)
+			{
+				result[position] = static_cast<byte>(value);
+				position = (position + step) & (table_size - 1);
+			}
+		}
+
+		assert(position == 0);
+		return result;
+	}
+
+	// Number of bits written by put_frequencies
+	inline std::size_t frequency_bits(const normalized_t& normalized)
+	{
+		std::size_t bits { 9 };
+		std::size_t remaining { table_size };
+		for (std::size_t value = 0; value < normalized.size(); value++)
+		{
+			if (normalized[value] == 0)
+				continue;
+
+			bits += 8;
+			if (normalized[value] < remaining)
+				bits += static_cast<std::size_t>(std::bit_width(remaining));
+
+			remaining -= normalized[value];
+		}
+
+		return bits;
+	}
+
+	// Put the number of occurring values, followed by the values in order, each with its normalized frequency
+	// in as many bits as the remaining total. The last frequency is implied by the remaining total.
+	inline void put_frequencies(bytes::stream& output, const normalized_t& normalized)
+	{
+		auto distinct = std::count_if(normalized.cbegin(), normalized.cend(), [](auto f) { return f > 0; });
+		output.put_word(static_cast<std::uint64_t>(distinct), 9);
+
+		std::size_t remaining { table_size };
+		for (std::size_t value = 0; value < normalized.size(); value++)
+		{
+			if (normalized[value] == 0)
+				continue;
+
+			output.put_word(value, 8);
+			if (normalized[value] < remaining)
+				output.put_word(normalized[value], static_cast<std::size_t>(std::bit_width(remaining)));
+
+			remaining -= normalized[value];
+		}
+	}
+
+	// Get the frequencies written by put_frequencies, which must add up to the number of states (the
+	// frequencies are left empty when no values occur)
+	inline bool get_frequencies(bytes::stream& input, normalized_t& normalized)
+	{
+		normalized.fill(0);
+		if (input.bits_remaining() < 9)
+			return false;
+
+		auto distinct = static_cast<std::size_t>(input.read_word(9));
+		if (distinct > 256)
+			return false;
+
+		std::size_t remaining { table_size };
+		for (std::size_t i = 0; i < distinct; i++)
+		{
+			auto bitsize = i + 1 < distinct ? static_cast<std::size_t>(std::bit_width(remaining)) : 0;
+			if (input.bits_remaining() < 8 + bitsize)
+				return false;
+
+			auto value = static_cast<std::size_t>(input.read_word(8));
+			auto frequency = i + 1 < distinct ? static_cast<std::size_t>(input.read_word(bitsize)) : remaining;
+			if (normalized[value] != 0 || frequency == 0 || frequency > remaining - (distinct - i - 1))
+				return false;
+
+			normalized[value] = static_cast<std::uint32_t>(frequency);
+			remaining -= frequency;
+		}
+
+		return true;
+	}
+
+	// Table-driven encoder, where the state is kept in the range [table_size, 2 * table_size)
+	class encode_table
+	{
+		public:
+			encode_table() : _states({}), _transforms({}) {}
+			explicit encode_table(const normalized_t& normalized) : _states({}), _transforms({})
+			{
+				// Order the states of each value by their position in the spread
+				std::array<std::uint32_t, 256> next {};
+				std::uint32_t cumulative { 0 };
+				for (std::size_t value = 0; value < normalized.size(); value++)
+				{
+					next[value] = cumulative;
+
+					// The number of bits written for a value follows from comparing the state with a threshold
+					auto frequency = normalized[value];
+					if (frequency == 1)
+					{
+						_transforms[value].delta_bits = (static_cast<std::int64_t>(table_log) << 16) - static_cast<std::int64_t>(table_size);
+					}
+					else if (frequency > 1)
+					{
+						auto max_bits = static_cast<std::int64_t>(table_log) - (std::bit_width(frequency - 1) - 1);
+						_transforms[value].delta_bits = (max_bits << 16) - (static_cast<std::int64_t>(frequency) << max_bits);
+					}
+
+					_transforms[value].delta_state = static_cast<std::int64_t>(cumulative) - frequency;
+					cumulative += frequency;
+				}
+
+				auto states = spread(normalized);
+				for (std::size_t state = 0; state < table_size; state++)
+					_states[next[states[state]]++] = static_cast<std::uint16_t>(table_size + state);
+			}
+			~encode_table() {}
+
+			// Encode a value, returning the bits to write packed with their number in the lowest 8 bits
+			std::uint32_t encode(std::uint32_t& state, byte value) const
+			{
+				const auto& t = _transforms[value];
+				auto count = static_cast<std::uint32_t>((state + t.delta_bits) >> 16);
+				auto bits = state & ((std::uint32_t { 1 } << count) - 1);
+
+				state = _states[static_cast<std::size_t>((state >> count) + t.delta_state)];
+				return (bits << 8) | count;
+			}
+
+		private:
+			struct transform
+			{
+				std::int64_t delta_bits;
+				std::int64_t delta_state;
+			};
+
+			std::array<std::uint16_t, table_size> _states;
+			std::array<transform, 256> _transforms;
+	};
+
+	// Encoder of the values of a block in bounded memory. As the decoder visits the states in the opposite
+	// order, the values are encoded in reverse, keeping the state at the end of every chunk. The bits are
+	// then put chunk by chunk, encoding each chunk again from its state. encode(state, i) encodes the value
+	// at index i, returning its code as encode_table::encode does.
+	template <typename Encode>
+	class reverse_encoder
+	{
+		public:
+			reverse_encoder(std::size_t count, Encode encode) : _count(count), _encode(encode), _states(), _state(table_size), _bits(0)
+			{
+				_states.resize((count + chunk_size - 1) / chunk_size);
+				for (auto chunk = _states.size(); chunk-- > 0;)
+				{
+					_states[chunk] = _state;
+					for (auto i = std::min(_count, (chunk + 1) * chunk_size); i-- > chunk * chunk_size;)
+						_bits += _encode(_state, i) & 0xFF;
+				}
+			}
+			~reverse_encoder() {}
+
+			// Final state of the encoder, which is the first state of the decoder
+			std::uint32_t state() const { return _state; }
+
+			// Number of bits of the codes
+			std::size_t bits() const { return _bits; }
+
+			// Put the codes of the values in order
+			void put(bytes::stream& output) const
+			{
+				std::vector<std::uint32_t> codes(std::min(_count, chunk_size));
+				for (std::size_t chunk = 0; chunk < _states.size(); chunk++)
+				{
+					auto state = _states[chunk];
+					auto start = chunk * chunk_size;
+					auto end = std::min(_count, start + chunk_size);
+					for (auto i = end; i-- > start;)
+						codes[i - start] = _encode(state, i);
+
+					for (auto i = start; i < end; i++)
+						output.put_word(codes[i - start] >> 8, codes[i - start] & 0xFF);
+				}
+			}
+
+		private:
+			std::size_t _count;
+			Encode _encode;
+			std::vector<std::uint32_t> _states;	// The state at the end of each chunk
+			std::uint32_t _state;
+			std::size_t _bits;
+	};
+
+	// Table-driven decoder, where the state is kept in the range [0, table_size)
+	class decode_table
+	{
+		public:
+			decode_table() : _entries({}) {}
+			explicit decode_table(const normalized_t& normalized) : _entries({})
+			{
+				std::array<std::uint32_t, 256> next {};
+				std::copy(normalized.cbegin(), normalized.cend(), next.begin());
+
+				auto states = spread(normalized);
+				for (std::size_t state = 0; state < table_size; state++)
+				{
+					auto value = states[state];
+					auto x = next[value]++;
+					auto count = static_cast<std::uint8_t>(table_log - (std::bit_width(x) - 1));
+					_entries[state] = entry { static_cast<std::uint16_t>((x << count) - table_size), value, count };
+				}
+			}
+			~decode_table() {}
+
+			// Decode a value, given the next bits of the stream
+			byte decode(bytes::stream& input, std::uint32_t& state, std::uint64_t bits) const
+			{
+				const auto& e = _entries[state];
+				state = e.state + static_cast<std::uint32_t>(bits & ((std::uint64_t { 1 } << e.count) - 1));
+				input.skip_bits(e.count);
+				return e.value;
+			}
+
+			// Number of bits read when decoding from a state
+			std::size_t count(std::uint32_t state) const { return _entries[state].count; }
+
+		private:
+			struct entry
+			{
+				std::uint16_t state;
+				byte value;
+				std::uint8_t count;
+			};
+
+			std::array<entry, table_size> _entries;
+	};
+
+	// Largest number of values that the given number of bits can decode to, where max_frequency is the largest
+	// frequency of any table. A value read without bits moves the decoder to a lower state, by at least the
+	// number of states of the other values, so only a limited run of values can be read without bits. A table
+	// of a single value reads every value without bits, and as normalize never gives one value every state,
+	// such a table decodes no values.
+	inline std::size_t max_count(std::uint32_t max_frequency, std::size_t bits)
+	{
+		if (max_frequency >= table_size)
+			return 0;
+
+		auto run = (table_size - 1) / (table_size - max_frequency) + 1;
+		if (bits >= std::numeric_limits<std::size_t>::max() / run - 1)
+			return std::numeric_limits<std::size_t>::max();
+
+		return (bits + 1) * run;
+	}
+
+	// Decode count values, starting from the given state, where table(previous) gives the table of the value
+	// following the previous value (0 for the first). The output grows a chunk at a time, so that the count
+	// of a corrupt header does not take memory beyond the values actually decoded.
+	template <typename Select>
+	bool decode(bytes::stream& input, bytes::stream& output, std::size_t count, std::uint32_t state, Select table)
+	{
+		byte previous { 0 };
+		for (std::size_t decoded = 0; decoded < count;)
+		{
+			auto end = decoded + std::min(count - decoded, chunk_size);
+			output.allocate(end - decoded);
+
+			// Fast path: decode without end-of-stream checks while at least 8 bytes of input remain. Every
+			// value of a batch is guaranteed to start at least a full word before the end of the input.
+			while (decoded < end && input.bits_remaining() >= 64)
+			{
+				auto batch = std::min(end - decoded, (input.bits_remaining() - 64) / table_log + 1);
+				for (auto last = decoded + batch; decoded < last; decoded++)
+				{
+					previous = table(previous).decode(input, state, input.peek_word_fast());
+					output.put_fast(previous);
+				}
+			}
+
+			// Decode the final values with end-of-stream checks
+			for (; decoded < end; decoded++)
+			{
+				const auto& next = table(previous);
+				if (next.count(state) > input.bits_remaining())
+					return false;
+
+				previous = next.decode(input, state, input.peek_word());
+				output.put_fast(previous);
+			}
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,44 @@
+/////////////////////////////////////////////////////////////////////////
+// Batches of small records
+//
+// Compresses many small records, such as the messages of a queue, with
+// one table built over all of them (or a sample, at the fast levels)
+// instead of a histogram, table and header per record. The table is
+// written once as a header block, in the format of a dictionary file, and
+// each record becomes a payload that only refers to the header by its ID.
+// Any payload can be decoded on its own given the header.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include <bytes/stream.h>
+#include <compression/dictionary.h>
+#include <compression/options.h>
+
+namespace compression
+{
+	class histogram;
+
+	class batch
+	{
+		public:
+			using buffer_t = bytes::stream::buffer_t;
+
+			// Compress the records to one payload each, and the table to the header block
+			static bool compress(std::span<const buffer_t> records, buffer_t& header, std::vector<buffer_t>& payloads, const options& settings = {});
+
+			// Get the table from the header block, for decoding the payloads
+			static bool open(const buffer_t& header, dictionary& table);
+
+			// Decompress a single payload with the table of its header
+			static bool decompress(const dictionary& table, const buffer_t& payload, buffer_t& record);
+
+			// Decompress all payloads of a header
+			static bool decompress(const buffer_t& header, std::span<const buffer_t> payloads, std::vector<buffer_t>& records);
+
+			// The records counted for the table, which are spread evenly over the batch when sampling
+			static histogram frequencies(std::span<const buffer_t> records, std::size_t sample_size);
+	};
+}
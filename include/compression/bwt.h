@@ -0,0 +1,84 @@
+/////////////////////////////////////////////////////////////////////////
+// Burrows-Wheeler transform
+//
+// Reorders blocks of the input by the sorted suffixes following each byte,
+// which groups bytes that occur in similar contexts. The reordered bytes
+// are move-to-front coded and runs of zeros are written as binary numbers,
+// leaving mostly small values for an entropy coder. The block_sorting
+// template runs the transform followed by an existing coder.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <bytes/stream.h>
+#include <compression/compression.h>
+#include <compression/options.h>
+
+namespace compression
+{
+	class histogram;
+
+	class bwt
+	{
+		public:
+			// Largest block, so that the inverse transform can pack a position and a byte in 32 bits
+			static constexpr std::size_t max_block_size = std::size_t { 1 } << 23;
+
+			// Perform the transform in blocks of the default size
+			static bool compress(bytes::stream& input, bytes::stream& output);
+
+			// Perform the transform in blocks of the size for the level
+			static bool compress(bytes::stream& input, bytes::stream& output, const options& settings);
+
+			// Perform the inverse transform
+			static bool decompress(bytes::stream& input, bytes::stream& output);
+
+			// Approximate size in bytes of the transformed output, which is the size of the input
+			static std::size_t estimate(const histogram& freqs);
+
+			// Suffix array of the data, built by induced sorting (SA-IS) in linear time
+			static std::vector<std::uint32_t> suffix_array(const bytes::stream::byte_t* data, std::size_t count);
+	};
+
+	// The transform followed by an entropy coder, e.g. huffman or one of the simple algorithms
+	template <typename Coder> requires compression_algorithm<Coder> class block_sorting
+	{
+		public:
+			// Perform the compression operation
+			static bool compress(bytes::stream& input, bytes::stream& output)
+			{
+				return compress(input, output, options {});
+			}
+
+			// Perform the compression operation, passing the options to the transform and the coder
+			static bool compress(bytes::stream& input, bytes::stream& output, const options& settings)
+			{
+				bytes::stream transformed {};
+				if (!bwt::compress(input, transformed, settings))
+					return false;
+
+				transformed.seek(0);
+				return ::compress<Coder>(transformed, output, settings);
+			}
+
+			// Perform the decompression operation
+			static bool decompress(bytes::stream& input, bytes::stream& output)
+			{
+				bytes::stream transformed {};
+				if (!Coder::decompress(input, transformed))
+					return false;
+
+				transformed.seek(0);
+				return bwt::decompress(transformed, output);
+			}
+
+			// Approximate size in bytes of the compressed output. As the frequencies do not tell the contexts of
+			// the bytes, this is the estimate of the coder for the bytes as they are.
+			static std::size_t estimate(const histogram& freqs)
+			{
+				return Coder::estimate(freqs);
+			}
+	};
+}
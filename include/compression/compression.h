@@ -8,6 +8,7 @@
 #include <concepts>
 
 #include <bytes/stream.h>
+#include <compression/options.h>
 
 template <typename T> concept compression_algorithm = requires(T c, typename bytes::stream& arg)
 {
@@ -15,16 +16,38 @@ template <typename T> concept compression_algorithm = requires(T c, typename byt
 	{ T::decompress(arg, arg) } -> std::same_as<bool>;
 };
 
+// Algorithms that take compression options into account
+template <typename T> concept configurable_algorithm = compression_algorithm<T> && requires(typename bytes::stream& arg, const compression::options& settings)
+{
+	{ T::compress(arg, arg, settings) } -> std::same_as<bool>;
+};
+
+// Compress a stream, passing the options to the algorithms that support them
 template <typename T> requires compression_algorithm<T>
-auto compress(bytes::stream::buffer_t&& in) -> bytes::stream::buffer_t
+bool compress(bytes::stream& input, bytes::stream& output, const compression::options& settings)
+{
+	if constexpr (configurable_algorithm<T>)
+		return T::compress(input, output, settings);
+	else
+		return T::compress(input, output);
+}
+
+template <typename T> requires compression_algorithm<T>
+auto compress(bytes::stream::buffer_t&& in, const compression::options& settings) -> bytes::stream::buffer_t
 {
 	bytes::stream input { std::move(in) };
 	bytes::stream output {};
 
-	auto is_success = T::compress(input, output);
+	auto is_success = compress<T>(input, output, settings);
 	assert(is_success);
 
-	return output.buffer();
+	return output.release();
+}
+
+template <typename T> requires compression_algorithm<T>
+auto compress(bytes::stream::buffer_t&& in) -> bytes::stream::buffer_t
+{
+	return compress<T>(std::move(in), compression::options {});
 }
 
 template <typename T> requires compression_algorithm<T>
@@ -36,5 +59,5 @@ auto decompress(bytes::stream::buffer_t&& in) -> bytes::stream::buffer_t
 	auto is_success = T::decompress(input, output);
 	assert(is_success);
 
-	return output.buffer();
+	return output.release();
 }
@@ -0,0 +1,101 @@
+/////////////////////////////////////////////////////////////////////////
+// Deduplication of repeated chunks
+//
+// Cuts the input into chunks where a rolling hash of the last bytes has
+// a given pattern (FastCDC), so that the cuts follow the content and
+// equal regions give equal chunks wherever they are. Chunks that occurred
+// before are replaced by a reference, and only the unique chunks are
+// passed to the algorithm, so repeats far beyond any match window are
+// stored once and never reach the coder.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <bytes/stream.h>
+#include <compression/compression.h>
+#include <compression/options.h>
+
+namespace compression
+{
+	class histogram;
+
+	class chunk_table
+	{
+		public:
+			using byte = bytes::stream::byte_t;
+
+			// Chunk sizes, where the cut condition is stricter below the average size than above it
+			static constexpr std::size_t min_size = 2048;
+			static constexpr std::size_t average_size = 8192;
+			static constexpr std::size_t max_size = 65536;
+
+			// A chunk is either new, with its size, or a reference to an earlier unique chunk
+			struct chunk
+			{
+				bool is_reference;
+				std::size_t value;
+			};
+
+			// Size of the chunk at the start of the data
+			static std::size_t cut(const byte* data, std::size_t count);
+
+			// Hash of the contents of a chunk
+			static std::uint64_t fingerprint(const byte* data, std::size_t count);
+
+			// Put the chunks of the data, and copy the unique chunks to a separate buffer
+			static void put(bytes::stream& input, bytes::stream& output, bytes::stream::buffer_t& uniques);
+
+			// Get the chunks put by put, with the total number of bytes
+			static bool get(bytes::stream& input, std::vector<chunk>& chunks, std::size_t& count);
+
+			// Rebuild the data from the chunks and the unique chunks
+			static bool rebuild(const std::vector<chunk>& chunks, std::size_t count, const bytes::stream& uniques, bytes::stream& output);
+	};
+
+	// Deduplication followed by an algorithm for the unique chunks
+	template <typename Algorithm> requires compression_algorithm<Algorithm> class dedup
+	{
+		public:
+			// Perform the compression operation
+			static bool compress(bytes::stream& input, bytes::stream& output)
+			{
+				return compress(input, output, options {});
+			}
+
+			// Perform the compression operation, passing the options to the algorithm
+			static bool compress(bytes::stream& input, bytes::stream& output, const options& settings)
+			{
+				bytes::stream::buffer_t unique_data {};
+				chunk_table::put(input, output, unique_data);
+				output.align();
+
+				bytes::stream uniques { std::move(unique_data) };
+				return ::compress<Algorithm>(uniques, output, settings);
+			}
+
+			// Perform the decompression operation
+			static bool decompress(bytes::stream& input, bytes::stream& output)
+			{
+				std::vector<chunk_table::chunk> chunks {};
+				std::size_t count { 0 };
+				if (!chunk_table::get(input, chunks, count))
+					return false;
+
+				input.align();
+				bytes::stream uniques {};
+				if (!Algorithm::decompress(input, uniques))
+					return false;
+
+				return chunk_table::rebuild(chunks, count, uniques, output);
+			}
+
+			// Approximate size in bytes of the compressed output. As the frequencies do not tell the repeats,
+			// this is the estimate of the algorithm for all bytes.
+			static std::size_t estimate(const histogram& freqs)
+			{
+				return Algorithm::estimate(freqs);
+			}
+	};
+}
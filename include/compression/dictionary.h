@@ -0,0 +1,67 @@
+/////////////////////////////////////////////////////////////////////////
+// Trained dictionaries
+//
+// For small records, such as messages of a few hundred bytes, the code
+// table stored in the output and the histogram pass cost more than they
+// save. A dictionary holds a prefix code for every byte value, trained
+// once from a sample corpus with Huffman coding or the layout of the
+// simple algorithm, and saved to a file. The compressed data then only
+// carries the ID of the dictionary instead of a table.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#include <bytes/stream.h>
+#include <compression/prefix_code.h>
+
+namespace compression
+{
+	class histogram;
+
+	class dictionary
+	{
+		public:
+			using byte = bytes::stream::byte_t;
+
+			// Longest code, as used by the long symbols of simple7
+			static constexpr std::size_t max_length = 15;
+
+			using code_t = prefix_code<256, max_length>;
+			using table_t = prefix_table<256, max_length>;
+			using lengths_t = code_t::lengths_t;
+
+			// Constructor / destructor
+			dictionary() : dictionary(lengths_t {}) {}
+			explicit dictionary(const lengths_t& lengths);
+			~dictionary() {}
+
+			// Train Huffman codes, where byte values missing from the corpus get the longest codes
+			static dictionary train_huffman(const histogram& freqs);
+
+			// Train the codes of the simple algorithm with the given (or otherwise the best) number of short symbol bits
+			static dictionary train_simple(const histogram& freqs, std::size_t short_symbol_bits);
+			static dictionary train_simple(const histogram& freqs);
+
+			// Accessors
+			std::uint32_t id() const { return _id; }
+			const lengths_t& lengths() const { return _lengths; }
+
+			// Write the dictionary as saved in a file, and read it back, checking its ID
+			void save(bytes::stream& output) const;
+			static bool load(bytes::stream& input, dictionary& result);
+
+			// Code the data with the dictionary, writing its ID instead of a table
+			bool compress(bytes::stream& input, bytes::stream& output) const;
+			bool compress(std::span<const byte> data, bytes::stream& output) const;
+			bool decompress(bytes::stream& input, bytes::stream& output) const;
+
+		private:
+			lengths_t _lengths;
+			std::uint32_t _id;
+			code_t _codes;
+			std::shared_ptr<const table_t> _table;	// Shared by copies, as it takes 128 KB
+	};
+}
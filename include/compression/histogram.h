@@ -0,0 +1,129 @@
+/////////////////////////////////////////////////////////////////////////
+// Byte histogram
+//
+// Frequencies of each byte value, shared by the algorithms for building
+// their alphabets and estimating the size of their output.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include <bytes/stream.h>
+
+namespace compression
+{
+	class histogram
+	{
+		public:
+			using byte = bytes::stream::byte_t;
+			using counts_t = std::array<std::size_t, 256>;
+
+			// Constructor / destructor
+			histogram() : _counts({}), _total(0) {}
+			~histogram() {}
+
+			// Count the remaining bytes of a (byte aligned) stream without moving it
+			explicit histogram(const bytes::stream& input) : _counts({}), _total(0)
+			{
+				assert(input.bitindex() == 0);
+				add(input.buffer().data() + input.index(), input.buffer().size() - input.index());
+			}
+
+			// Count an evenly spread sample of about sample_size of the remaining bytes of a stream, with
+			// the frequencies scaled to the number of remaining bytes. A sample size of zero counts every byte.
+			static histogram sample(const bytes::stream& input, std::size_t sample_size)
+			{
+				assert(input.bitindex() == 0);
+
+				auto data = input.buffer().data() + input.index();
+				auto size = input.buffer().size() - input.index();
+				if (sample_size == 0 || size <= sample_size)
+					return histogram { input };
+
+				// Take a number of chunks at equal distances
+				constexpr std::size_t chunks = 16;
+				auto chunk_size = std::max<std::size_t>(sample_size / chunks, 1);
+				auto stride = size / chunks;
+
+				histogram result {};
+				for (std::size_t i = 0; i < chunks; i++)
+					result.add(data + i * stride, chunk_size);
+
+				return result.scaled(size);
+			}
+
+			// Scale the frequencies to a new total, keeping every occurring byte value
+			histogram scaled(std::size_t total) const
+			{
+				if (_total == 0 || total == _total)
+					return *this;
+
+				histogram result {};
+				auto factor = static_cast<long double>(total) / static_cast<long double>(_total);
+				for (std::size_t value = 0; value < _counts.size(); value++)
+					if (_counts[value] > 0)
+						result.add(static_cast<byte>(value), std::max<std::size_t>(static_cast<std::size_t>(_counts[value] * factor + 0.5L), 1));
+
+				return result;
+			}
+
+			// Count a range of bytes
+			void add(const byte* data, std::size_t size)
+			{
+				// Interleave four tables, so that runs of equal bytes do not stall on the same counter
+				std::array<counts_t, 4> partial {};
+				std::size_t i { 0 };
+				for (; i + 4 <= size; i += 4)
+				{
+					++partial[0][data[i]];
+					++partial[1][data[i + 1]];
+					++partial[2][data[i + 2]];
+					++partial[3][data[i + 3]];
+				}
+				for (; i < size; i++)
+					++partial[0][data[i]];
+
+				for (std::size_t value = 0; value < _counts.size(); value++)
+					_counts[value] += partial[0][value] + partial[1][value] + partial[2][value] + partial[3][value];
+
+				_total += size;
+			}
+
+			// Count a single byte value
+			void add(byte value, std::size_t count = 1)
+			{
+				_counts[value] += count;
+				_total += count;
+			}
+
+			// Accessors
+			std::size_t operator[](byte value) const noexcept { return _counts[value]; }
+			std::size_t total() const noexcept { return _total; }
+			const counts_t& counts() const noexcept { return _counts; }
+
+			// Number of byte values that occur
+			std::size_t distinct() const noexcept
+			{
+				return static_cast<std::size_t>(std::count_if(_counts.cbegin(), _counts.cend(), [](auto c) { return c > 0; }));
+			}
+
+			// The byte values that occur, ordered from the most to the least frequent
+			std::vector<byte> sorted() const
+			{
+				std::vector<byte> result {};
+				for (std::size_t value = 0; value < _counts.size(); value++)
+					if (_counts[value] > 0)
+						result.push_back(static_cast<byte>(value));
+
+				auto comparison = [this](byte lhs, byte rhs) { return _counts[lhs] > _counts[rhs]; };
+				std::stable_sort(result.begin(), result.end(), comparison);
+				return result;
+			}
+
+		private:
+			counts_t _counts;
+			std::size_t _total;
+	};
+}
@@ -1,18 +1,96 @@
 /////////////////////////////////////////////////////////////////////////
 // Huffman coding compression algorithm
 //
-// Uses Huffman coding to generate symbol codes.
+// Uses Huffman coding to generate symbol codes. Besides the static
+// functions, the encoder and decoder contexts keep their tables and
+// buffers between calls, for coding many small inputs. A context must
+// only be used by one thread at a time.
 /////////////////////////////////////////////////////////////////////////
 #pragma once
 
+#include <memory>
+
 #include <bytes/stream.h>
+#include <compression/options.h>
 
 namespace compression
 {
+	class histogram;
+
 	class huffman
 	{
 		public:
 			static bool compress(bytes::stream& input, bytes::stream& output);
+			static bool compress(bytes::stream& input, bytes::stream& output, const options& settings);
 			static bool decompress(bytes::stream& input, bytes::stream& output);
+
+			// Size in bytes of the compressed output for data with the given byte frequencies
+			static std::size_t estimate(const histogram& freqs);
+
+			// Memory for building and decoding the codes
+			struct code_state;
+			struct decode_state;
+
+			// Decoder of the bytes of a block, which may be decoded in parts
+			class block_decoder
+			{
+				public:
+					// Constructor / destructor
+					block_decoder();
+					~block_decoder();
+
+					block_decoder(block_decoder&&);
+					block_decoder& operator=(block_decoder&&);
+
+					// Read the header following the stored flag, giving the number of bytes of the block
+					bool start(bytes::stream& input, std::size_t& count);
+
+					// Decode the next count bytes of the block
+					bool decode(bytes::stream& input, bytes::stream::byte_t* destination, std::size_t count);
+
+				private:
+					std::unique_ptr<decode_state> _state;
+			};
+
+			// Reusable compression context
+			class encoder
+			{
+				public:
+					// Constructor / destructor
+					explicit encoder(const options& settings = {});
+					~encoder();
+
+					encoder(encoder&&);
+					encoder& operator=(encoder&&);
+
+					// Compress the remaining input, where the output is kept until the next call
+					bool compress(bytes::stream& input);
+					const bytes::stream::buffer_t& output() const { return _output.buffer(); }
+
+				private:
+					options _settings;
+					bytes::stream _output;
+					std::unique_ptr<code_state> _state;
+			};
+
+			// Reusable decompression context
+			class decoder
+			{
+				public:
+					// Constructor / destructor
+					decoder();
+					~decoder();
+
+					decoder(decoder&&);
+					decoder& operator=(decoder&&);
+
+					// Decompress the input, where the output is kept until the next call
+					bool decompress(bytes::stream& input);
+					const bytes::stream::buffer_t& output() const { return _output.buffer(); }
+
+				private:
+					bytes::stream _output;
+					block_decoder _block;
+			};
 	};
 }
@@ -6,21 +6,28 @@
 #pragma once
 
 #include <bytes/stream.h>
+#include <compression/histogram.h>
 
 namespace compression
 {
 	class identity
 	{
 		public:
-			// Perform the identity operation
+			// Perform the identity operation, copying all remaining bytes at once
 			static bool compress(bytes::stream& input, bytes::stream& output)
 			{
-				while (!input.at_end())
-					output.put(input.read());
+				output.put_bytes(input.buffer().data() + input.index(), input.buffer().size() - input.index());
+				input.seek(input.buffer().size());
 
 				return true;
 			}
 
+			// Size in bytes of the output, which is the size of the input
+			static std::size_t estimate(const histogram& freqs)
+			{
+				return freqs.total();
+			}
+
 			// Compressions and decompression is identical here
 			static bool decompress(bytes::stream& input, bytes::stream& output)
 			{
@@ -0,0 +1,34 @@
+/////////////////////////////////////////////////////////////////////////
+// LZ77 compression algorithm
+//
+// Replaces repeated strings by references to an earlier occurrence within
+// a sliding window, found through hash chains. Literals, match lengths and
+// distances are coded with Huffman codes that are built per block of
+// tokens, similar to DEFLATE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <bytes/stream.h>
+#include <compression/options.h>
+
+namespace compression
+{
+	class histogram;
+
+	class lz77
+	{
+		public:
+			// Matches are found up to window_size - 1 bytes back
+			static constexpr std::size_t window_size = 1 << 16;
+			static constexpr std::size_t min_match = 3;
+			static constexpr std::size_t max_match = 258;
+
+			static bool compress(bytes::stream& input, bytes::stream& output);
+			static bool compress(bytes::stream& input, bytes::stream& output, const options& settings);
+			static bool decompress(bytes::stream& input, bytes::stream& output);
+
+			// Approximate size in bytes of the compressed output for data with the given byte frequencies. As
+			// the frequencies do not tell the repetitions, this is the size when coding literals only.
+			static std::size_t estimate(const histogram& freqs);
+	};
+}
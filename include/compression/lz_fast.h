@@ -0,0 +1,29 @@
+/////////////////////////////////////////////////////////////////////////
+// Fast LZ compression algorithm
+//
+// Byte-aligned LZ77 variant in the style of LZ4, trading ratio for speed.
+// Matches are found by a single probe of a hash table, and sequences of
+// literals and a match are written as whole bytes without entropy coding.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <bytes/stream.h>
+
+namespace compression
+{
+	class histogram;
+
+	class lz_fast
+	{
+		public:
+			static constexpr std::size_t min_match = 4;
+			static constexpr std::size_t max_offset = 65535;
+
+			static bool compress(bytes::stream& input, bytes::stream& output);
+			static bool decompress(bytes::stream& input, bytes::stream& output);
+
+			// Approximate size in bytes of the compressed output for data with the given byte frequencies. As
+			// the frequencies do not tell the repetitions, this is the size of the input.
+			static std::size_t estimate(const histogram& freqs);
+	};
+}
@@ -0,0 +1,57 @@
+/////////////////////////////////////////////////////////////////////////
+// Compression options
+//
+// Settings for the compression operation, for the algorithms that take
+// them into account.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstddef>
+
+namespace compression
+{
+	struct options
+	{
+		static constexpr int min_level = 1;
+		static constexpr int max_level = 9;
+		static constexpr int default_level = 6;
+
+		// Compression level, from the fastest to the best ratio
+		int level = default_level;
+
+		// Size in bytes of the elements of numeric data, for the stride filters
+		std::size_t element_width = 1;
+
+		// Distance in bytes from each element to the element it is predicted from, a multiple of the element
+		// width, where zero means the element width
+		std::size_t stride = 0;
+
+		// Whether the stride filters find the stride in the data instead
+		bool detect_stride = false;
+
+		// Number of bytes sampled for the byte frequencies, where zero means every byte. The
+		// fastest levels sample 16, 32 and 64 KB, avoiding most of the first pass over the input.
+		std::size_t sample_size() const noexcept
+		{
+			return level <= 3 ? std::size_t { 16384 } << (level - min_level) : 0;
+		}
+
+		// Maximum number of earlier positions compared when searching for a match, from 4 to 1024
+		std::size_t search_depth() const noexcept
+		{
+			return std::size_t { 4 } << (level - min_level);
+		}
+
+		// Number of bytes transformed at once by block-based algorithms, from 512 KB to 8 MB
+		std::size_t block_size() const noexcept
+		{
+			return std::size_t { 1 << 19 } << ((level - min_level) / 2);
+		}
+
+		// Whether a match is only taken when the next position has no longer match
+		bool is_lazy() const noexcept
+		{
+			return level >= 4;
+		}
+	};
+}
@@ -0,0 +1,29 @@
+/////////////////////////////////////////////////////////////////////////
+// Order-1 context modelled compression algorithm
+//
+// Codes each byte with tANS tables chosen by the preceding byte. Preceding
+// byte values that gain from a table of their own get one, while the rest
+// share a single table, which keeps the header small.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <bytes/stream.h>
+
+namespace compression
+{
+	class histogram;
+
+	class order1
+	{
+		public:
+			// Maximum number of tables, including the shared table
+			static constexpr std::size_t max_clusters = 32;
+
+			static bool compress(bytes::stream& input, bytes::stream& output);
+			static bool decompress(bytes::stream& input, bytes::stream& output);
+
+			// Approximate size in bytes of the compressed output for data with the given byte frequencies. As
+			// the frequencies do not tell the correlation between bytes, this is the size without contexts.
+			static std::size_t estimate(const histogram& freqs);
+	};
+}
@@ -0,0 +1,206 @@
+/////////////////////////////////////////////////////////////////////////
+// Pipeline of filters in front of a compression algorithm
+//
+// The input passes through the filters in chunks that stay in the cache,
+// each filter writing to a buffer that is reused for every chunk, so that
+// all filters run in a single pass over the input. Only the output of the
+// last filter is collected, as the algorithm (e.g. huffman) may need its
+// whole input. Decompression runs the filters in reverse order.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <bytes/stream.h>
+#include <compression/compression.h>
+#include <compression/options.h>
+
+// Stages that transform data in chunks, keeping their state between chunks. The chunks given to decode
+// need not match those given to encode, and both finish with any output still held by the stage. Filters
+// that are constructible from the options are constructed from them for encoding.
+template <typename T> concept filter_stage = std::default_initializable<T> && requires(T f, const bytes::stream::byte_t* data, std::size_t count, std::vector<bytes::stream::byte_t>& output)
+{
+	{ f.encode(data, count, output) } -> std::same_as<void>;
+	{ f.finish_encode(output) } -> std::same_as<void>;
+	{ f.decode(data, count, output) } -> std::same_as<bool>;
+	{ f.finish_decode(output) } -> std::same_as<bool>;
+};
+
+namespace compression
+{
+	class histogram;
+
+	namespace detail
+	{
+		// The first types of a tuple
+		template <typename Tuple, typename Indices> struct take;
+		template <typename Tuple, std::size_t... I> struct take<Tuple, std::index_sequence<I...>>
+		{
+			using type = std::tuple<std::tuple_element_t<I, Tuple>...>;
+		};
+
+		template <typename Tuple> struct are_filters;
+		template <typename... T> struct are_filters<std::tuple<T...>>
+		{
+			static constexpr bool value = (filter_stage<T> && ...);
+		};
+	}
+
+	template <typename... Stages> requires (sizeof...(Stages) > 0) class pipeline
+	{
+		private:
+			static constexpr std::size_t filter_count = sizeof...(Stages) - 1;
+
+			using stages_t = std::tuple<Stages...>;
+			using filters_t = typename detail::take<stages_t, std::make_index_sequence<filter_count>>::type;
+			using coder_t = std::tuple_element_t<filter_count, stages_t>;
+
+			static_assert(detail::are_filters<filters_t>::value, "Every stage but the last must be a filter.");
+			static_assert(compression_algorithm<coder_t>, "The last stage must be a compression algorithm.");
+
+		public:
+			// Number of bytes passed through the filters at once
+			static constexpr std::size_t chunk_size = 1 << 16;
+
+			// Perform the compression operation
+			static bool compress(bytes::stream& input, bytes::stream& output)
+			{
+				return compress(input, output, options {});
+			}
+
+			// Perform the compression operation, passing the options to the algorithm
+			static bool compress(bytes::stream& input, bytes::stream& output, const options& settings)
+			{
+				auto data = input.buffer().data() + input.index();
+				auto count = input.buffer().size() - input.index();
+
+				chain filters { settings };
+				bytes::stream filtered {};
+				for (std::size_t start = 0; start < count; start += chunk_size)
+					filters.template encode<0>(data + start, std::min(chunk_size, count - start), filtered);
+
+				filters.template finish_encode<0>(filtered);
+				input.seek(input.buffer().size());
+
+				filtered.seek(0);
+				return ::compress<coder_t>(filtered, output, settings);
+			}
+
+			// Perform the decompression operation
+			static bool decompress(bytes::stream& input, bytes::stream& output)
+			{
+				bytes::stream coded {};
+				if (!coder_t::decompress(input, coded))
+					return false;
+
+				auto data = coded.buffer().data();
+				auto count = coded.buffer().size();
+
+				chain filters {};
+				for (std::size_t start = 0; start < count; start += chunk_size)
+					if (!filters.template decode<filter_count>(data + start, std::min(chunk_size, count - start), output))
+						return false;
+
+				return filters.template finish_decode<filter_count>(output);
+			}
+
+			// Approximate size in bytes of the compressed output. As the frequencies do not tell the effect of the
+			// filters, this is the estimate of the algorithm for the bytes as they are.
+			static std::size_t estimate(const histogram& freqs)
+			{
+				return coder_t::estimate(freqs);
+			}
+
+		private:
+			// The filters with a reusable output buffer each, where the filter with index I writes to buffer I
+			class chain
+			{
+				public:
+					// Constructors for decoding and encoding
+					chain() : _filters(), _buffers() {}
+					explicit chain(const options& settings) : _filters(make_filters(settings, std::make_index_sequence<filter_count> {})), _buffers() {}
+
+					// Pass a chunk through the filters from index I on, and write the result to the output
+					template <std::size_t I> void encode(const bytes::stream::byte_t* data, std::size_t count, bytes::stream& output)
+					{
+						if constexpr (I == filter_count)
+						{
+							output.put_bytes(data, count);
+						}
+						else
+						{
+							auto& buffer = _buffers[I];
+							buffer.clear();
+							std::get<I>(_filters).encode(data, count, buffer);
+							encode<I + 1>(buffer.data(), buffer.size(), output);
+						}
+					}
+
+					// Finish the filters from index I on, passing what each one still holds through the later ones
+					template <std::size_t I> void finish_encode(bytes::stream& output)
+					{
+						if constexpr (I < filter_count)
+						{
+							auto& buffer = _buffers[I];
+							buffer.clear();
+							std::get<I>(_filters).finish_encode(buffer);
+							encode<I + 1>(buffer.data(), buffer.size(), output);
+							finish_encode<I + 1>(output);
+						}
+					}
+
+					// Pass a chunk back through the filters before index I, in reverse order
+					template <std::size_t I> bool decode(const bytes::stream::byte_t* data, std::size_t count, bytes::stream& output)
+					{
+						if constexpr (I == 0)
+						{
+							output.put_bytes(data, count);
+							return true;
+						}
+						else
+						{
+							auto& buffer = _buffers[I - 1];
+							buffer.clear();
+							return std::get<I - 1>(_filters).decode(data, count, buffer) && decode<I - 1>(buffer.data(), buffer.size(), output);
+						}
+					}
+
+					// Finish the filters before index I, in reverse order
+					template <std::size_t I> bool finish_decode(bytes::stream& output)
+					{
+						if constexpr (I == 0)
+						{
+							return true;
+						}
+						else
+						{
+							auto& buffer = _buffers[I - 1];
+							buffer.clear();
+							return std::get<I - 1>(_filters).finish_decode(buffer) && decode<I - 1>(buffer.data(), buffer.size(), output) && finish_decode<I - 1>(output);
+						}
+					}
+
+				private:
+					template <std::size_t... I> static filters_t make_filters([[maybe_unused]] const options& settings, std::index_sequence<I...>)
+					{
+						return filters_t { make_filter<std::tuple_element_t<I, filters_t>>(settings)... };
+					}
+
+					template <typename T> static T make_filter(const options& settings)
+					{
+						if constexpr (std::constructible_from<T, const options&>)
+							return T { settings };
+						else
+							return T {};
+					}
+
+					filters_t _filters;
+					std::array<std::vector<bytes::stream::byte_t>, filter_count> _buffers;
+			};
+	};
+}
@@ -0,0 +1,246 @@
+/////////////////////////////////////////////////////////////////////////
+// Canonical prefix codes
+//
+// Length-limited Huffman codes for alphabets of any size, assigned in
+// canonical order so that only the code lengths need to be stored. Codes
+// are kept bit reversed, as the stream is written starting with bit 0,
+// and are decoded with a single lookup of max_length bits. The codes and
+// lookup tables can be built at compile time.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <vector>
+
+#include <bytes/stream.h>
+#include <bytes/dynamic_bitset.h>
+
+namespace compression
+{
+	template <std::size_t symbols, std::size_t max_length> class prefix_code
+	{
+		public:
+			static_assert(max_length < 16 && (std::size_t { 1 } << max_length) >= symbols, "The codes must fit the lookup table.");
+
+			using counts_t = std::array<std::size_t, symbols>;
+			using lengths_t = std::array<std::uint8_t, symbols>;
+
+			struct code
+			{
+				std::uint16_t bits;
+				std::uint8_t length;	// Zero for symbols without a code
+			};
+
+			// Constructor / destructor
+			constexpr prefix_code() : _codes({}) {}
+			constexpr explicit prefix_code(const lengths_t& lengths) : _codes({})
+			{
+				// Assign consecutive codes in order of length and then symbol
+				std::array<std::size_t, max_length + 1> next_code {};
+				std::array<std::size_t, max_length + 1> length_count {};
+				for (auto length : lengths)
+					++length_count[length];
+
+				length_count[0] = 0;
+				for (std::size_t length = 1; length <= max_length; length++)
+					next_code[length] = (next_code[length - 1] + length_count[length - 1]) << 1;
+
+				for (std::size_t symbol = 0; symbol < symbols; symbol++)
+				{
+					auto length = lengths[symbol];
+					if (length == 0)
+						continue;
+
+					auto bits = bytes::dynamic_bitset::reverse(next_code[length]++) >> (bytes::dynamic_bitset::word_bits - length);
+					_codes[symbol] = code { static_cast<std::uint16_t>(bits), length };
+				}
+			}
+			constexpr ~prefix_code() {}
+
+			// Accessors
+			constexpr const code& operator[](std::size_t symbol) const { return _codes[symbol]; }
+
+			// Write the code of a symbol
+			void put(bytes::stream& output, std::size_t symbol) const
+			{
+				output.put_word(_codes[symbol].bits, _codes[symbol].length);
+			}
+
+			// Huffman code lengths, where symbols that do not occur get no code. The two-queue method is used on
+			// the sorted symbols, and the frequencies are flattened until no code is longer than max_length. A
+			// single occurring symbol gets a code of one bit.
+			static lengths_t lengths(counts_t counts)
+			{
+				std::vector<std::size_t> order {};
+				for (std::size_t symbol = 0; symbol < symbols; symbol++)
+					if (counts[symbol] > 0)
+						order.push_back(symbol);
+
+				lengths_t result {};
+				if (order.size() == 1)
+					result[order.front()] = 1;
+
+				if (order.size() < 2)
+					return result;
+
+				auto leaves = order.size();
+				while (true)
+				{
+					std::stable_sort(order.begin(), order.end(), [&](auto lhs, auto rhs) { return counts[lhs] < counts[rhs]; });
+
+					// Nodes are the leaves (in sorted order) followed by the branches in order of creation
+					std::vector<std::size_t> weight(2 * leaves - 1);
+					std::vector<std::size_t> parent(2 * leaves - 1);
+					for (std::size_t i = 0; i < leaves; i++)
+						weight[i] = counts[order[i]];
+
+					std::size_t next_leaf { 0 };
+					std::size_t next_branch { leaves };
+					for (std::size_t branch = leaves; branch < weight.size(); branch++)
+					{
+						// Take the lightest two nodes from the front of either queue
+						for (auto k = 0; k < 2; k++)
+						{
+							auto is_leaf = next_leaf < leaves && (next_branch == branch || weight[next_leaf] <= weight[next_branch]);
+							auto node = is_leaf ? next_leaf++ : next_branch++;
+							weight[branch] += weight[node];
+							parent[node] = branch;
+						}
+					}
+
+					// The depth of each node follows from the depth of its parent, where the root has depth zero
+					std::vector<std::size_t> depth(2 * leaves - 1);
+					for (auto node = weight.size() - 1; node-- > 0;)
+						depth[node] = depth[parent[node]] + 1;
+
+					auto is_limited = true;
+					for (std::size_t i = 0; i < leaves; i++)
+					{
+						result[order[i]] = static_cast<std::uint8_t>(std::min(depth[i], max_length + 1));
+						is_limited = is_limited && depth[i] <= max_length;
+					}
+
+					if (is_limited)
+						return result;
+
+					for (auto symbol : order)
+						counts[symbol] = counts[symbol] / 2 + 1;
+				}
+			}
+
+			// Number of bits for coding symbols with the given frequencies
+			static std::size_t cost(const counts_t& counts, const lengths_t& lengths)
+			{
+				return std::inner_product(counts.cbegin(), counts.cend(), lengths.cbegin(), std::size_t { 0 });
+			}
+
+			// Number of bits written by put_lengths
+			static std::size_t length_bits(const lengths_t& lengths)
+			{
+				std::size_t bits { 0 };
+				for (std::size_t symbol = 0; symbol < symbols; symbol += run(lengths, symbol))
+					bits += 4 + (lengths[symbol] == 0 ? 5 : 0);
+
+				return bits;
+			}
+
+			// Put the code lengths in 4 bits each, where a zero is followed by the number of further zeros in 5 bits
+			static void put_lengths(bytes::stream& output, const lengths_t& lengths)
+			{
+				for (std::size_t symbol = 0; symbol < symbols;)
+				{
+					auto count = run(lengths, symbol);
+					output.put_word(lengths[symbol], 4);
+					if (lengths[symbol] == 0)
+						output.put_word(count - 1, 5);
+
+					symbol += count;
+				}
+			}
+
+			// Get the code lengths written by put_lengths, which must form a valid prefix code
+			static bool get_lengths(bytes::stream& input, lengths_t& lengths)
+			{
+				lengths.fill(0);
+				std::size_t space { 0 };
+				for (std::size_t symbol = 0; symbol < symbols;)
+				{
+					if (input.bits_remaining() < 4)
+						return false;
+
+					auto length = static_cast<std::size_t>(input.read_word(4));
+					if (length > max_length)
+						return false;
+
+					if (length > 0)
+					{
+						lengths[symbol++] = static_cast<std::uint8_t>(length);
+						space += std::size_t { 1 } << (max_length - length);
+						continue;
+					}
+
+					if (input.bits_remaining() < 5)
+						return false;
+
+					symbol += static_cast<std::size_t>(input.read_word(5)) + 1;
+					if (symbol > symbols)
+						return false;
+				}
+
+				return space <= (std::size_t { 1 } << max_length);
+			}
+
+		private:
+			// Number of symbols covered by a single entry of put_lengths
+			static std::size_t run(const lengths_t& lengths, std::size_t symbol)
+			{
+				if (lengths[symbol] != 0)
+					return 1;
+
+				std::size_t count { 1 };
+				while (count < 32 && symbol + count < symbols && lengths[symbol + count] == 0)
+					count++;
+
+				return count;
+			}
+
+			std::array<code, symbols> _codes;
+	};
+
+	// Lookup table for decoding the codes of a prefix_code
+	template <std::size_t symbols, std::size_t max_length> class prefix_table
+	{
+		public:
+			using lengths_t = typename prefix_code<symbols, max_length>::lengths_t;
+
+			struct entry
+			{
+				std::uint16_t symbol;
+				std::uint8_t length;	// Zero for bit patterns that start no code
+			};
+
+			// Constructor / destructor
+			constexpr prefix_table() : _entries({}) {}
+			constexpr explicit prefix_table(const lengths_t& lengths) : _entries({})
+			{
+				prefix_code<symbols, max_length> codes { lengths };
+				for (std::size_t symbol = 0; symbol < symbols; symbol++)
+				{
+					// Fill every table entry starting with the code
+					auto c = codes[symbol];
+					if (c.length > 0)
+						for (std::size_t i = c.bits; i < _entries.size(); i += std::size_t { 1 } << c.length)
+							_entries[i] = entry { static_cast<std::uint16_t>(symbol), c.length };
+				}
+			}
+			constexpr ~prefix_table() {}
+
+			// The entry for the next bits of the stream
+			constexpr const entry& operator[](std::uint64_t bits) const { return _entries[bits & ((1 << max_length) - 1)]; }
+
+		private:
+			std::array<entry, std::size_t { 1 } << max_length> _entries;
+	};
+}
@@ -0,0 +1,94 @@
+/////////////////////////////////////////////////////////////////////////
+// Pull-based decompression
+//
+// Decodes compressed data in parts as the consumer asks for them, e.g.
+// to read the header of a payload or the first line of a log without
+// decoding the rest. No work is done beyond the bytes that were read.
+// The algorithm provides a block_decoder, which reads the header of a
+// block and then decodes its bytes in any number of parts.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstring>
+
+#include <bytes/stream.h>
+#include <compression/stored.h>
+
+// Algorithms of which the bytes can be decoded in parts
+template <typename T> concept pull_decodable = std::default_initializable<typename T::block_decoder> &&
+	requires(typename T::block_decoder& decoder, bytes::stream& input, bytes::stream::byte_t* destination, std::size_t& count)
+{
+	{ decoder.start(input, count) } -> std::same_as<bool>;
+	{ decoder.decode(input, destination, count) } -> std::same_as<bool>;
+};
+
+namespace compression
+{
+	template <typename Algorithm> requires pull_decodable<Algorithm> class reader
+	{
+		public:
+			using byte = bytes::stream::byte_t;
+
+			// Constructor, reading the header of the data / destructor
+			explicit reader(bytes::stream::buffer_t&& input) : _input(std::move(input)), _decoder(), _is_stored(false), _remaining(0), _valid(false)
+			{
+				if (_input.at_end())
+					return;
+
+				_is_stored = stored::is_stored(_input);
+				_valid = _is_stored ? stored::get_size(_input, _remaining) : _decoder.start(_input, _remaining);
+				if (!_valid)
+					_remaining = 0;
+			}
+			~reader() {}
+
+			// Accessors
+			bool valid() const { return _valid; }
+			bool at_end() const { return _remaining == 0; }
+			std::size_t remaining() const { return _remaining; }
+
+			// Decode up to count bytes, returning the number of bytes decoded. This is less than count only
+			// at the end of the data, and zero once invalid data is found.
+			std::size_t read(byte* destination, std::size_t count)
+			{
+				count = std::min(count, _remaining);
+				if (count == 0)
+					return 0;
+
+				if (_is_stored)
+				{
+					std::memcpy(destination, _input.buffer().data() + _input.index(), count);
+					_input.seek(_input.index() + count);
+				}
+				else if (!_decoder.decode(_input, destination, count))
+				{
+					_valid = false;
+					_remaining = 0;
+					return 0;
+				}
+
+				_remaining -= count;
+				return count;
+			}
+
+			// Decode up to count bytes to the end of a buffer
+			std::size_t read(bytes::stream::buffer_t& output, std::size_t count)
+			{
+				auto start = output.size();
+				output.resize(start + std::min(count, _remaining));
+
+				auto decoded = read(output.data() + start, output.size() - start);
+				output.resize(start + decoded);
+				return decoded;
+			}
+
+		private:
+			bytes::stream _input;
+			typename Algorithm::block_decoder _decoder;
+			bool _is_stored;
+			std::size_t _remaining;
+			bool _valid;
+	};
+}
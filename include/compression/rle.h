@@ -0,0 +1,112 @@
+/////////////////////////////////////////////////////////////////////////
+// Run-length filter
+//
+// Bytes are copied as they are, except that two equal bytes in a row are
+// followed by the number of further repeats (0 to 255) in one byte. Runs
+// therefore shrink to three bytes, and other data grows only where pairs
+// occur. The filter is used in a pipeline in front of an algorithm.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <vector>
+
+#include <bytes/stream.h>
+
+namespace compression
+{
+	class rle
+	{
+		public:
+			using byte = bytes::stream::byte_t;
+
+			static constexpr std::size_t max_repeats = 255;
+
+			// Constructor / destructor
+			rle() : _last(0), _length(0), _repeats(0), _is_run(false) {}
+			~rle() {}
+
+			// Code a chunk, where a run may continue into the next chunk
+			void encode(const byte* data, std::size_t count, std::vector<byte>& output)
+			{
+				output.reserve(output.size() + count + count / 2 + 1);
+				for (std::size_t i = 0; i < count; i++)
+				{
+					auto value = data[i];
+					if (_is_run)
+					{
+						if (value == _last && _repeats < max_repeats)
+						{
+							++_repeats;
+							continue;
+						}
+
+						output.push_back(static_cast<byte>(_repeats));
+						_is_run = false;
+						_length = 0;
+					}
+
+					output.push_back(value);
+					next(value);
+				}
+			}
+
+			// Put the number of repeats of a run that is still open
+			void finish_encode(std::vector<byte>& output)
+			{
+				if (_is_run)
+					output.push_back(static_cast<byte>(_repeats));
+
+				*this = rle {};
+			}
+
+			// Decode a chunk, where the number of repeats may be in the next chunk
+			bool decode(const byte* data, std::size_t count, std::vector<byte>& output)
+			{
+				output.reserve(output.size() + count);
+				for (std::size_t i = 0; i < count; i++)
+				{
+					if (_is_run)
+					{
+						output.insert(output.end(), data[i], _last);
+						_is_run = false;
+						_length = 0;
+						continue;
+					}
+
+					output.push_back(data[i]);
+					next(data[i]);
+				}
+
+				return true;
+			}
+
+			// Every pair must have been followed by its number of repeats
+			bool finish_decode(std::vector<byte>&)
+			{
+				auto is_complete = !_is_run;
+				*this = rle {};
+				return is_complete;
+			}
+
+		private:
+			// Track the bytes written as they are, where a second equal byte starts a run
+			void next(byte value)
+			{
+				if (_length > 0 && value == _last)
+				{
+					_is_run = true;
+					_repeats = 0;
+				}
+				else
+				{
+					_last = value;
+					_length = 1;
+				}
+			}
+
+			byte _last;
+			std::size_t _length;	// Number of bytes equal to _last written since the last run, at most one
+			std::size_t _repeats;
+			bool _is_run;
+	};
+}
@@ -1,15 +1,19 @@
 /////////////////////////////////////////////////////////////////////////
 // Simple Compression Algorithm
 //
-// Assigns shorter bitpatterns to the most frequent byte values.
+// Assigns shorter bitpatterns to the most frequent byte values. The symbol
+// following the alphabet is an escape symbol, preceding bytes that are
+// written as-is.
 /////////////////////////////////////////////////////////////////////////
 #pragma once
 
-#include <unordered_map>
 #include <algorithm>
-#include <variant>
+#include <array>
 
 #include <bytes/stream.h>
+#include <compression/histogram.h>
+#include <compression/options.h>
+#include <compression/stored.h>
 
 namespace compression
 {
@@ -21,166 +25,253 @@ namespace compression
 			static constexpr int long_symbols() { return 1 << (long_symbol_bits - short_symbol_bits); }
 			static constexpr int total_symbols() { return short_symbols() + long_symbols(); }
 
-			using short_symbol_t = std::bitset<short_symbol_bits>;
-			using long_symbol_t = std::bitset<long_symbol_bits>;
-			using symbol = std::variant<short_symbol_t, long_symbol_t>;
 			using byte = bytes::stream::byte_t;
-			using frequency_map = std::unordered_map<byte, std::size_t>;
-			using alphabet = std::unordered_map<byte, symbol>;
-			using inverse_alphabet = std::unordered_map<symbol, byte>;
 
 		public:
 			// Perform the compression operation
 			static bool compress(bytes::stream& input, bytes::stream& output)
+			{
+				// Obtain frequencies for each byte
+				return compress(input, output, histogram { input });
+			}
+
+			// Perform the compression operation, where the fast levels obtain the frequencies from a sample
+			static bool compress(bytes::stream& input, bytes::stream& output, const options& settings)
+			{
+				return compress(input, output, histogram::sample(input, settings.sample_size()));
+			}
+
+			// Perform the compression operation with the byte frequencies of the input already known (or
+			// estimated, in which case byte values missing from the frequencies are escaped)
+			static bool compress(bytes::stream& input, bytes::stream& output, const histogram& freqs)
 			{
 				static_assert(total_symbols() > 255, "There are not enough symbols available to cover all possible byte values.");
 
-				// Obtain frequencies for each byte
-				frequency_map freqs {};
-				while (!input.at_end())
-					++freqs[input.read()];
-
-				// Build symbol translation table
-				alphabet translator {};
-				std::vector<byte> alphabet_order {};
-				while (!freqs.empty())
+				// The alphabet is ordered by frequency
+				auto count = input.buffer().size() - input.index();
+				auto alphabet_order = freqs.sorted();
+
+				// Store the data as-is if encoding would not make it smaller
+				if (encoded_bits(freqs, alphabet_order) >= stored::bits(count, output.bitindex()))
 				{
-					auto next = extract_most_frequent(freqs);
-					translator[next] = get_symbol(translator.size());
-					alphabet_order.push_back(next);
+					stored::put(input, output);
+					return true;
 				}
 
-				// Reserve 3 bits for final bitindex in the output buffer
-				output.put_bits(std::bitset<3> { 0 });
+				stored::put_encoded(output);
+
+				// Put the number of symbols, which lets the decoder preallocate and skip end-of-stream checks
+				output.put_size(count);
 
 				// Put size of alphabet. Note: Both 0 and 256 should be possible (257 possible values), so 8 bits is not enough
-				output.put_bits<9>(translator.size());
+				output.put_bits<9>(alphabet_order.size());
 
-				// Write the bytes that are part of the alphabet in the order used to generate translator
+				// Write the bytes that are part of the alphabet in the order used to generate the symbols
 				for (auto i = alphabet_order.cbegin(); i != alphabet_order.cend(); i++)
 					output.put(*i);
 
-				// Prepare put-operation and reset input stream position
-				const put_symbol_operation put_symbol { output };
-				input.seek(0);
-
-				// Write the stream using the alphabet
-				while (!input.at_end())
-					std::visit(put_symbol, translator.at(input.read()));
-
-				// Write bitindex to the first bits
-				byte output_bitindex = output.bitindex();
-				output.seek(0);
-				output.put_bits(std::bitset<3> { output_bitindex });
+				// Write the stream using the code of each byte
+				auto codes = byte_codes(alphabet_order);
+				auto data = input.buffer().data() + input.index();
+				for (std::size_t i = 0; i < count; i++)
+					output.put_word(codes[data[i]].bits, codes[data[i]].length);
 
+				input.seek(input.buffer().size());
 				return true;
 			}
 
 			// Compressions and decompression is identical here
 			static bool decompress(bytes::stream& input, bytes::stream& output)
 			{
-				static_assert(total_symbols() > 255, "There are not enough symbols available to cover all possible byte values.");
-
 				// Ensure that some data is available
-				if (input.at_end() || input.buffer().size() < 2)
+				if (input.at_end())
 					return false;
 
-				// Read final bitindex (3 first bits of the stream)
-				byte bitindex = static_cast<byte>(input.read_bits<3>().to_ulong());
-
-				// Get size of the alphabet
-				auto alphabet_size = static_cast<std::size_t>(input.read_bits<9>().to_ulong());
+				// Stored blocks are copied directly
+				if (stored::is_stored(input))
+					return stored::get(input, output);
 
-				// Ensure that there are bytes enough
-				if (input.buffer().size() < input.index() + alphabet_size + 1)
+				block_decoder block {};
+				std::size_t count { 0 };
+				if (!block.start(input, count))
 					return false;
 
-				// Get the alphabet
-				inverse_alphabet translator {};
-				for (auto i = 0; i < alphabet_size; i++)
-				{
-					byte next = input.read();
-					translator[get_symbol(i)] = next;
-				}
-
-				// Decompress
-				auto input_size = input.buffer().size();
-				while (!input.at_end())
-				{
-					// There may be excess bits in the final byte
-					if (bitindex > 0 && input.index() >= input_size - 1 && input.bitindex() >= bitindex)
-						break;
-
-					// Get the next symbol
-					symbol next = read_symbol_from_stream(input);
+				output.allocate(count);
+				return block.decode(input, output.put_span(count), count);
+			}
 
-					// Look up the corresponding byte value
-					auto decoded = translator.find(next);
-					if (decoded == translator.end())
-						return false;
+			// Size in bytes of the compressed output for data with the given byte frequencies
+			static std::size_t estimate(const histogram& freqs)
+			{
+				auto bits = std::min(encoded_bits(freqs, freqs.sorted()), stored::bits(freqs.total()));
+				return (bits + 7) / 8;
+			}
 
-					// Write the byte value to the output stream
-					output.put(decoded->second);
-				}
+			// Number of bits of an encoded block, including headers (escaped bytes are not counted)
+			static std::size_t encoded_bits(const histogram& freqs, const std::vector<byte>& alphabet_order)
+			{
+				std::size_t bits = 1 + 6 + static_cast<std::size_t>(std::bit_width(freqs.total())) + 9 + 8 * alphabet_order.size();
+				for (std::size_t i = 0; i < alphabet_order.size(); i++)
+					bits += freqs[alphabet_order[i]] * (i < short_symbols() ? short_symbol_bits : long_symbol_bits);
 
-				return true;
+				return bits;
 			}
 
 		private:
-			// Extracts the most frequent byte from a frequency map
-			static byte extract_most_frequent(frequency_map& freqs)
+			// Bits of a symbol, starting with bit 0
+			struct code
 			{
-				// Find the most frequent value
-				auto comparison = [](const frequency_map::value_type& lhs, const frequency_map::value_type& rhs) { return lhs.second < rhs.second; };
-				auto most_frequent = std::max_element(freqs.cbegin(), freqs.cend(), comparison);
-
-				assert(most_frequent != freqs.cend());
-
-				// Extract, remove and return the byte
-				byte value = most_frequent->first;
-				freqs.erase(most_frequent);
-				return value;
-			}
+				std::uint64_t bits;
+				std::size_t length;
+			};
 
-			// Create a symbol for a specific byte
-			static constexpr symbol get_symbol(std::size_t number)
+			// Create the code for the symbol with a specific number
+			static constexpr code get_symbol(std::size_t number)
 			{
 				if (number < short_symbols())
-					return std::bitset<short_symbol_bits>(number);
+					return code { number, short_symbol_bits };
 
 				// Set the first short_symbol_bits number of bits to 1 and then count from there on
 				auto bitpattern = ((number - short_symbols() + 1) << short_symbol_bits) | short_symbols();
+				return code { bitpattern & ((std::uint64_t { 1 } << long_symbol_bits) - 1), long_symbol_bits };
+			}
 
-				return std::bitset<long_symbol_bits>(bitpattern);
+			// The code written for each byte value, where byte values outside the alphabet are escaped
+			static std::array<code, 256> byte_codes(const std::vector<byte>& alphabet_order)
+			{
+				std::array<code, 256> codes {};
+				std::array<bool, 256> is_known {};
+				for (std::size_t i = 0; i < alphabet_order.size(); i++)
+				{
+					codes[alphabet_order[i]] = get_symbol(i);
+					is_known[alphabet_order[i]] = true;
+				}
+
+				auto escape = get_symbol(alphabet_order.size());
+				for (std::size_t value = 0; value < codes.size(); value++)
+					if (!is_known[value])
+						codes[value] = code { escape.bits | (value << escape.length), escape.length + 8 };
+
+				return codes;
 			}
 
-			// Put-operation for symbols
-			struct put_symbol_operation
+			// Replace an escape symbol by the byte written after it, returning false for invalid symbols
+			static bool unescape(bytes::stream& input, std::uint16_t& value)
 			{
-				public:
-					put_symbol_operation(bytes::stream& output) : _output(output) {}
-					~put_symbol_operation() {}
+				if (value != decode_table::escape || input.bits_remaining() < 8)
+					return false;
+
+				value = static_cast<std::uint16_t>(input.read_word(8));
+				return true;
+			}
 
-					void operator()(const short_symbol_t& s) const { _output.put_bits(s); }
-					void operator()(const long_symbol_t& s) const { _output.put_bits(s); }
+			// Lookup tables from short symbols and from the upper bits of long symbols to byte values
+			class decode_table
+			{
+				public:
+					static constexpr std::uint16_t invalid = 256;
+					static constexpr std::uint16_t escape = 257;
+
+					decode_table() { _short.fill(invalid); _long.fill(invalid); }
+					~decode_table() {}
+
+					// Assign a byte value (or the escape) to the symbol with the given number
+					void add(std::size_t number, std::uint16_t value)
+					{
+						if (number < short_symbols())
+							_short[number] = value;
+						else
+							_long[(number - short_symbols() + 1) & (long_symbols() - 1)] = value;
+					}
+
+					// Decode the symbol starting at the lowest bits, returning invalid for unused symbols. Unless
+					// checked, the symbol is assumed to be fully available in the stream.
+					template <bool checked> std::uint16_t decode(bytes::stream& input, std::uint64_t bits) const
+					{
+						auto next_short = bits & short_symbols();
+						auto is_short = next_short != short_symbols();
+						std::size_t length = is_short ? short_symbol_bits : long_symbol_bits;
+						if (checked && length > input.bits_remaining())
+							return invalid;
+
+						input.skip_bits(length);
+						return is_short ? _short[next_short] : _long[(bits >> short_symbol_bits) & (long_symbols() - 1)];
+					}
 
 				private:
-					bytes::stream& _output;
+					std::array<std::uint16_t, short_symbols()> _short;
+					std::array<std::uint16_t, long_symbols()> _long;
 			};
 
-			// Read the next encoded symbol from the stream
-			static symbol read_symbol_from_stream(bytes::stream& input)
+		public:
+			// Decoder of the bytes of a block, which may be decoded in parts
+			class block_decoder
 			{
-				// Peek at the next short-symbol length bits
-				auto next_short = input.peek_bits<short_symbol_bits>();
-
-				// Check whether this is a short code
-				if ((next_short.to_ulong() & short_symbols()) != short_symbols())
-					return input.read_bits<short_symbol_bits>();
+				public:
+					// Read the header following the stored flag, giving the number of bytes of the block
+					bool start(bytes::stream& input, std::size_t& count)
+					{
+						static_assert(total_symbols() > 255, "There are not enough symbols available to cover all possible byte values.");
+
+						// Get the number of symbols
+						if (!input.read_size(count) || input.bits_remaining() < 9)
+							return false;
+
+						// Get size of the alphabet
+						auto alphabet_size = static_cast<std::size_t>(input.read_bits<9>().to_ulong());
+
+						// Ensure that there are bytes enough
+						if (alphabet_size > 256 || input.buffer().size() < input.index() + alphabet_size + 1)
+							return false;
+
+						// Get the alphabet, followed by the escape symbol
+						_table = decode_table {};
+						for (std::size_t i = 0; i < alphabet_size; i++)
+							_table.add(i, input.read());
+
+						if (alphabet_size < 256)
+							_table.add(alphabet_size, decode_table::escape);
+
+						// Every symbol takes at least short_symbol_bits bits
+						return count <= input.bits_remaining() / short_symbol_bits;
+					}
+
+					// Decode the next count bytes of the block
+					bool decode(bytes::stream& input, byte* destination, std::size_t count)
+					{
+						std::size_t decoded { 0 };
+
+						// Fast path: decode without end-of-stream checks while at least 8 bytes of input remain. Every symbol
+						// of a batch (including an escaped byte) is guaranteed to start at least a full word before the end.
+						while (decoded < count && input.bits_remaining() >= 64)
+						{
+							auto batch = std::min(count - decoded, (input.bits_remaining() - 64) / (long_symbol_bits + 8) + 1);
+							for (auto end = decoded + batch; decoded < end; decoded++)
+							{
+								auto value = _table.template decode<false>(input, input.peek_word_fast());
+								if (value > 255 && !unescape(input, value))
+									return false;
+
+								destination[decoded] = static_cast<byte>(value);
+							}
+						}
+
+						// Decode the final symbols with end-of-stream checks
+						for (; decoded < count; decoded++)
+						{
+							auto value = _table.template decode<true>(input, input.peek_word());
+							if (value > 255 && !unescape(input, value))
+								return false;
+
+							destination[decoded] = static_cast<byte>(value);
+						}
+
+						return true;
+					}
 
-				// Otherwise read it as a long code
-				return input.read_bits<long_symbol_bits>();
-			}
+				private:
+					decode_table _table;
+			};
 	};
 
 	using simple7 = compression::simple<7,15>;
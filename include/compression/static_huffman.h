@@ -0,0 +1,300 @@
+/////////////////////////////////////////////////////////////////////////
+// Static Huffman coding compression algorithm
+//
+// Codes the data with Huffman codes for fixed byte frequencies of a class
+// of data, such as English text or JSON. The codes and the decode table
+// are built at compile time from the profile, so that no histogram, table
+// or header is needed at run time. Every byte value has a code, and the
+// output holds only the stored flag and the number of bytes.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <string_view>
+
+#include <bytes/stream.h>
+#include <compression/histogram.h>
+#include <compression/prefix_code.h>
+#include <compression/stored.h>
+
+namespace compression
+{
+	// Frequencies of the byte values in a class of data, where every byte value must occur
+	template <typename T> concept frequency_profile = requires
+	{
+		{ T::frequencies } -> std::convertible_to<std::array<std::size_t, 256>>;
+	};
+
+	template <typename Profile> requires frequency_profile<Profile> class static_huffman
+	{
+		public:
+			using byte = bytes::stream::byte_t;
+
+			// Codes are limited in length, so that every code is decoded with a single table lookup
+			static constexpr std::size_t max_length = 12;
+
+			using code_t = prefix_code<256, max_length>;
+			using table_t = prefix_table<256, max_length>;
+			using counts_t = code_t::counts_t;
+			using lengths_t = code_t::lengths_t;
+
+			// Huffman code lengths, where the frequencies are flattened until no code is longer than max_length.
+			// This is prefix_code::lengths for an alphabet where every symbol occurs, without the containers and
+			// algorithms that cannot run at compile time.
+			static constexpr lengths_t build_lengths(counts_t counts)
+			{
+				constexpr std::size_t leaves = 256;
+				std::array<std::size_t, leaves> order {};
+				for (std::size_t i = 0; i < leaves; i++)
+					order[i] = i;
+
+				while (true)
+				{
+					// Stable insertion sort of the symbols by frequency
+					for (std::size_t i = 1; i < leaves; i++)
+					{
+						auto symbol = order[i];
+						auto j = i;
+						for (; j > 0 && counts[order[j - 1]] > counts[symbol]; j--)
+							order[j] = order[j - 1];
+
+						order[j] = symbol;
+					}
+
+					// Nodes are the leaves (in sorted order) followed by the branches in order of creation
+					std::array<std::size_t, 2 * leaves - 1> weight {};
+					std::array<std::size_t, 2 * leaves - 1> parent {};
+					for (std::size_t i = 0; i < leaves; i++)
+						weight[i] = counts[order[i]];
+
+					std::size_t next_leaf { 0 };
+					std::size_t next_branch { leaves };
+					for (std::size_t branch = leaves; branch < weight.size(); branch++)
+					{
+						// Take the lightest two nodes from the front of either queue
+						for (auto k = 0; k < 2; k++)
+						{
+							auto is_leaf = next_leaf < leaves && (next_branch == branch || weight[next_leaf] <= weight[next_branch]);
+							auto node = is_leaf ? next_leaf++ : next_branch++;
+							weight[branch] += weight[node];
+							parent[node] = branch;
+						}
+					}
+
+					// The depth of each node follows from the depth of its parent, where the root has depth zero
+					std::array<std::size_t, 2 * leaves - 1> depth {};
+					for (auto node = weight.size() - 1; node-- > 0;)
+						depth[node] = depth[parent[node]] + 1;
+
+					lengths_t result {};
+					auto is_limited = true;
+					for (std::size_t i = 0; i < leaves; i++)
+					{
+						result[order[i]] = static_cast<std::uint8_t>(depth[i]);
+						is_limited = is_limited && depth[i] <= max_length;
+					}
+
+					if (is_limited)
+						return result;
+
+					for (auto& count : counts)
+						count = count / 2 + 1;
+				}
+			}
+
+			static constexpr lengths_t lengths = build_lengths(Profile::frequencies);
+			static constexpr code_t codes { lengths };
+			static constexpr table_t table { lengths };
+
+		public:
+			// Perform the compression operation
+			static bool compress(bytes::stream& input, bytes::stream& output)
+			{
+				auto data = input.buffer().data() + input.index();
+				auto count = input.buffer().size() - input.index();
+
+				// Store the data as-is if encoding would not make it smaller
+				std::size_t bits = header_bits(count);
+				for (std::size_t i = 0; i < count; i++)
+					bits += lengths[data[i]];
+
+				if (bits >= stored::bits(count, output.bitindex()))
+				{
+					stored::put(input, output);
+					return true;
+				}
+
+				stored::put_encoded(output);
+				output.put_size(count);
+
+				// Collect the codes of four bytes, which fit a word, before writing them
+				std::size_t i { 0 };
+				for (; i + 4 <= count; i += 4)
+				{
+					std::uint64_t word { 0 };
+					std::size_t length { 0 };
+					for (std::size_t k = 0; k < 4; k++)
+					{
+						const auto& c = codes[data[i + k]];
+						word |= static_cast<std::uint64_t>(c.bits) << length;
+						length += c.length;
+					}
+
+					output.put_word(word, length);
+				}
+
+				for (; i < count; i++)
+					codes.put(output, data[i]);
+
+				input.seek(input.buffer().size());
+				return true;
+			}
+
+			// Perform the decompression operation
+			static bool decompress(bytes::stream& input, bytes::stream& output)
+			{
+				if (input.at_end())
+					return false;
+
+				if (stored::is_stored(input))
+					return stored::get(input, output);
+
+				// Every code takes at least one bit
+				std::size_t count { 0 };
+				if (!input.read_size(count) || count > input.bits_remaining())
+					return false;
+
+				output.allocate(count);
+				for (std::size_t i = 0; i < count; i++)
+				{
+					// Peek without end-of-stream checks while at least 8 bytes of input remain
+					auto next = input.bits_remaining() >= 64 ? input.peek_word_fast() : input.peek_word();
+					const auto& e = table[next];
+					if (e.length == 0 || e.length > input.bits_remaining())
+						return false;
+
+					input.skip_bits(e.length);
+					output.put_fast(static_cast<byte>(e.symbol));
+				}
+
+				return true;
+			}
+
+			// Size in bytes of the compressed output for data with the given byte frequencies
+			static std::size_t estimate(const histogram& freqs)
+			{
+				auto bits = std::min(header_bits(freqs.total()) + code_t::cost(freqs.counts(), lengths), stored::bits(freqs.total()));
+				return (bits + 7) / 8;
+			}
+
+		private:
+			// The stored flag and the number of bytes
+			static constexpr std::size_t header_bits(std::size_t count)
+			{
+				return 1 + 6 + static_cast<std::size_t>(std::bit_width(count));
+			}
+	};
+
+	// ----------------------------------------------------------------------
+	// Built-in profiles
+	// ----------------------------------------------------------------------
+	namespace profiles
+	{
+		// Frequencies of the letters a to z per 10000 letters of English text
+		constexpr std::array<std::size_t, 26> letters { 817, 149, 278, 425, 1270, 223, 202, 609, 697, 15, 77, 403, 241, 675, 751, 193, 10, 599, 633, 906, 276, 98, 236, 15, 197, 7 };
+
+		// Frequencies of the printable characters with a given weight, and a count of one for the other byte values
+		constexpr std::array<std::size_t, 256> printable(std::size_t weight)
+		{
+			std::array<std::size_t, 256> result {};
+			for (std::size_t value = 0; value < result.size(); value++)
+				result[value] = value >= ' ' && value < 127 ? weight : 1;
+
+			return result;
+		}
+
+		// English text, e.g. documentation and log messages
+		struct english_text
+		{
+			static constexpr std::array<std::size_t, 256> frequencies = []()
+			{
+				auto result = printable(4);
+				for (std::size_t i = 0; i < letters.size(); i++)
+				{
+					result['a' + i] += letters[i] * 6;
+					result['A' + i] += letters[i] / 4;
+				}
+
+				for (auto c = '0'; c <= '9'; c++)
+					result[static_cast<unsigned char>(c)] += 60;
+
+				for (auto c : std::string_view { "?!;:()" })
+					result[static_cast<unsigned char>(c)] += 40;
+
+				result[' '] += 15000;
+				result['\n'] += 1500;
+				result['.'] += 800;
+				result[','] += 900;
+				result['\''] += 200;
+				result['"'] += 200;
+				result['-'] += 150;
+				return result;
+			}();
+
+		};
+
+		// JSON documents with lowercase keys, strings and numbers
+		struct json
+		{
+			static constexpr std::array<std::size_t, 256> frequencies = []()
+			{
+				auto result = printable(4);
+				for (std::size_t i = 0; i < letters.size(); i++)
+				{
+					result['a' + i] += letters[i] * 2;
+					result['A' + i] += letters[i] / 8;
+				}
+
+				for (auto c = '0'; c <= '9'; c++)
+					result[static_cast<unsigned char>(c)] += 700;
+
+				result['"'] += 8000;
+				result[':'] += 2000;
+				result[','] += 2000;
+				result[' '] += 3000;
+				result['{'] += 700;
+				result['}'] += 700;
+				result['['] += 300;
+				result[']'] += 300;
+				result['\n'] += 700;
+				result['_'] += 300;
+				result['.'] += 200;
+				result['-'] += 200;
+				return result;
+			}();
+
+		};
+
+		// Binary data with many zeros and small values, e.g. sparse arrays and integers of small magnitude
+		struct zero_heavy_binary
+		{
+			static constexpr std::array<std::size_t, 256> frequencies = []()
+			{
+				std::array<std::size_t, 256> result {};
+				result[0] = 40000;
+				for (std::size_t value = 1; value < result.size(); value++)
+					result[value] = 1 + (std::size_t { 2048 } >> std::bit_width(value));
+
+				result[0xFF] += 2000;
+				return result;
+			}();
+		};
+	}
+
+	using static_text = static_huffman<profiles::english_text>;
+	using static_json = static_huffman<profiles::json>;
+	using static_binary = static_huffman<profiles::zero_heavy_binary>;
+}
@@ -0,0 +1,78 @@
+/////////////////////////////////////////////////////////////////////////
+// Stored blocks
+//
+// Fallback used by the algorithms when encoding would expand the data.
+// The output starts with a flag bit, which is set for stored blocks.
+// A stored block continues with the number of bytes and, from the next
+// byte boundary, the bytes themselves copied as-is.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <bit>
+#include <span>
+
+#include <bytes/stream.h>
+
+namespace compression
+{
+	class stored
+	{
+		public:
+			// Number of bits of a stored block of count bytes, starting at the given bit within a byte
+			static std::size_t bits(std::size_t count, std::size_t bitindex = 0)
+			{
+				auto header = bitindex + 1 + 6 + static_cast<std::size_t>(std::bit_width(count));
+				return (header + 7) / 8 * 8 + count * 8 - bitindex;
+			}
+
+			// Write the flag of an encoded (i.e. not stored) block
+			static void put_encoded(bytes::stream& output)
+			{
+				output.put_word(0, 1);
+			}
+
+			// Copy the bytes as a stored block
+			static void put(std::span<const bytes::stream::byte_t> data, bytes::stream& output)
+			{
+				output.put_word(1, 1);
+				output.put_size(data.size());
+				output.align();
+				output.put_bytes(data.data(), data.size());
+			}
+
+			// Copy the remaining input as a stored block
+			static void put(bytes::stream& input, bytes::stream& output)
+			{
+				put(std::span { input.buffer().data() + input.index(), input.buffer().size() - input.index() }, output);
+				input.seek(input.buffer().size());
+			}
+
+			// Read the flag, returning true for stored blocks
+			static bool is_stored(bytes::stream& input)
+			{
+				return input.bits_remaining() > 0 && input.read_word(1) == 1;
+			}
+
+			// Read the number of bytes of a stored block (after the flag), moving to the first byte
+			static bool get_size(bytes::stream& input, std::size_t& count)
+			{
+				if (!input.read_size(count))
+					return false;
+
+				input.align();
+				return count <= input.bits_remaining() / 8;
+			}
+
+			// Copy a stored block (after the flag) to the output
+			static bool get(bytes::stream& input, bytes::stream& output)
+			{
+				std::size_t count { 0 };
+				if (!get_size(input, count))
+					return false;
+
+				output.put_bytes(input.buffer().data() + input.index(), count);
+				input.seek(input.index() + count);
+				return true;
+			}
+	};
+}
@@ -0,0 +1,87 @@
+/////////////////////////////////////////////////////////////////////////
+// Stride filters
+//
+// Prepare fixed-width numeric data, such as records of integers or
+// floats, for byte-oriented coders. Each element is replaced by its
+// difference (or XOR) with the element one stride earlier, and the bytes
+// of the elements in a block are then grouped by their position in the
+// element, so that e.g. the high bytes of small differences end up
+// together. The mode, element width and stride are written in a header of
+// two bytes, so that the decoder needs no settings.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <bytes/stream.h>
+#include <compression/options.h>
+
+namespace compression
+{
+	class stride_filter
+	{
+		public:
+			using byte = bytes::stream::byte_t;
+
+			enum class mode
+			{
+				subtract,
+				exclusive_or
+			};
+
+			// Number of elements of which the bytes are grouped at once
+			static constexpr std::size_t block_elements = 4096;
+
+			// Largest stride in elements
+			static constexpr std::size_t max_stride = 255;
+
+			// Number of bytes at the start of the data searched for the stride
+			static constexpr std::size_t detect_size = 16384;
+
+			// Constructor for decoding, where the settings come from the header / destructor
+			stride_filter();
+			stride_filter(mode filter_mode, const options& settings);
+			~stride_filter() {}
+
+			// Filter interface
+			void encode(const byte* data, std::size_t count, std::vector<byte>& output);
+			void finish_encode(std::vector<byte>& output);
+			bool decode(const byte* data, std::size_t count, std::vector<byte>& output);
+			bool finish_decode(std::vector<byte>& output);
+
+			// Stride in elements giving the smallest differences over the start of the data
+			static std::size_t detect(const byte* data, std::size_t count, std::size_t width);
+
+		private:
+			template <typename F> void in_blocks(const byte* data, std::size_t count, F&& block);
+			void encode_block(const byte* data, std::size_t count, std::vector<byte>& output);
+			void decode_block(const byte* data, std::size_t count, std::vector<byte>& output);
+
+			mode _mode;
+			std::size_t _width;
+			std::size_t _stride;	// In elements, where zero means detecting it from the first block
+			bool _has_header;
+			std::array<byte, 2> _header;
+			std::size_t _header_count;
+			std::vector<byte> _pending;	// Bytes of an incomplete block
+			std::vector<byte> _history;	// The last stride elements of the data
+			std::vector<byte> _work;
+	};
+
+	// Differences of the elements, for integers
+	class delta : public stride_filter
+	{
+		public:
+			delta() {}
+			explicit delta(const options& settings) : stride_filter(mode::subtract, settings) {}
+	};
+
+	// XOR of the elements, for floating point numbers
+	class xor_delta : public stride_filter
+	{
+		public:
+			xor_delta() {}
+			explicit xor_delta(const options& settings) : stride_filter(mode::exclusive_or, settings) {}
+	};
+}
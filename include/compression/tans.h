@@ -0,0 +1,25 @@
+/////////////////////////////////////////////////////////////////////////
+// Table-based asymmetric numeral systems (tANS) compression algorithm
+//
+// Codes the bytes with fractional bit lengths, using frequencies that are
+// normalized to the number of states of the coder. The encoder and decoder
+// are driven by tables built from the normalized frequencies, which are
+// the only header besides the number of bytes.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <bytes/stream.h>
+#include <compression/ans.h>
+
+namespace compression
+{
+	class tans
+	{
+		public:
+			static bool compress(bytes::stream& input, bytes::stream& output);
+			static bool decompress(bytes::stream& input, bytes::stream& output);
+
+			// Approximate size in bytes of the compressed output for data with the given byte frequencies
+			static std::size_t estimate(const histogram& freqs);
+	};
+}
@@ -0,0 +1,113 @@
+/////////////////////////////////////////////////////////////////////////
+// Tuned Simple Compression Algorithm
+//
+// Runs the simple algorithm with the pair of short and long symbol sizes
+// that gives the smallest output for the input. The short symbol size is
+// stored in the first 3 bits of the output.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <limits>
+
+#include <bytes/stream.h>
+#include <compression/histogram.h>
+#include <compression/options.h>
+#include <compression/simple.h>
+#include <compression/stored.h>
+
+namespace compression
+{
+	class tuned_simple
+	{
+		public:
+			// Short symbol sizes from 1 to 7 bits, where long symbols always need 8 more bits
+			static constexpr std::size_t choices = 7;
+
+			// Perform the compression operation
+			static bool compress(bytes::stream& input, bytes::stream& output)
+			{
+				return compress(input, output, options {});
+			}
+
+			// Perform the compression operation, where the fast levels choose from a sample of the input
+			static bool compress(bytes::stream& input, bytes::stream& output, const options& settings)
+			{
+				auto freqs = histogram::sample(input, settings.sample_size());
+				auto choice = best_choice(freqs);
+
+				output.put_word(choice, 3);
+				return with_choice(choice, [&]<typename T>() { return T::compress(input, output, freqs); });
+			}
+
+			// Perform the decompression operation
+			static bool decompress(bytes::stream& input, bytes::stream& output)
+			{
+				if (input.bits_remaining() < 3)
+					return false;
+
+				auto choice = static_cast<std::size_t>(input.read_word(3));
+				if (choice >= choices)
+					return false;
+
+				return with_choice(choice, [&]<typename T>() { return T::decompress(input, output); });
+			}
+
+			// Size in bytes of the compressed output for data with the given byte frequencies
+			static std::size_t estimate(const histogram& freqs)
+			{
+				auto alphabet_order = freqs.sorted();
+				auto bits = 3 + std::min(encoded_bits(freqs, alphabet_order, best_choice(freqs)), stored::bits(freqs.total(), 3));
+				return (bits + 7) / 8;
+			}
+
+			// The choice giving the smallest encoded size, computed exactly from the byte frequencies
+			static std::size_t best_choice(const histogram& freqs)
+			{
+				auto alphabet_order = freqs.sorted();
+
+				std::size_t best { 0 };
+				auto best_bits = std::numeric_limits<std::size_t>::max();
+				for (std::size_t choice = 0; choice < choices; choice++)
+				{
+					auto bits = encoded_bits(freqs, alphabet_order, choice);
+					if (bits < best_bits)
+					{
+						best = choice;
+						best_bits = bits;
+					}
+				}
+
+				return best;
+			}
+
+		private:
+			// Number of bits of an encoded block for a choice
+			static std::size_t encoded_bits(const histogram& freqs, const std::vector<histogram::byte>& alphabet_order, std::size_t choice)
+			{
+				return with_choice(choice, [&]<typename T>() { return T::encoded_bits(freqs, alphabet_order); });
+			}
+
+			// Call a function template with the precompiled algorithm for a choice
+			template <typename F> static auto with_choice(std::size_t choice, F&& f) -> decltype(f.template operator()<simple<1,9>>())
+			{
+				switch (choice)
+				{
+					case 0:
+						return f.template operator()<simple<1,9>>();
+					case 1:
+						return f.template operator()<simple<2,10>>();
+					case 2:
+						return f.template operator()<simple<3,11>>();
+					case 3:
+						return f.template operator()<simple<4,12>>();
+					case 4:
+						return f.template operator()<simple<5,13>>();
+					case 5:
+						return f.template operator()<simple<6,14>>();
+					default:
+						assert(choice == 6);
+						return f.template operator()<simple<7,15>>();
+				}
+			}
+	};
+}
@@ -0,0 +1,34 @@
+/////////////////////////////////////////////////////////////////////////
+// Batch runner
+//
+// Compresses or decompresses every file of a directory tree into the
+// same relative paths of an output tree. The files are split into blocks
+// and the blocks run on a pool of workers, where each worker starts with
+// the blocks of its own files and steals blocks from the others once it
+// runs out, so that one large file does not leave the pool idle. Workers
+// take blocks from the front of every queue, their own as well as those
+// they steal from, so the blocks of a file start in order. The compressed
+// blocks waiting for the blocks before them are limited, which keeps the
+// memory within '--max-memory'.
+// Each output file is framed as described in block_frame.h, as with '-t'.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <ostream>
+
+#include <utility/runsettings.h>
+
+namespace utility
+{
+	class batch_runner
+	{
+		public:
+			// Run the settings on every file of the input tree, writing the throughput of each file and in total to the report
+			static bool run(const runsettings& settings, const std::filesystem::path& input, const std::filesystem::path& output, std::size_t threads, std::size_t block_size, std::ostream& report);
+
+			// Run with the trees, the number of threads and the memory limit of the settings
+			static bool run(const runsettings& settings, std::ostream& report);
+	};
+}
@@ -0,0 +1,41 @@
+/////////////////////////////////////////////////////////////////////////
+// Block framing
+//
+// Data compressed in blocks, as by the stream buffers and the parallel
+// runner, is a sequence of frames. Each frame starts with the size of its
+// block before and after compression, as 32-bit little-endian numbers,
+// followed by the output of the algorithm. The sizes are checked before
+// anything is allocated, so that memory use stays bounded.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <istream>
+#include <ostream>
+
+namespace utility
+{
+	struct block_frame
+	{
+		static constexpr std::size_t header_size = 8;
+		static constexpr std::size_t default_block_size = 1 << 18;
+		static constexpr std::size_t max_block_size = 1 << 24;
+
+		using header_t = std::array<unsigned char, header_size>;
+
+		// Number of bytes of the block before and after compression
+		std::size_t count = 0;
+		std::size_t size = 0;
+
+		// Whether the sizes are in range, where the output of an algorithm is at most a few times the size of its input
+		bool valid() const { return count > 0 && count <= max_block_size && size <= 4 * count + 1024; }
+
+		// The header of the frame, and writing it
+		header_t header() const;
+		void write(std::ostream& output) const;
+
+		// Read the header of the next frame, which fails at the end of the input, setting is_end, or for invalid sizes
+		bool read(std::istream& input, bool& is_end);
+	};
+}
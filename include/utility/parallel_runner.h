@@ -0,0 +1,43 @@
+/////////////////////////////////////////////////////////////////////////
+// Parallel runner
+//
+// Runs the algorithm of the run settings on blocks of the input in a
+// pipeline: a reader thread splits the input into blocks, a pool of
+// workers compresses or decompresses them, and the calling thread writes
+// them in their original order. Reading and writing thus overlap with the
+// algorithm. Block i goes to worker i % n, so that every queue has one
+// producer and one consumer, and the writer restores the order by taking
+// the blocks from the workers in turn. A fixed number of blocks per worker
+// go around, with their buffers, so that memory use is bounded by the
+// block size, whatever the size of the input and whether or not it can
+// be read twice. The compressed data is framed as described in
+// block_frame.h.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+
+#include <utility/runsettings.h>
+
+namespace utility
+{
+	class parallel_runner
+	{
+		public:
+			static constexpr std::size_t default_block_size = 1 << 20;
+			static constexpr std::size_t min_block_size = 1 << 12;
+			static constexpr std::size_t max_threads = 64;
+			static constexpr std::size_t min_memory = 1 << 20;
+
+			// Run the settings on the input with the given number of worker threads
+			static bool run(const runsettings& settings, std::istream& input, std::ostream& output, std::size_t threads, std::size_t block_size = default_block_size);
+
+			// Run the settings on the input with the number of threads and the memory limit of the settings
+			static bool run(const runsettings& settings, std::istream& input, std::ostream& output);
+
+			// Largest block size for which the blocks in flight and the memory of the algorithms fit the memory limit
+			static std::size_t block_size(std::size_t max_memory, std::size_t threads);
+	};
+}
@@ -6,7 +6,13 @@
 /////////////////////////////////////////////////////////////////////////
 #pragma once
 
+#include <optional>
+#include <string>
+#include <vector>
+
 #include <bytes/stream.h>
+#include <compression/dictionary.h>
+#include <compression/options.h>
 
 namespace utility
 {
@@ -18,7 +24,8 @@ namespace utility
 				enum class mode
 				{
 					compress,
-					decompress
+					decompress,
+					train		// Build a dictionary from a sample corpus, for use with '--dict'
 				};
 
 				enum class algorithm
@@ -30,7 +37,27 @@ namespace utility
 					simple5,
 					simple6,
 					simple7,
-					huffman
+					huffman,
+					simple,		// Sizes of the simple algorithm chosen per input
+					adaptive_huffman,
+					tans,
+					order1,		// Not considered by the automatic mode, as it is estimated from byte frequencies only
+					lz77,		// Not considered by the automatic mode, as it is estimated from byte frequencies only
+					lz_fast,	// Not considered by the automatic mode, as it is estimated from byte frequencies only
+					bwt,		// Not considered by the automatic mode, as it is estimated from byte frequencies only
+					static_text,	// Codes built at compile time for English text
+					static_json,	// Codes built at compile time for JSON
+					static_binary,	// Codes built at compile time for binary data with many zeros
+					automatic	// Chosen per input and recorded in the output
+				};
+
+				// Filter run in front of the algorithm, selected as e.g. "rle+simple5"
+				enum class filter
+				{
+					none,
+					rle,
+					delta,		// Differences of elements, with the width and stride from the options
+					xor_delta	// XOR of elements, with the width and stride from the options
 				};
 			};
 
@@ -47,13 +74,48 @@ namespace utility
 			// Public interface
 			auto mode() const { return _mode; }
 			auto algorithm() const { return _algorithm; }
+			auto filter() const { return _filter; }
+			auto dedup() const { return _dedup; }
+			const auto& dictionary() const { return _dictionary; }
+			auto speed() const { return _speed; }
+			auto threads() const { return _threads; }
+			auto max_memory() const { return _max_memory; }
+			const auto& serve_path() const { return _serve_path; }
+			const auto& connect_path() const { return _connect_path; }
+			const auto& arguments() const { return _arguments; }
+			const auto& input_tree() const { return _input_tree; }
+			const auto& output_tree() const { return _output_tree; }
+			auto level() const { return _options.level; }
+			const auto& options() const { return _options; }
 			bool valid() const { return _valid; }
 
-			bytes::stream::buffer_t run(bytes::stream::buffer_t&&);
+			// Run the mode on the whole input, which fails for input that the algorithm cannot decompress
+			bool run(bytes::stream::buffer_t&& input, bytes::stream::buffer_t& output) const;
+
+			// Run the algorithm on a stream, e.g. for a block of the input, which is safe to call from several threads
+			bool run(bytes::stream& input, bytes::stream& output) const;
+
+			// Run an algorithm on its own, e.g. for a block of a stream, where the automatic mode has no speed preference
+			static bool run(settings::mode mode, settings::algorithm algorithm, bytes::stream& input, bytes::stream& output, const compression::options& options = {});
+
+			// The algorithm chosen for the input by the automatic mode
+			settings::algorithm choose(const bytes::stream::buffer_t&) const;
 
 		private:
 			settings::mode _mode;
 			settings::algorithm _algorithm;
+			settings::filter _filter;
+			bool _dedup;	// Whether repeated chunks are replaced by references before the algorithm
+			std::optional<compression::dictionary> _dictionary;	// Replaces the algorithm when loaded with '--dict'
+			int _speed;	// Preference for speed over ratio in the automatic mode, from 0 to 9
+			std::size_t _threads;	// Worker threads running on blocks of the input, or zero for the whole input at once
+			std::size_t _max_memory;	// Bytes of memory for the blocks in flight, or zero for the whole input at once. With '--serve', the largest input of a request.
+			std::string _serve_path;	// Socket on which to serve requests, with '--serve'
+			std::string _connect_path;	// Socket of the server running the request, with '--connect'
+			std::vector<std::string> _arguments;	// The arguments but '--connect', as forwarded to the server
+			std::string _input_tree;	// Directory of which every file is run, with '-r'
+			std::string _output_tree;	// Directory receiving the output files, with '-o'
+			compression::options _options;
 			bool _valid;
 	};
 }
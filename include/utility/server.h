@@ -0,0 +1,78 @@
+/////////////////////////////////////////////////////////////////////////
+// Server
+//
+// Runs compress and decompress requests from clients over a Unix domain
+// socket, so that callers running many small requests do not start a
+// process for each of them. A pool of workers accepts connections and
+// runs their requests one after the other. Each worker keeps the parsed
+// settings of recent requests, so that e.g. a dictionary is loaded once,
+// while the algorithms start afresh for every request. The input of a
+// request is limited, and a request that does not fit in memory fails
+// without ending the server.
+//
+// A request holds the number of arguments (32 bits), each argument as
+// its length (32 bits) and characters, and the size of the input (64
+// bits) followed by the input. The response holds a status byte and the
+// size of the output (64 bits) followed by the output. All numbers are
+// little-endian.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <bytes/stream.h>
+
+namespace utility
+{
+	class server
+	{
+		public:
+			enum class status : std::uint8_t
+			{
+				success,
+				invalid_arguments,
+				failed
+			};
+
+			static constexpr std::size_t max_arguments = 64;
+			static constexpr std::size_t max_argument_size = 4096;
+			static constexpr std::size_t default_max_input_size = std::size_t { 64 } << 20;
+
+			// Largest output that a client takes from the server
+			static constexpr std::uint64_t max_output_size = std::uint64_t { 1 } << 32;
+
+			// Constructor, listening on the socket with the given number of workers and largest input of a request / destructor, stopping the server
+			server(const std::string& path, std::size_t threads, std::size_t max_input_size = default_max_input_size);
+			~server();
+
+			// No need for copy or move
+			server(const server&) = delete;
+			server(server&&) = delete;
+
+			// Whether the server is listening
+			bool valid() const { return _socket >= 0; }
+
+			// Stop accepting connections, end the open ones, and wait for the workers
+			void stop();
+
+			// Wait for the workers, which only return once the server is stopped
+			void wait();
+
+			// Run a request on the server listening on the socket, as a client
+			static bool request(const std::string& path, const std::vector<std::string>& arguments, const bytes::stream::buffer_t& input, bytes::stream::buffer_t& output);
+
+		private:
+			void serve(std::size_t worker);
+
+			std::string _path;
+			std::size_t _max_input_size;
+			int _socket;
+			std::atomic<bool> _is_stopping;
+			std::unique_ptr<std::atomic<int>[]> _connections;	// The connection of each worker, or -1
+			std::vector<std::jthread> _workers;
+	};
+}
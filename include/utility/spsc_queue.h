@@ -0,0 +1,60 @@
+/////////////////////////////////////////////////////////////////////////
+// Single-producer single-consumer queue
+//
+// Bounded ring of items passed from one thread to another without locks.
+// Each index is only written by one side, so that a push or pop is a load
+// and a store. A thread finding the queue full or empty waits on the
+// index of the other side instead of spinning.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <utility>
+
+namespace utility
+{
+	template <typename T, std::size_t Capacity> requires (std::has_single_bit(Capacity)) class spsc_queue
+	{
+		public:
+			// Constructor / destructor
+			spsc_queue() : _items(), _head(0), _tail(0) {}
+			~spsc_queue() {}
+
+			// No need for copy or move
+			spsc_queue(const spsc_queue&) = delete;
+			spsc_queue(spsc_queue&&) = delete;
+
+			// Add an item, waiting while the queue is full (producer only)
+			void push(T item)
+			{
+				auto tail = _tail.load(std::memory_order_relaxed);
+				for (auto head = _head.load(std::memory_order_acquire); tail - head == Capacity; head = _head.load(std::memory_order_acquire))
+					_head.wait(head, std::memory_order_acquire);
+
+				_items[tail % Capacity] = std::move(item);
+				_tail.store(tail + 1, std::memory_order_release);
+				_tail.notify_one();
+			}
+
+			// Take the oldest item, waiting while the queue is empty (consumer only)
+			T pop()
+			{
+				auto head = _head.load(std::memory_order_relaxed);
+				for (auto tail = _tail.load(std::memory_order_acquire); tail == head; tail = _tail.load(std::memory_order_acquire))
+					_tail.wait(tail, std::memory_order_acquire);
+
+				auto item = std::move(_items[head % Capacity]);
+				_head.store(head + 1, std::memory_order_release);
+				_head.notify_one();
+				return item;
+			}
+
+		private:
+			std::array<T, Capacity> _items;
+			alignas(64) std::atomic<std::size_t> _head;	// Next item to pop, written by the consumer
+			alignas(64) std::atomic<std::size_t> _tail;	// Next item to push, written by the producer
+	};
+}
@@ -0,0 +1,83 @@
+/////////////////////////////////////////////////////////////////////////
+// Compressing stream buffers
+//
+// Stream buffers that compress what is written to an output stream, and
+// decompress what is read from an input stream, so that existing code
+// gets compression by swapping the buffer of its streams. The data is
+// compressed in blocks of a fixed size, so that memory use is bounded by
+// the block size instead of the size of the data. The blocks are framed
+// as described in block_frame.h.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+#include <bytes/stream.h>
+#include <compression/options.h>
+#include <utility/block_frame.h>
+#include <utility/runsettings.h>
+
+namespace utility
+{
+	class compressing_ostreambuf : public std::streambuf
+	{
+		public:
+			using algorithm_t = runsettings::settings::algorithm;
+
+			// Constructor / destructor, where the destructor writes the last block
+			compressing_ostreambuf(std::ostream& output, algorithm_t algorithm, const compression::options& settings = {}, std::size_t block_size = block_frame::default_block_size);
+			~compressing_ostreambuf() override;
+
+			// No need for copy or move
+			compressing_ostreambuf(const compressing_ostreambuf&) = delete;
+			compressing_ostreambuf(compressing_ostreambuf&&) = delete;
+
+		protected:
+			// Compress the full block before taking the next character
+			int_type overflow(int_type c) override;
+
+			// Compress the bytes written so far as a (shorter) block, and flush the output
+			int sync() override;
+
+		private:
+			bool put_block();
+
+			std::ostream& _output;
+			algorithm_t _algorithm;
+			compression::options _settings;
+			std::vector<char> _block;
+			bytes::stream _compressed;
+	};
+
+	class decompressing_istreambuf : public std::streambuf
+	{
+		public:
+			using algorithm_t = runsettings::settings::algorithm;
+
+			// Constructor / destructor
+			decompressing_istreambuf(std::istream& input, algorithm_t algorithm);
+			~decompressing_istreambuf() override;
+
+			// No need for copy or move
+			decompressing_istreambuf(const decompressing_istreambuf&) = delete;
+			decompressing_istreambuf(decompressing_istreambuf&&) = delete;
+
+			// Whether the blocks read so far were valid, where reading stops at the first invalid block
+			bool valid() const { return _valid; }
+
+		protected:
+			// Decompress the next block once the current block has been read
+			int_type underflow() override;
+
+		private:
+			bool get_block();
+
+			std::istream& _input;
+			algorithm_t _algorithm;
+			bytes::stream _block;
+			bool _valid;
+	};
+}
@@ -89,11 +89,71 @@ namespace bytes
 		++_index;
 	}
 
-	// Writes a dynamic set of bits
+	// Writes a dynamic set of bits, one word at a time
 	void stream::put_bits(const dynamic_bitset& bits)
 	{
-		for (auto i = bits.bits.cbegin(); i != bits.bits.cend(); i++)
-			put_bits<1>(*i);
+		for (std::size_t i = 0; i < bits.word_count(); i++)
+			put_word(bits.word(i), bits.word_size(i));
+	}
+
+	// Writes the lowest count bits of a word, starting with bit 0
+	void stream::put_word(std::uint64_t word, std::size_t count)
+	{
+		assert(count <= 64);
+
+		// Write as many bits as fit into the current byte in each step
+		while (count > 0)
+		{
+			auto bitcount = count < 8u - _bitindex ? count : 8u - _bitindex;
+			auto mask = static_cast<byte_t>(((1u << bitcount) - 1) << _bitindex);
+			auto bits = static_cast<byte_t>(word << _bitindex) & mask;
+
+			if (_index >= _buffer.size())
+			{
+				// If the byte is not yet in the buffer, then it must be the first bit
+				assert(_bitindex == 0);
+				_buffer.push_back(bits);
+			}
+			else
+			{
+				// Clear and set the bits
+				auto& byte = _buffer[_index];
+				byte = (byte & ~mask) | bits;
+			}
+
+			word >>= bitcount;
+			count -= bitcount;
+			_bitindex += static_cast<byte_t>(bitcount);
+
+			// If all bits are set, go to next byte
+			if (_bitindex >= 8)
+			{
+				_bitindex = 0;
+				++_index;
+			}
+		}
+	}
+
+	// Writes a size as a 6-bit bit width followed by the significant bits
+	void stream::put_size(std::size_t size)
+	{
+		auto width = static_cast<std::size_t>(std::bit_width(size));
+		assert(width < 64);
+
+		put_word(width, 6);
+		put_word(size, width);
+	}
+
+	// Copy a range of bytes to a byte aligned position of the stream
+	void stream::put_bytes(const byte_t* data, std::size_t count)
+	{
+		assert(_bitindex == 0);
+		if (count == 0)
+			return;
+
+		allocate(count);
+		std::memcpy(_buffer.data() + _index, data, count);
+		_index += count;
 	}
 
 	// Change the current position within the stream
@@ -107,6 +167,39 @@ namespace bytes
 		_bitindex = bitindex;
 	}
 
+	// Move to the start of the next byte, unless already there
+	void stream::align()
+	{
+		if (_bitindex != 0)
+		{
+			_bitindex = 0;
+			++_index;
+		}
+	}
+
+	// Make room for count bytes from the current index, e.g. for writing with put_fast
+	void stream::allocate(std::size_t count)
+	{
+		if (_buffer.size() < _index + count)
+			_buffer.resize(_index + count);
+	}
+
+	// Remove all bytes, keeping the memory for writing the stream again
+	void stream::clear()
+	{
+		_buffer.clear();
+		_index = 0;
+		_bitindex = 0;
+	}
+
+	// Take the buffer, e.g. for reuse, leaving the stream empty
+	auto stream::release() -> buffer_t
+	{
+		auto result = std::move(_buffer);
+		clear();
+		return result;
+	}
+
 	// Read the next byte and move index
 	auto stream::read() -> stream::byte_t
 	{
@@ -120,6 +213,61 @@ namespace bytes
 		return _buffer[_index++];
 	}
 
+	// Reads count bits into the lowest bits of a word, starting with bit 0
+	std::uint64_t stream::read_word(std::size_t count)
+	{
+		assert(count <= 64);
+		assert(count <= bits_remaining());
+
+		std::uint64_t word { 0 };
+		std::size_t position { 0 };
+
+		// Read as many bits as are left in the current byte in each step
+		while (position < count)
+		{
+			auto bitcount = count - position < 8u - _bitindex ? count - position : 8u - _bitindex;
+			std::uint64_t bits = (_buffer[_index] >> _bitindex) & ((1u << bitcount) - 1);
+			word |= bits << position;
+
+			position += bitcount;
+			_bitindex += static_cast<byte_t>(bitcount);
+			if (_bitindex >= 8)
+			{
+				_bitindex = 0;
+				++_index;
+			}
+		}
+
+		return word;
+	}
+
+	// Reads a size written by put_size, which fails if the input ends within the size
+	bool stream::read_size(std::size_t& size)
+	{
+		if (bits_remaining() < 6)
+			return false;
+
+		auto width = static_cast<std::size_t>(read_word(6));
+		if (width > bits_remaining())
+			return false;
+
+		size = static_cast<std::size_t>(read_word(width));
+		return true;
+	}
+
+	// Peek the next 64 bits, padding with zeros beyond the end of the buffer
+	std::uint64_t stream::peek_word() const
+	{
+		if (_index + 8 <= _buffer.size())
+			return peek_word_fast();
+
+		std::uint64_t word { 0 };
+		for (auto i = _index; i < _buffer.size(); i++)
+			word |= static_cast<std::uint64_t>(_buffer[i]) << (8 * (i - _index));
+
+		return word >> _bitindex;
+	}
+
 	// Read the next byte without changing the index
 	auto stream::peek() const -> stream::byte_t
 	{
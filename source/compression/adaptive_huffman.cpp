@@ -0,0 +1,176 @@
+/////////////////////////////////////////////////////////////////////////
+// Adaptive Huffman coding compression algorithm implementation
+/////////////////////////////////////////////////////////////////////////
+#include <compression/adaptive_huffman.h>
+
+#include <algorithm>
+
+#include <compression/histogram.h>
+#include <compression/prefix_code.h>
+#include <compression/stored.h>
+
+namespace
+{
+	using byte = bytes::stream::byte_t;
+
+	// Symbols are the byte values followed by the end-of-stream symbol
+	constexpr std::size_t symbols = 257;
+	constexpr std::size_t end_of_stream = 256;
+
+	// Codes are limited in length, so that every code is decoded with a single table lookup
+	constexpr std::size_t max_length = 12;
+
+	// The codes are rebuilt after a number of symbols that doubles from the first to the last interval
+	constexpr std::size_t first_interval = 64;
+	constexpr std::size_t last_interval = 16384;
+
+	// Frequencies are halved beyond this total, so that the codes follow changes in the data
+	constexpr std::size_t max_total = 1 << 18;
+
+	using code_t = compression::prefix_code<symbols, max_length>;
+	using table_t = compression::prefix_table<symbols, max_length>;
+
+	// The frequency model shared by the encoder and decoder, with the codes for the current frequencies
+	class model
+	{
+		public:
+			// Constructor / destructor (the decoder also needs the lookup table)
+			explicit model(bool is_decoder) : _is_decoder(is_decoder), _counts({}), _total(symbols), _interval(first_interval), _pending(first_interval)
+			{
+				_counts.fill(1);
+				rebuild();
+			}
+			~model() {}
+
+			// Accessors
+			const code_t& codes() const { return _codes; }
+			const table_t::entry& lookup(std::uint64_t bits) const { return _table[bits]; }
+
+			// Count a symbol, rebuilding the codes at the end of each interval
+			void update(std::size_t symbol)
+			{
+				++_counts[symbol];
+				++_total;
+				if (--_pending > 0)
+					return;
+
+				if (_total > max_total)
+				{
+					_total = 0;
+					for (auto& count : _counts)
+						_total += (count = count / 2 + 1);
+				}
+
+				rebuild();
+				_interval = std::min(_interval * 2, last_interval);
+				_pending = _interval;
+			}
+
+		private:
+			void rebuild()
+			{
+				auto lengths = code_t::lengths(_counts);
+				_codes = code_t { lengths };
+				if (_is_decoder)
+					_table = table_t { lengths };
+			}
+
+			bool _is_decoder;
+			code_t::counts_t _counts;
+			std::size_t _total;
+			std::size_t _interval;
+			std::size_t _pending;
+			code_t _codes;
+			table_t _table;
+	};
+}
+
+// ----------------------------------------------------------------------
+// Estimation
+// ----------------------------------------------------------------------
+std::size_t compression::adaptive_huffman::estimate(const compression::histogram& freqs)
+{
+	// Code the data with the codes for the final frequencies, plus the cost of learning each byte value
+	code_t::counts_t counts {};
+	for (std::size_t value = 0; value < freqs.counts().size(); value++)
+		counts[value] = freqs.counts()[value] + 1;
+	counts[end_of_stream] = 1;
+
+	auto lengths = code_t::lengths(counts);
+	std::size_t bits = 1 + lengths[end_of_stream] + 8 * freqs.distinct();
+	for (std::size_t value = 0; value < freqs.counts().size(); value++)
+		bits += freqs.counts()[value] * lengths[value];
+
+	return (std::min(bits, compression::stored::bits(freqs.total())) + 7) / 8;
+}
+
+// ----------------------------------------------------------------------
+// Compression
+// ----------------------------------------------------------------------
+bool compression::adaptive_huffman::compress(bytes::stream& input, bytes::stream& output)
+{
+	auto count = input.buffer().size() - input.index();
+	auto data = input.buffer().data() + input.index();
+
+	// Count the bits of the codes with a model of its own, as the codes change with the data
+	model counter { false };
+	std::size_t bits { 1 };
+	for (std::size_t i = 0; i < count; i++)
+	{
+		bits += counter.codes()[data[i]].length;
+		counter.update(data[i]);
+	}
+
+	bits += counter.codes()[end_of_stream].length;
+
+	// Store the data as-is if encoding would not make it smaller
+	if (bits >= compression::stored::bits(count, output.bitindex()))
+	{
+		compression::stored::put(input, output);
+		return true;
+	}
+
+	compression::stored::put_encoded(output);
+
+	model coder { false };
+	for (std::size_t i = 0; i < count; i++)
+	{
+		coder.codes().put(output, data[i]);
+		coder.update(data[i]);
+	}
+
+	coder.codes().put(output, end_of_stream);
+	input.seek(input.buffer().size());
+	return true;
+}
+
+// ----------------------------------------------------------------------
+// Decompression
+// ----------------------------------------------------------------------
+bool compression::adaptive_huffman::decompress(bytes::stream& input, bytes::stream& output)
+{
+	// Ensure that some data is available
+	if (input.at_end())
+		return false;
+
+	// Stored blocks are copied directly
+	if (compression::stored::is_stored(input))
+		return compression::stored::get(input, output);
+
+	model coder { true };
+	while (true)
+	{
+		// Peek without end-of-stream checks while at least 8 bytes of input remain
+		auto bits = input.bits_remaining() >= 64 ? input.peek_word_fast() : input.peek_word();
+		const auto& e = coder.lookup(bits);
+		if (e.length == 0 || e.length > input.bits_remaining())
+			return false;
+
+		input.skip_bits(e.length);
+		if (e.symbol == end_of_stream)
+			return true;
+
+		output.put(static_cast<byte>(e.symbol));
+		coder.update(e.symbol);
+	}
+}
@@ -0,0 +1,85 @@
+/////////////////////////////////////////////////////////////////////////
+// Batches of small records implementation
+/////////////////////////////////////////////////////////////////////////
+#include <compression/batch.h>
+
+#include <numeric>
+
+#include <compression/histogram.h>
+
+// ----------------------------------------------------------------------
+// Table
+// ----------------------------------------------------------------------
+compression::histogram compression::batch::frequencies(std::span<const buffer_t> records, std::size_t sample_size)
+{
+	auto total = std::accumulate(records.begin(), records.end(), std::size_t { 0 }, [](std::size_t sum, const auto& record) { return sum + record.size(); });
+
+	// Count every k-th record, where a sample size of zero counts every record
+	auto step = sample_size == 0 || total <= sample_size ? std::size_t { 1 } : (total + sample_size - 1) / sample_size;
+
+	histogram result {};
+	for (std::size_t i = 0; i < records.size(); i += step)
+		result.add(records[i].data(), records[i].size());
+
+	return result;
+}
+
+// ----------------------------------------------------------------------
+// Compression
+// ----------------------------------------------------------------------
+bool compression::batch::compress(std::span<const buffer_t> records, buffer_t& header, std::vector<buffer_t>& payloads, const options& settings)
+{
+	auto table = dictionary::train_huffman(frequencies(records, settings.sample_size()));
+
+	// Code each record straight from its buffer into one output stream, keeping its memory between records
+	payloads.clear();
+	payloads.reserve(records.size());
+	bytes::stream output {};
+	for (const auto& record : records)
+	{
+		output.clear();
+		if (!table.compress(record, output))
+			return false;
+
+		payloads.push_back(output.buffer());
+	}
+
+	output.clear();
+	table.save(output);
+	header = output.buffer();
+	return true;
+}
+
+// ----------------------------------------------------------------------
+// Decompression
+// ----------------------------------------------------------------------
+bool compression::batch::open(const buffer_t& header, dictionary& table)
+{
+	bytes::stream input { header };
+	return dictionary::load(input, table);
+}
+
+bool compression::batch::decompress(const dictionary& table, const buffer_t& payload, buffer_t& record)
+{
+	bytes::stream input { payload };
+	bytes::stream output {};
+	if (!table.decompress(input, output))
+		return false;
+
+	record = output.buffer();
+	return true;
+}
+
+bool compression::batch::decompress(const buffer_t& header, std::span<const buffer_t> payloads, std::vector<buffer_t>& records)
+{
+	dictionary table {};
+	if (!open(header, table))
+		return false;
+
+	records.resize(payloads.size());
+	for (std::size_t i = 0; i < payloads.size(); i++)
+		if (!decompress(table, payloads[i], records[i]))
+			return false;
+
+	return true;
+}
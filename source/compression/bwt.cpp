@@ -0,0 +1,447 @@
+/////////////////////////////////////////////////////////////////////////
+// Burrows-Wheeler transform implementation
+//
+// The output starts with the number of bytes, followed by the blocks.
+// Each block starts with the stored flag, where a stored block holds the
+// bytes that coding would not make fewer as-is. A coded block has its
+// number of bytes, the row of the unrotated block and the number of coded
+// bytes, after which the coded bytes follow from the next byte boundary.
+// Runs of zeros after the move-to-front step are coded as bijective
+// base-2 numbers with the digits 0 and 1, other values v are written as
+// v + 1, where 254 and 255 are written as 255 followed by v - 254.
+/////////////////////////////////////////////////////////////////////////
+#include <compression/bwt.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <numeric>
+
+#include <compression/histogram.h>
+#include <compression/stored.h>
+
+namespace
+{
+	using byte = bytes::stream::byte_t;
+
+	// Coded values for the digits of zero runs and for the escaped move-to-front values
+	constexpr byte run_digits = 2;
+	constexpr byte escape = 255;
+	constexpr std::size_t escaped_values = 254;
+
+	// ----------------------------------------------------------------------
+	// Suffix sorting
+	// ----------------------------------------------------------------------
+	// Start (or end) of the bucket of each character
+	void find_buckets(const std::int32_t* s, std::size_t n, std::vector<std::int32_t>& buckets, bool is_end)
+	{
+		std::fill(buckets.begin(), buckets.end(), 0);
+		for (std::size_t i = 0; i < n; i++)
+			++buckets[s[i]];
+
+		std::int32_t sum { 0 };
+		for (auto& bucket : buckets)
+		{
+			sum += bucket;
+			bucket = is_end ? sum : sum - bucket;
+		}
+	}
+
+	// Sort the L-type suffixes from the sorted LMS suffixes, followed by the S-type suffixes from the L-type ones
+	void induce(const std::int32_t* s, std::int32_t* sa, std::size_t n, const std::vector<bool>& is_s, std::vector<std::int32_t>& buckets)
+	{
+		find_buckets(s, n, buckets, false);
+		for (std::size_t i = 0; i < n; i++)
+		{
+			auto j = sa[i] - 1;
+			if (j >= 0 && !is_s[j])
+				sa[buckets[s[j]]++] = j;
+		}
+
+		find_buckets(s, n, buckets, true);
+		for (auto i = n; i-- > 0;)
+		{
+			auto j = sa[i] - 1;
+			if (j >= 0 && is_s[j])
+				sa[--buckets[s[j]]] = j;
+		}
+	}
+
+	// Suffix array of a string of n characters below k, ending with a unique smallest character. The LMS
+	// substrings are sorted by induction and named, and the string of names is sorted recursively when
+	// the names are not unique. The order of the LMS suffixes then induces the order of all suffixes.
+	void sais(const std::int32_t* s, std::int32_t* sa, std::size_t n, std::size_t k)
+	{
+		// Classify the suffixes as S-type (smaller than the next suffix) or L-type
+		std::vector<bool> is_s(n);
+		is_s[n - 1] = true;
+		for (auto i = n - 1; i-- > 0;)
+			is_s[i] = s[i] < s[i + 1] || (s[i] == s[i + 1] && is_s[i + 1]);
+
+		auto is_lms = [&](std::int32_t i) { return i > 0 && is_s[i] && !is_s[i - 1]; };
+
+		// Sort the LMS substrings, placing the LMS positions at the ends of their buckets
+		std::vector<std::int32_t> buckets(k);
+		find_buckets(s, n, buckets, true);
+		std::fill(sa, sa + n, -1);
+		for (std::size_t i = 1; i < n; i++)
+			if (is_lms(static_cast<std::int32_t>(i)))
+				sa[--buckets[s[i]]] = static_cast<std::int32_t>(i);
+
+		induce(s, sa, n, is_s, buckets);
+
+		// Move the sorted LMS substrings to the front
+		std::size_t lms_count { 0 };
+		for (std::size_t i = 0; i < n; i++)
+			if (is_lms(sa[i]))
+				sa[lms_count++] = sa[i];
+
+		// Name the LMS substrings by their order, where equal substrings get equal names. As LMS positions
+		// are at least two apart, the names fit the second half of the array by position.
+		std::fill(sa + lms_count, sa + n, -1);
+		std::int32_t names { 0 };
+		std::int32_t previous { -1 };
+		for (std::size_t i = 0; i < lms_count; i++)
+		{
+			auto position = sa[i];
+			auto is_different = previous < 0;
+			for (std::int32_t d = 0; !is_different; d++)
+			{
+				if (s[position + d] != s[previous + d] || is_s[position + d] != is_s[previous + d])
+					is_different = true;
+				else if (d > 0 && (is_lms(position + d) || is_lms(previous + d)))
+					break;
+			}
+
+			if (is_different)
+			{
+				++names;
+				previous = position;
+			}
+
+			sa[lms_count + position / 2] = names - 1;
+		}
+
+		for (auto i = n, j = n; i-- > lms_count;)
+			if (sa[i] >= 0)
+				sa[--j] = sa[i];
+
+		// Sort the LMS suffixes by sorting the string of names
+		auto reduced = sa + n - lms_count;
+		if (static_cast<std::size_t>(names) < lms_count)
+		{
+			sais(reduced, sa, lms_count, static_cast<std::size_t>(names));
+		}
+		else
+		{
+			for (std::size_t i = 0; i < lms_count; i++)
+				sa[reduced[i]] = static_cast<std::int32_t>(i);
+		}
+
+		// Map the order of the names back to the LMS positions, and place them at the ends of their buckets
+		for (std::size_t i = 1, j = 0; i < n; i++)
+			if (is_lms(static_cast<std::int32_t>(i)))
+				reduced[j++] = static_cast<std::int32_t>(i);
+
+		for (std::size_t i = 0; i < lms_count; i++)
+			sa[i] = reduced[sa[i]];
+
+		std::fill(sa + lms_count, sa + n, -1);
+		find_buckets(s, n, buckets, true);
+		for (auto i = lms_count; i-- > 0;)
+		{
+			auto j = sa[i];
+			sa[i] = -1;
+			sa[--buckets[s[j]]] = j;
+		}
+
+		induce(s, sa, n, is_s, buckets);
+	}
+
+	// Suffix array of the data followed by an end marker, which is smaller than every byte
+	std::vector<std::int32_t> sorted_suffixes(const byte* data, std::size_t count)
+	{
+		std::vector<std::int32_t> s(count + 1);
+		for (std::size_t i = 0; i < count; i++)
+			s[i] = data[i] + 1;
+
+		std::vector<std::int32_t> sa(count + 1);
+		sais(s.data(), sa.data(), count + 1, 257);
+		return sa;
+	}
+
+	// ----------------------------------------------------------------------
+	// Move-to-front and zero run coding
+	// ----------------------------------------------------------------------
+	// Put a run of zeros as a bijective base-2 number, lowest digit first
+	void put_run(std::vector<byte>& coded, std::size_t run)
+	{
+		for (; run > 0; run = (run - 1) >> 1)
+			coded.push_back(static_cast<byte>((run - 1) & 1));
+	}
+
+	std::vector<byte> encode(const std::vector<byte>& data)
+	{
+		std::array<byte, 256> order {};
+		std::iota(order.begin(), order.end(), byte { 0 });
+
+		std::vector<byte> coded {};
+		coded.reserve(data.size() / 2);
+
+		std::size_t run { 0 };
+		for (auto value : data)
+		{
+			if (order[0] == value)
+			{
+				++run;
+				continue;
+			}
+
+			put_run(coded, run);
+			run = 0;
+
+			// Move the value to the front, where every value is in the order and this one is not at the front
+			auto found = std::find(order.begin() + 1, order.end(), value);
+			assert(found != order.end());
+
+			auto position = static_cast<std::size_t>(found - order.begin());
+			std::rotate(order.begin(), found, found + 1);
+
+			if (position < escaped_values)
+			{
+				coded.push_back(static_cast<byte>(position + 1));
+			}
+			else
+			{
+				coded.push_back(escape);
+				coded.push_back(static_cast<byte>(position - escaped_values));
+			}
+		}
+
+		put_run(coded, run);
+		return coded;
+	}
+
+	// Decode count bytes of move-to-front and zero run coded data
+	bool decode(const byte* coded, std::size_t size, byte* data, std::size_t count)
+	{
+		std::array<byte, 256> order {};
+		std::iota(order.begin(), order.end(), byte { 0 });
+
+		std::size_t decoded { 0 };
+		std::size_t run { 0 };
+		std::size_t digit { 0 };
+		for (std::size_t i = 0; i <= size; i++)
+		{
+			if (i < size && coded[i] < run_digits)
+			{
+				// The runs of a valid block never exceed its size
+				if (digit > 32)
+					return false;
+
+				run += std::size_t { coded[i] + 1u } << digit++;
+				continue;
+			}
+
+			if (run > count - decoded)
+				return false;
+
+			std::memset(data + decoded, order[0], run);
+			decoded += run;
+			run = 0;
+			digit = 0;
+			if (i == size)
+				break;
+
+			auto position = static_cast<std::size_t>(coded[i] - 1);
+			if (coded[i] == escape)
+			{
+				if (++i == size || coded[i] > 255 - escaped_values)
+					return false;
+
+				position = escaped_values + coded[i];
+			}
+
+			if (decoded == count)
+				return false;
+
+			auto value = order[position];
+			std::memmove(order.data() + 1, order.data(), position);
+			order[0] = value;
+			data[decoded++] = value;
+		}
+
+		return decoded == count;
+	}
+
+	// ----------------------------------------------------------------------
+	// Transform of a block
+	// ----------------------------------------------------------------------
+	// The last column of the sorted rotations of the data followed by a unique smallest end marker, leaving out
+	// the end marker itself. Returns the row of the end marker, which is the row of the unrotated data.
+	std::size_t transform(const byte* data, std::size_t count, std::vector<byte>& last)
+	{
+		auto sa = sorted_suffixes(data, count);
+
+		last.resize(count);
+		std::size_t primary { 0 };
+		for (std::size_t row = 0, j = 0; row <= count; row++)
+		{
+			if (sa[row] == 0)
+				primary = row;
+			else
+				last[j++] = data[sa[row] - 1];
+		}
+
+		return primary;
+	}
+
+	// Recover the data from the last column, by following each row to the row of the data rotated by one byte.
+	// Each entry holds the next row in the upper bits and the first byte of the row in the lower 8 bits.
+	void inverse(const std::vector<byte>& last, std::size_t primary, byte* data)
+	{
+		auto count = last.size();
+
+		// The rows of each byte value start after the row of the end marker
+		std::array<std::uint32_t, 256> next {};
+		for (auto value : last)
+			++next[value];
+
+		std::uint32_t sum { 1 };
+		for (auto& n : next)
+		{
+			sum += n;
+			n = sum - n;
+		}
+
+		std::vector<std::uint32_t> entries(count + 1);
+		for (std::size_t row = 0; row <= count; row++)
+		{
+			if (row == primary)
+				continue;
+
+			auto value = last[row < primary ? row : row - 1];
+			entries[next[value]++] = static_cast<std::uint32_t>(row << 8) | value;
+		}
+
+		auto row = static_cast<std::uint32_t>(primary);
+		for (std::size_t i = 0; i < count; i++)
+		{
+			auto entry = entries[row];
+			data[i] = static_cast<byte>(entry & 0xFF);
+			row = entry >> 8;
+		}
+	}
+}
+
+// ----------------------------------------------------------------------
+// Estimation
+// ----------------------------------------------------------------------
+std::size_t compression::bwt::estimate(const compression::histogram& freqs)
+{
+	return freqs.total();
+}
+
+// ----------------------------------------------------------------------
+// Suffix array
+// ----------------------------------------------------------------------
+std::vector<std::uint32_t> compression::bwt::suffix_array(const bytes::stream::byte_t* data, std::size_t count)
+{
+	// The suffix of the end marker comes first and is left out
+	auto sa = sorted_suffixes(data, count);
+	return std::vector<std::uint32_t> { sa.cbegin() + 1, sa.cend() };
+}
+
+// ----------------------------------------------------------------------
+// Compression
+// ----------------------------------------------------------------------
+bool compression::bwt::compress(bytes::stream& input, bytes::stream& output)
+{
+	return compress(input, output, options {});
+}
+
+bool compression::bwt::compress(bytes::stream& input, bytes::stream& output, const options& settings)
+{
+	auto data = input.buffer().data() + input.index();
+	auto count = input.buffer().size() - input.index();
+	auto block_size = std::min(settings.block_size(), max_block_size);
+
+	output.put_size(count);
+
+	std::vector<byte> last {};
+	for (std::size_t start = 0; start < count; start += block_size)
+	{
+		auto size = std::min(block_size, count - start);
+		auto primary = transform(data + start, size, last);
+		auto coded = encode(last);
+
+		// Store the block as-is if coding would not make it smaller
+		if (coded.size() >= size)
+		{
+			compression::stored::put(std::span { data + start, size }, output);
+			continue;
+		}
+
+		compression::stored::put_encoded(output);
+		output.put_size(size);
+		output.put_size(primary);
+		output.put_size(coded.size());
+		output.align();
+		output.put_bytes(coded.data(), coded.size());
+	}
+
+	input.seek(input.buffer().size());
+	return true;
+}
+
+// ----------------------------------------------------------------------
+// Decompression
+// ----------------------------------------------------------------------
+bool compression::bwt::decompress(bytes::stream& input, bytes::stream& output)
+{
+	// Get the number of bytes
+	std::size_t count { 0 };
+	if (!input.read_size(count))
+		return false;
+
+	std::vector<byte> last {};
+	for (std::size_t decoded = 0; decoded < count;)
+	{
+		// Stored blocks are copied directly
+		if (compression::stored::is_stored(input))
+		{
+			std::size_t size { 0 };
+			if (!compression::stored::get_size(input, size) || size == 0 || size > count - decoded)
+				return false;
+
+			output.put_bytes(input.buffer().data() + input.index(), size);
+			input.seek(input.index() + size);
+			decoded += size;
+			continue;
+		}
+
+		// Get the header of the block, which must describe a block within the bounds
+		std::size_t header[3] {};
+		for (auto& value : header)
+			if (!input.read_size(value))
+				return false;
+
+		auto [size, primary, coded] = header;
+		input.align();
+		if (size == 0 || size > max_block_size || size > count - decoded || primary == 0 || primary > size || coded > input.bits_remaining() / 8)
+			return false;
+
+		last.resize(size);
+		if (!decode(input.buffer().data() + input.index(), coded, last.data(), size))
+			return false;
+
+		input.seek(input.index() + coded);
+
+		output.allocate(size);
+		inverse(last, primary, output.put_span(size));
+		decoded += size;
+	}
+
+	return true;
+}
@@ -0,0 +1,253 @@
+/////////////////////////////////////////////////////////////////////////
+// Deduplication of repeated chunks implementation
+//
+// The chunk table holds the number of bytes and of chunks, followed by a
+// bit for each chunk telling whether it is a reference. A reference has
+// the index of the unique chunk in as many bits as needed for the unique
+// chunks so far, and a unique chunk has its size.
+/////////////////////////////////////////////////////////////////////////
+#include <compression/dedup.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <unordered_map>
+
+namespace
+{
+	using byte = compression::chunk_table::byte;
+	using chunk_table = compression::chunk_table;
+
+	// Random values for each byte value, added to the rolling hash
+	constexpr std::array<std::uint64_t, 256> gear_table()
+	{
+		std::array<std::uint64_t, 256> result {};
+		std::uint64_t state { 0x9E3779B97F4A7C15 };
+		for (auto& value : result)
+		{
+			// SplitMix64
+			state += 0x9E3779B97F4A7C15;
+			auto z = state;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+			value = z ^ (z >> 31);
+		}
+
+		return result;
+	}
+
+	constexpr auto gear = gear_table();
+
+	// The hash is shifted left for each byte, so its highest bits depend on the most bytes
+	constexpr std::uint64_t mask(std::size_t bits)
+	{
+		return ~std::uint64_t { 0 } << (64 - bits);
+	}
+
+	constexpr std::size_t average_bits = std::bit_width(chunk_table::average_size) - 1;
+	constexpr std::uint64_t strict_mask = mask(average_bits + 2);
+	constexpr std::uint64_t loose_mask = mask(average_bits - 2);
+
+	std::uint64_t read64(const byte* data)
+	{
+		std::uint64_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+}
+
+// ----------------------------------------------------------------------
+// Chunking
+// ----------------------------------------------------------------------
+std::size_t compression::chunk_table::cut(const byte* data, std::size_t count)
+{
+	if (count <= min_size)
+		return count;
+
+	// Skip the hash over the minimum size, and use the strict mask up to the average size
+	auto end = std::min(count, max_size);
+	auto middle = std::min(end, average_size);
+
+	std::uint64_t hash { 0 };
+	std::size_t i { min_size };
+	for (; i < middle; i++)
+	{
+		hash = (hash << 1) + gear[data[i]];
+		if ((hash & strict_mask) == 0)
+			return i + 1;
+	}
+
+	for (; i < end; i++)
+	{
+		hash = (hash << 1) + gear[data[i]];
+		if ((hash & loose_mask) == 0)
+			return i + 1;
+	}
+
+	return end;
+}
+
+std::uint64_t compression::chunk_table::fingerprint(const byte* data, std::size_t count)
+{
+	constexpr std::uint64_t k1 = 0x9E3779B185EBCA87;
+	constexpr std::uint64_t k2 = 0xC2B2AE3D27D4EB4F;
+
+	std::uint64_t hash { count * k1 };
+	std::size_t i { 0 };
+	for (; i + 8 <= count; i += 8)
+		hash = std::rotl(hash ^ (read64(data + i) * k2), 31) * k1;
+
+	for (; i < count; i++)
+		hash = (hash ^ data[i]) * k2;
+
+	hash ^= hash >> 33;
+	hash *= k2;
+	return hash ^ (hash >> 29);
+}
+
+// ----------------------------------------------------------------------
+// Chunk table
+// ----------------------------------------------------------------------
+void compression::chunk_table::put(bytes::stream& input, bytes::stream& output, bytes::stream::buffer_t& uniques)
+{
+	auto data = input.buffer().data() + input.index();
+	auto count = input.buffer().size() - input.index();
+	uniques.reserve(count);
+
+	// The unique chunks by fingerprint, where equal fingerprints are confirmed by comparing the bytes
+	struct unique
+	{
+		std::size_t index;
+		std::size_t start;
+		std::size_t size;
+	};
+	std::unordered_map<std::uint64_t, unique> seen {};
+	std::vector<chunk> chunks {};
+	std::size_t unique_count { 0 };
+
+	for (std::size_t start = 0; start < count;)
+	{
+		auto size = cut(data + start, count - start);
+		auto [entry, is_new] = seen.try_emplace(fingerprint(data + start, size), unique { unique_count, start, size });
+
+		const auto& u = entry->second;
+		if (!is_new && u.size == size && std::memcmp(data + u.start, data + start, size) == 0)
+		{
+			chunks.push_back(chunk { true, u.index });
+		}
+		else
+		{
+			// A chunk with the fingerprint of a different chunk is kept as unique, without being found later
+			chunks.push_back(chunk { false, size });
+			uniques.insert(uniques.end(), data + start, data + start + size);
+			++unique_count;
+		}
+
+		start += size;
+	}
+
+	output.put_size(count);
+	output.put_size(chunks.size());
+
+	unique_count = 0;
+	for (const auto& c : chunks)
+	{
+		output.put_word(c.is_reference ? 1 : 0, 1);
+		if (c.is_reference)
+		{
+			output.put_word(c.value, static_cast<std::size_t>(std::bit_width(unique_count - 1)));
+		}
+		else
+		{
+			output.put_size(c.value);
+			++unique_count;
+		}
+	}
+
+	input.seek(input.buffer().size());
+}
+
+bool compression::chunk_table::get(bytes::stream& input, std::vector<chunk>& chunks, std::size_t& count)
+{
+	// Get the number of bytes and chunks, where every chunk takes at least a bit
+	std::size_t chunk_count { 0 };
+	if (!input.read_size(count) || !input.read_size(chunk_count) || chunk_count > input.bits_remaining())
+		return false;
+
+	chunks.clear();
+	chunks.reserve(chunk_count);
+
+	std::size_t unique_count { 0 };
+	for (std::size_t i = 0; i < chunk_count; i++)
+	{
+		if (input.bits_remaining() < 1)
+			return false;
+
+		if (input.read_word(1) != 0)
+		{
+			auto bits = static_cast<std::size_t>(std::bit_width(unique_count - 1));
+			if (unique_count == 0 || input.bits_remaining() < bits)
+				return false;
+
+			auto index = static_cast<std::size_t>(input.read_word(bits));
+			if (index >= unique_count)
+				return false;
+
+			chunks.push_back(chunk { true, index });
+		}
+		else
+		{
+			std::size_t size { 0 };
+			if (!input.read_size(size))
+				return false;
+
+			chunks.push_back(chunk { false, size });
+			++unique_count;
+		}
+	}
+
+	return true;
+}
+
+bool compression::chunk_table::rebuild(const std::vector<chunk>& chunks, std::size_t count, const bytes::stream& uniques, bytes::stream& output)
+{
+	// Find where each unique chunk starts, and check that the chunks cover the data
+	std::vector<std::size_t> starts {};
+	std::vector<std::size_t> sizes {};
+	std::size_t unique_total { 0 };
+	std::size_t total { 0 };
+	for (const auto& c : chunks)
+	{
+		if (!c.is_reference)
+		{
+			if (c.value > count - unique_total)
+				return false;
+
+			starts.push_back(unique_total);
+			sizes.push_back(c.value);
+			unique_total += c.value;
+		}
+
+		auto size = c.is_reference ? sizes[c.value] : c.value;
+		if (size > count - total)
+			return false;
+
+		total += size;
+	}
+
+	if (total != count || unique_total != uniques.buffer().size())
+		return false;
+
+	output.allocate(count);
+	auto destination = output.put_span(count);
+	std::size_t unique_index { 0 };
+	for (const auto& c : chunks)
+	{
+		auto index = c.is_reference ? c.value : unique_index++;
+		std::memcpy(destination, uniques.buffer().data() + starts[index], sizes[index]);
+		destination += sizes[index];
+	}
+
+	return true;
+}
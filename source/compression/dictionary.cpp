@@ -0,0 +1,231 @@
+/////////////////////////////////////////////////////////////////////////
+// Trained dictionaries implementation
+//
+// A dictionary file holds a magic number, the ID and the code lengths of
+// the byte values. The ID is a hash of the code lengths, so that data is
+// only decoded with the dictionary it was coded with. Compressed data
+// holds the ID in 32 bits, followed by a stored block or by the number of
+// bytes and their codes.
+/////////////////////////////////////////////////////////////////////////
+#include <compression/dictionary.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <vector>
+
+#include <compression/histogram.h>
+#include <compression/stored.h>
+
+namespace
+{
+	using byte = compression::dictionary::byte;
+	using code_t = compression::dictionary::code_t;
+	using lengths_t = compression::dictionary::lengths_t;
+
+	constexpr std::array<byte, 4> magic { 'P', '3', 'D', 1 };
+
+	// FNV-1a hash of the code lengths
+	std::uint32_t hash(const lengths_t& lengths)
+	{
+		std::uint32_t result { 2166136261u };
+		for (auto length : lengths)
+			result = (result ^ length) * 16777619u;
+
+		return result;
+	}
+
+	// Every byte value needs a code, as the data is coded without escapes
+	bool is_complete(const lengths_t& lengths)
+	{
+		return std::none_of(lengths.cbegin(), lengths.cend(), [](auto length) { return length == 0; });
+	}
+
+	// The byte values by decreasing frequency, followed by the missing byte values
+	std::vector<byte> rank(const compression::histogram& freqs)
+	{
+		auto result = freqs.sorted();
+		for (std::size_t value = 0; value < 256; value++)
+			if (freqs[static_cast<byte>(value)] == 0)
+				result.push_back(static_cast<byte>(value));
+
+		return result;
+	}
+
+	// Code lengths of simple<short_symbol_bits, short_symbol_bits + 8> for the ranked byte values
+	lengths_t simple_lengths(const std::vector<byte>& order, std::size_t short_symbol_bits)
+	{
+		auto short_symbols = (std::size_t { 1 } << short_symbol_bits) - 1;
+
+		lengths_t result {};
+		for (std::size_t i = 0; i < order.size(); i++)
+			result[order[i]] = static_cast<std::uint8_t>(i < short_symbols ? short_symbol_bits : short_symbol_bits + 8);
+
+		return result;
+	}
+}
+
+// ----------------------------------------------------------------------
+// Constructor
+// ----------------------------------------------------------------------
+compression::dictionary::dictionary(const lengths_t& lengths) :
+	_lengths(lengths),
+	_id(hash(lengths)),
+	_codes(lengths),
+	_table(is_complete(lengths) ? std::make_shared<const table_t>(lengths) : nullptr)
+{
+}
+
+// ----------------------------------------------------------------------
+// Training
+// ----------------------------------------------------------------------
+compression::dictionary compression::dictionary::train_huffman(const histogram& freqs)
+{
+	code_t::counts_t counts {};
+	for (std::size_t value = 0; value < counts.size(); value++)
+		counts[value] = freqs.counts()[value] + 1;
+
+	return dictionary { code_t::lengths(counts) };
+}
+
+compression::dictionary compression::dictionary::train_simple(const histogram& freqs, std::size_t short_symbol_bits)
+{
+	assert(short_symbol_bits >= 2 && short_symbol_bits + 8 <= max_length);
+	return dictionary { simple_lengths(rank(freqs), short_symbol_bits) };
+}
+
+compression::dictionary compression::dictionary::train_simple(const histogram& freqs)
+{
+	// Choose the sizes of simple2 to simple7 that code the corpus in the fewest bits
+	code_t::counts_t counts {};
+	std::copy(freqs.counts().cbegin(), freqs.counts().cend(), counts.begin());
+
+	auto order = rank(freqs);
+	auto best = simple_lengths(order, 2);
+	for (std::size_t bits = 3; bits + 8 <= max_length; bits++)
+	{
+		auto lengths = simple_lengths(order, bits);
+		if (code_t::cost(counts, lengths) < code_t::cost(counts, best))
+			best = lengths;
+	}
+
+	return dictionary { best };
+}
+
+// ----------------------------------------------------------------------
+// Files
+// ----------------------------------------------------------------------
+void compression::dictionary::save(bytes::stream& output) const
+{
+	output.put_bytes(magic.data(), magic.size());
+	output.put_word(_id, 32);
+	code_t::put_lengths(output, _lengths);
+}
+
+bool compression::dictionary::load(bytes::stream& input, dictionary& result)
+{
+	if (input.bits_remaining() < 8 * magic.size() + 32)
+		return false;
+
+	for (auto value : magic)
+		if (input.read() != value)
+			return false;
+
+	auto id = static_cast<std::uint32_t>(input.read_word(32));
+	lengths_t lengths {};
+	if (!code_t::get_lengths(input, lengths) || !is_complete(lengths) || hash(lengths) != id)
+		return false;
+
+	result = dictionary { lengths };
+	return true;
+}
+
+// ----------------------------------------------------------------------
+// Compression
+// ----------------------------------------------------------------------
+bool compression::dictionary::compress(bytes::stream& input, bytes::stream& output) const
+{
+	if (!compress(std::span { input.buffer().data() + input.index(), input.buffer().size() - input.index() }, output))
+		return false;
+
+	input.seek(input.buffer().size());
+	return true;
+}
+
+bool compression::dictionary::compress(std::span<const byte> data, bytes::stream& output) const
+{
+	if (!_table)
+		return false;
+
+	auto count = data.size();
+	output.put_word(_id, 32);
+
+	// The code lengths are known, so the size of the coded data follows without counting the bytes
+	std::size_t bits = 1 + 6 + static_cast<std::size_t>(std::bit_width(count));
+	for (std::size_t i = 0; i < count; i++)
+		bits += _lengths[data[i]];
+
+	if (bits >= compression::stored::bits(count, output.bitindex()))
+	{
+		compression::stored::put(data, output);
+		return true;
+	}
+
+	compression::stored::put_encoded(output);
+	output.put_size(count);
+
+	// Collect the codes of four bytes, which fit a word, before writing them
+	std::size_t i { 0 };
+	for (; i + 4 <= count; i += 4)
+	{
+		std::uint64_t word { 0 };
+		std::size_t length { 0 };
+		for (std::size_t k = 0; k < 4; k++)
+		{
+			const auto& c = _codes[data[i + k]];
+			word |= static_cast<std::uint64_t>(c.bits) << length;
+			length += c.length;
+		}
+
+		output.put_word(word, length);
+	}
+
+	for (; i < count; i++)
+		_codes.put(output, data[i]);
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+// Decompression
+// ----------------------------------------------------------------------
+bool compression::dictionary::decompress(bytes::stream& input, bytes::stream& output) const
+{
+	// The data must have been coded with this dictionary
+	if (!_table || input.bits_remaining() < 32 || input.read_word(32) != _id)
+		return false;
+
+	if (compression::stored::is_stored(input))
+		return compression::stored::get(input, output);
+
+	// Every code takes at least one bit
+	std::size_t count { 0 };
+	if (!input.read_size(count) || count > input.bits_remaining())
+		return false;
+
+	output.allocate(count);
+	for (std::size_t i = 0; i < count; i++)
+	{
+		// Peek without end-of-stream checks while at least 8 bytes of input remain
+		auto next = input.bits_remaining() >= 64 ? input.peek_word_fast() : input.peek_word();
+		const auto& e = (*_table)[next];
+		if (e.length == 0 || e.length > input.bits_remaining())
+			return false;
+
+		input.skip_bits(e.length);
+		output.put_fast(static_cast<byte>(e.symbol));
+	}
+
+	return true;
+}
@@ -1,158 +1,382 @@
 /////////////////////////////////////////////////////////////////////////
 // Huffman coding compression algorithm implementation
+//
+// The codes are built from the symbols sorted by frequency with the
+// two-queue method, in vectors that the encoder context keeps between
+// calls, as does the decoder context with its decode table.
 /////////////////////////////////////////////////////////////////////////
 #include <compression/huffman.h>
 
-#include <unordered_map>
 #include <algorithm>
-#include <memory>
+#include <array>
+#include <vector>
 
 #include <bytes/dynamic_bitset.h>
+#include <compression/histogram.h>
+#include <compression/stored.h>
 
 namespace
 {
 	using byte = bytes::stream::byte_t;
 
-	struct node
-	{
-		using node_ptr = std::shared_ptr<node>;
+	// Symbols are byte values, plus an escape symbol preceding bytes that are written as-is
+	using symbol_t = std::uint16_t;
+	constexpr symbol_t escape = 256;
+	constexpr std::size_t symbols = 257;
 
-		// Constructors / deconstructor
-		explicit node(byte v) : value(v), first(nullptr), second(nullptr) {}
-		node(node_ptr f, node_ptr s) : value(0), first(f), second(s) { assert(first != nullptr && second != nullptr); }
-		~node() {}
+	// ----------------------------------------------------------------------
+	// Utility functions
+	// ----------------------------------------------------------------------
+	// Read a code written as its 9-bit length followed by the bits
+	bool read_code(bytes::stream& input, bytes::dynamic_bitset& code)
+	{
+		if (input.bits_remaining() < 9)
+			return false;
 
-		// Members - either a value (leaf nodes) or a pair of pointers (branching node)
-		const byte value;
-		const node_ptr first;
-		const node_ptr second;
+		auto bitsize = static_cast<std::size_t>(input.read_bits<9>().to_ulong());
+		if (input.bits_remaining() < bitsize)
+			return false;
 
-		// Checking one pointer should be sufficient
-		bool is_leaf() const noexcept { return first == nullptr; }
-	};
+		for (std::size_t k = 0; k < bitsize; k += bytes::dynamic_bitset::word_bits)
+		{
+			auto length = std::min(bitsize - k, bytes::dynamic_bitset::word_bits);
+			code.add(input.read_word(length), length);
+		}
 
-	using frequency_node_map = std::unordered_map<node::node_ptr, std::size_t>;
-	using frequency_map = std::unordered_map<byte, std::size_t>;
-	using frequency_pair = std::pair<node::node_ptr, std::size_t>;
-	using alphabet = std::unordered_map<byte, const bytes::dynamic_bitset>;
-	using inverse_alphabet = std::unordered_map<std::size_t, byte>;
+		return true;
+	}
 
-	// ----------------------------------------------------------------------
-	// Utility functions
-	// ----------------------------------------------------------------------
-	// Extracts the least frequent byte from a frequency map
-	frequency_pair extract_least_frequent(frequency_node_map& freqs)
+	// Replace an escape symbol by the byte written after it
+	inline bool unescape(bytes::stream& input, symbol_t& value)
 	{
-		// Find the most frequent value
-		auto comparison = [](const frequency_node_map::value_type& lhs, const frequency_node_map::value_type& rhs) { return lhs.second < rhs.second; };
-		auto least_frequent = std::min_element(freqs.cbegin(), freqs.cend(), comparison);
+		if (value != escape)
+			return true;
 
-		assert(least_frequent != freqs.cend());
+		if (input.bits_remaining() < 8)
+			return false;
 
-		// Extract, remove and return the node
-		auto value = frequency_pair(*least_frequent);
-		freqs.erase(least_frequent);
-		return value;
+		value = static_cast<symbol_t>(input.read_word(8));
+		return true;
 	}
 
-	// Traverse the binary tree while building symbols
-	void traverse_tree(node::node_ptr n, std::vector<bool> code, bool next_bit, alphabet& translator)
+	// Table-driven decoder for the codes of an alphabet. Codes of up to lookup_bits bits are
+	// decoded with a single table lookup, while longer codes are found by walking a binary tree.
+	class decode_table
+	{
+		public:
+			static constexpr std::size_t lookup_bits = 11;
+
+			// Constructor / destructor
+			decode_table() : _lookup(1 << lookup_bits, entry { 0, 0 }), _tree(1, branch { 0, 0 }), _max_length(0) {}
+			~decode_table() {}
+
+			// Remove all codes, keeping the memory
+			void reset()
+			{
+				std::fill(_lookup.begin(), _lookup.end(), entry { 0, 0 });
+				_tree.assign(1, branch { 0, 0 });
+				_max_length = 0;
+			}
+
+			// Add a (non-empty) code, returning false if it conflicts with the codes already added
+			bool add(const bytes::dynamic_bitset& code, symbol_t value)
+			{
+				assert(!code.empty());
+
+				// Insert the code in the tree, where a negative child is a leaf holding -(value + 1)
+				std::size_t node { 0 };
+				for (std::size_t i = 0; i < code.size(); i++)
+				{
+					auto& child = _tree[node][code.test(i) ? 1 : 0];
+					if (child < 0 || (child > 0 && i + 1 == code.size()))
+						return false;
+
+					if (i + 1 == code.size())
+					{
+						child = -static_cast<std::int32_t>(value) - 1;
+					}
+					else
+					{
+						if (child == 0)
+						{
+							child = static_cast<std::int32_t>(_tree.size());
+							_tree.push_back(branch { 0, 0 });
+						}
+						node = static_cast<std::size_t>(_tree[node][code.test(i) ? 1 : 0]);
+					}
+				}
+
+				// Short codes fill every lookup entry that starts with the code
+				if (code.size() <= lookup_bits)
+				{
+					auto length = code.size();
+					for (std::size_t suffix = 0; suffix < (std::size_t { 1 } << (lookup_bits - length)); suffix++)
+						_lookup[code.word(0) | (suffix << length)] = entry { value, static_cast<std::uint8_t>(length) };
+				}
+
+				_max_length = std::max(_max_length, code.size());
+				return true;
+			}
+
+			// Decode the next symbol from the stream, given the next bits of the stream. Unless checked,
+			// a full word of input is assumed to be available.
+			template <bool checked> bool decode(bytes::stream& input, std::uint64_t bits, symbol_t& value) const
+			{
+				auto e = _lookup[bits & ((1 << lookup_bits) - 1)];
+				if (e.length == 0 || (checked && e.length > input.bits_remaining()))
+					return walk(input, value);
+
+				input.skip_bits(e.length);
+				value = e.value;
+				return true;
+			}
+
+			std::size_t max_length() const noexcept { return _max_length; }
+
+		private:
+			// Walk the tree one bit at a time with end-of-stream checks
+			bool walk(bytes::stream& input, symbol_t& value) const
+			{
+				std::size_t node { 0 };
+				while (input.bits_remaining() > 0)
+				{
+					auto child = _tree[node][input.read_word(1)];
+					if (child == 0)
+						return false;
+
+					if (child < 0)
+					{
+						value = static_cast<symbol_t>(-child - 1);
+						return true;
+					}
+
+					node = static_cast<std::size_t>(child);
+				}
+
+				return false;
+			}
+
+			struct entry
+			{
+				symbol_t value;
+				std::uint8_t length;	// Zero for codes longer than lookup_bits
+			};
+
+			using branch = std::array<std::int32_t, 2>;
+
+			std::vector<entry> _lookup;
+			std::vector<branch> _tree;
+			std::size_t _max_length;
+	};
+}
+
+// ----------------------------------------------------------------------
+// Context state
+// ----------------------------------------------------------------------
+// The codes of the symbols, with the memory for building them
+struct compression::huffman::code_state
+{
+	std::vector<symbol_t> alphabet;	// The symbols with a code, by increasing frequency
+	std::vector<std::size_t> weight;
+	std::vector<std::size_t> parent;	// The parent of each node, times two, plus the bit leading to the node
+	std::vector<bytes::dynamic_bitset> node_codes;
+	std::vector<bytes::dynamic_bitset> codes;	// Empty for symbols without a code
+	std::vector<bytes::dynamic_bitset> byte_codes;	// The code written for each byte value, including escaped bytes
+
+	// Build the codes from the byte frequencies. With an escape symbol, byte values that do not occur in the
+	// frequencies can still be encoded.
+	void build(const histogram& freqs, bool has_escape)
 	{
-		code.push_back(next_bit);
+		// The escape symbol is given the lowest frequency
+		auto frequency = [&](symbol_t symbol) { return symbol == escape ? std::size_t { 1 } : freqs.counts()[symbol]; };
 
-		if (n->is_leaf())
+		alphabet.clear();
+		for (std::size_t value = 0; value < freqs.counts().size(); value++)
+			if (freqs.counts()[value] > 0)
+				alphabet.push_back(static_cast<symbol_t>(value));
+
+		if (has_escape)
+			alphabet.push_back(escape);
+
+		std::stable_sort(alphabet.begin(), alphabet.end(), [&](auto lhs, auto rhs) { return frequency(lhs) < frequency(rhs); });
+
+		codes.assign(symbols, bytes::dynamic_bitset {});
+		if (alphabet.size() < 2)
 		{
-			translator.emplace(n->value, bytes::dynamic_bitset { code });
+			// A single symbol still takes one bit, which bounds the symbol count by the input size
+			if (!alphabet.empty())
+				codes[alphabet.front()].push_back(false);
+
+			return;
 		}
-		else
+
+		// Nodes are the leaves (in sorted order) followed by the branches in order of creation
+		auto leaves = alphabet.size();
+		weight.assign(2 * leaves - 1, 0);
+		parent.assign(2 * leaves - 1, 0);
+		for (std::size_t i = 0; i < leaves; i++)
+			weight[i] = frequency(alphabet[i]);
+
+		std::size_t next_leaf { 0 };
+		std::size_t next_branch { leaves };
+		for (std::size_t branch = leaves; branch < weight.size(); branch++)
+		{
+			// Take the lightest two nodes from the front of either queue, where the first is reached by a one
+			for (std::size_t bit = 2; bit-- > 0;)
+			{
+				auto is_leaf = next_leaf < leaves && (next_branch == branch || weight[next_leaf] <= weight[next_branch]);
+				auto node = is_leaf ? next_leaf++ : next_branch++;
+				weight[branch] += weight[node];
+				parent[node] = 2 * branch + bit;
+			}
+		}
+
+		// The code of each node extends the code of its parent, where the root has an empty code
+		node_codes.resize(weight.size());
+		node_codes.back().clear();
+		for (auto node = weight.size() - 1; node-- > 0;)
 		{
-			traverse_tree(n->first, code, true, translator);
-			traverse_tree(n->second, code, false, translator);
+			node_codes[node] = node_codes[parent[node] / 2];
+			node_codes[node].push_back(parent[node] % 2 == 1);
 		}
+
+		for (std::size_t i = 0; i < leaves; i++)
+			codes[alphabet[i]] = node_codes[i];
 	}
 
-	// Read the next encoded symbol from the stream
-	bytes::dynamic_bitset read_symbol_from_stream(bytes::stream& input, const inverse_alphabet& translator)
+	// Number of bits of an encoded block, including headers (escaped bytes are not counted)
+	std::size_t encoded_bits(const histogram& freqs) const
 	{
-		bytes::dynamic_bitset result {};
-
-		// Keep reading bits until it matches a symbol
-		while(!translator.contains(result.to_uint()) && !input.at_end())
+		std::size_t bits = 1 + 6 + static_cast<std::size_t>(std::bit_width(freqs.total())) + 9 + 1;
+		for (auto symbol : alphabet)
 		{
-			result.bits.push_back(input.read_bits<1>());
-			assert(result.bits.size() <= 256);
+			if (symbol == escape)
+				bits += 9 + codes[symbol].size();
+			else
+				bits += 8 + 9 + codes[symbol].size() + freqs[static_cast<byte>(symbol)] * codes[symbol].size();
 		}
 
-		// Return the found code
-		return result;
+		return bits;
 	}
-}
 
-// ----------------------------------------------------------------------
-// Hash specializations (for unordered_map)
-// ----------------------------------------------------------------------
-template <> struct std::hash<node>
+	// The code written for each byte value, where byte values without a symbol are escaped
+	void build_byte_codes()
+	{
+		std::array<bool, 256> is_known {};
+		for (auto symbol : alphabet)
+			if (symbol != escape)
+				is_known[symbol] = true;
+
+		auto has_escape = !alphabet.empty() && std::find(alphabet.cbegin(), alphabet.cend(), escape) != alphabet.cend();
+		byte_codes.resize(256);
+		for (std::size_t value = 0; value < byte_codes.size(); value++)
+		{
+			if (is_known[value])
+			{
+				byte_codes[value] = codes[value];
+			}
+			else if (has_escape)
+			{
+				byte_codes[value] = codes[escape];
+				byte_codes[value].add(value, 8);
+			}
+		}
+	}
+};
+
+// The decode table of a block, kept between calls
+struct compression::huffman::decode_state
 {
-	std::size_t operator()(const node& l) const { return std::hash<bytes::stream::byte_t>()(l.value); }
+	decode_table table;
 };
 
-// ----------------------------------------------------------------------
-// Compression function
-// ----------------------------------------------------------------------
-bool compression::huffman::compress(bytes::stream& input, bytes::stream& output)
+namespace
 {
-	// Obtain frequencies for each byte
-	frequency_map freqs {};
-	while (!input.at_end())
-		++freqs[input.read()];
+	// ----------------------------------------------------------------------
+	// Coding
+	// ----------------------------------------------------------------------
+	bool encode(compression::huffman::code_state& state, bytes::stream& input, bytes::stream& output, const compression::options& settings)
+	{
+		// Obtain frequencies for each byte and build the alphabet. Frequencies from a sample
+		// may miss some byte values, which are then written after an escape symbol.
+		auto count = input.buffer().size() - input.index();
+		auto freqs = compression::histogram::sample(input, settings.sample_size());
+		auto has_escape = freqs.distinct() < 256 && settings.sample_size() > 0 && count > settings.sample_size();
+		state.build(freqs, has_escape);
+
+		// Store the data as-is if encoding would not make it smaller
+		if (state.encoded_bits(freqs) >= compression::stored::bits(count, output.bitindex()))
+		{
+			compression::stored::put(input, output);
+			return true;
+		}
 
-	// Generate leaf nodes
-	frequency_node_map freq_nodes {};
-	for (auto i = freqs.cbegin(); i != freqs.cend(); i++)
-		freq_nodes[std::make_shared<node>(i->first)] = i->second;
+		compression::stored::put_encoded(output);
 
-	// Build the binary tree
-	while (freq_nodes.size() > 1)
-	{
-		auto first = extract_least_frequent(freq_nodes);
-		auto second = extract_least_frequent(freq_nodes);
+		// Put the number of symbols, which lets the decoder preallocate and skip end-of-stream checks
+		output.put_size(count);
 
-		auto branch = std::make_shared<node>(first.first, second.first);
-		auto combined_frequency = first.second + second.second;
-		freq_nodes.emplace(branch, combined_frequency);
-	}
+		// Put size of alphabet. Note: Both 0 and 256 should be possible (257 possible values), so 8 bits is not enough
+		output.put_bits<9>(state.alphabet.size() - (has_escape ? 1 : 0));
 
-	// Build the alphabet from the tree
-	alphabet translator {};
-	if (freq_nodes.size() > 0)
-		traverse_tree(freq_nodes.begin()->first, {}, true, translator);
+		// Write the alphabet, as that has to be supplied for decompression
+		for (auto symbol : state.alphabet)
+		{
+			if (symbol == escape)
+				continue;
+
+			const auto& code = state.codes[symbol];
+			assert(code.size() < 257);	// There may only be 256 possible values, so longer codes than that should not be possible
+			output.put_bits<8>(symbol);
+			output.put_bits<9>(std::bitset<9>(code.size()));
+			output.put_bits(code);
+		}
 
-	// Reserve 3 bits for final bitindex in the output buffer
-	output.put_bits(std::bitset<3> { 0 });
+		// Write the escape code, if any
+		output.put_word(has_escape ? 1 : 0, 1);
+		if (has_escape)
+		{
+			const auto& escape_code = state.codes[escape];
+			output.put_bits<9>(std::bitset<9>(escape_code.size()));
+			output.put_bits(escape_code);
+		}
 
-	// Put size of alphabet. Note: Both 0 and 256 should be possible (257 possible values), so 8 bits is not enough
-	output.put_bits<9>(translator.size());
+		// Write the stream using the alphabet
+		state.build_byte_codes();
+		auto data = input.buffer().data() + input.index();
+		for (std::size_t i = 0; i < count; i++)
+			output.put_bits(state.byte_codes[data[i]]);
 
-	// Write the alphabet, as that has to be supplied for decompression
-	for (auto i = translator.cbegin(); i != translator.cend(); i++)
-	{
-		assert(i->second.bits.size() < 257);	// There may only be 256 possible values, so longer codes than that should not be possible
-		output.put_bits<8>(i->first);
-		output.put_bits<9>(std::bitset<9>(i->second.bits.size()));
-		output.put_bits(i->second);
+		input.seek(input.buffer().size());
+		return true;
 	}
 
-	// Reset input stream position and write the stream using the alphabet
-	input.seek(0);
-	while (!input.at_end())
-		output.put_bits(translator.at(input.read()));
+}
 
-	// Write bitindex to the first bits
-	byte output_bitindex = output.bitindex();
-	output.seek(0);
-	output.put_bits(std::bitset<3> { output_bitindex });
+// ----------------------------------------------------------------------
+// Size estimate
+// ----------------------------------------------------------------------
+std::size_t compression::huffman::estimate(const compression::histogram& freqs)
+{
+	code_state state {};
+	state.build(freqs, false);
 
-	return true;
+	auto bits = std::min(state.encoded_bits(freqs), compression::stored::bits(freqs.total()));
+	return (bits + 7) / 8;
+}
+
+// ----------------------------------------------------------------------
+// Compression function
+// ----------------------------------------------------------------------
+bool compression::huffman::compress(bytes::stream& input, bytes::stream& output)
+{
+	return compress(input, output, compression::options {});
+}
+
+bool compression::huffman::compress(bytes::stream& input, bytes::stream& output, const compression::options& settings)
+{
+	code_state state {};
+	return encode(state, input, output, settings);
 }
 
 // ----------------------------------------------------------------------
@@ -161,47 +385,161 @@ bool compression::huffman::compress(bytes::stream& input, bytes::stream& output)
 bool compression::huffman::decompress(bytes::stream& input, bytes::stream& output)
 {
 	// Ensure that some data is available
-	if (input.at_end() || input.buffer().size() < 2)
+	if (input.at_end())
+		return false;
+
+	// Stored blocks are copied directly
+	if (compression::stored::is_stored(input))
+		return compression::stored::get(input, output);
+
+	block_decoder block {};
+	std::size_t count { 0 };
+	if (!block.start(input, count))
 		return false;
 
-	// Read final bitindex (3 first bits of the stream)
-	byte bitindex = static_cast<byte>(input.read_bits<3>().to_ulong());
+	output.allocate(count);
+	return block.decode(input, output.put_span(count), count);
+}
+
+// ----------------------------------------------------------------------
+// Block decoder
+// ----------------------------------------------------------------------
+compression::huffman::block_decoder::block_decoder() :
+	_state(std::make_unique<decode_state>())
+{
+}
+
+compression::huffman::block_decoder::~block_decoder()
+{
+}
+
+compression::huffman::block_decoder::block_decoder(block_decoder&&) = default;
+compression::huffman::block_decoder& compression::huffman::block_decoder::operator=(block_decoder&&) = default;
+
+bool compression::huffman::block_decoder::start(bytes::stream& input, std::size_t& count)
+{
+	// Get the number of symbols
+	if (!input.read_size(count) || input.bits_remaining() < 9)
+		return false;
 
 	// Get size of the alphabet
 	auto alphabet_size = static_cast<std::size_t>(input.read_bits<9>().to_ulong());
+	if (alphabet_size == 0)
+		return count == 0;
+
+	if (alphabet_size > 256)
+		return false;
 
 	// Get the alphabet
-	inverse_alphabet translator {};
-	for (auto i = 0; i < alphabet_size; i++)
+	auto& table = _state->table;
+	table.reset();
+	for (std::size_t i = 0; i < alphabet_size; i++)
 	{
+		if (input.bits_remaining() < 17)
+			return false;
+
 		byte next = input.read();
-		auto bitsize = input.read_bits<9>().to_ulong();
 		bytes::dynamic_bitset symbol {};
-		for (int k = 0; k < bitsize; k++)
-			symbol.bits.push_back(input.read_bits<1>());
+		if (!read_code(input, symbol) || symbol.empty() || !table.add(symbol, next))
+			return false;
+	}
+
+	// Get the escape code, if any
+	if (input.bits_remaining() < 1)
+		return false;
 
-		translator.emplace(symbol.to_uint(), next);
+	if (input.read_word(1) == 1)
+	{
+		bytes::dynamic_bitset symbol {};
+		if (!read_code(input, symbol) || symbol.empty() || !table.add(symbol, escape))
+			return false;
 	}
 
-	// Decompress
-	auto input_size = input.buffer().size();
-	while (!input.at_end())
+	// Every symbol takes at least one bit
+	return count <= input.bits_remaining();
+}
+
+bool compression::huffman::block_decoder::decode(bytes::stream& input, byte* destination, std::size_t count)
+{
+	const auto& table = _state->table;
+	std::size_t decoded { 0 };
+	symbol_t value {};
+
+	// Fast path: decode without end-of-stream checks while at least 8 bytes of input remain. Every symbol
+	// of a batch (including an escaped byte) is guaranteed to start at least a full word before the end.
+	while (decoded < count && input.bits_remaining() >= 64)
 	{
-		// There may be excess bits in the final byte
-		if (bitindex > 0 && input.index() >= input_size - 1 && input.bitindex() >= bitindex)
-			break;
+		auto batch = std::min(count - decoded, (input.bits_remaining() - 64) / (table.max_length() + 8) + 1);
+		for (auto end = decoded + batch; decoded < end; decoded++)
+		{
+			if (!table.decode<false>(input, input.peek_word_fast(), value) || !unescape(input, value))
+				return false;
 
-		// Get the next symbol
-		auto next = read_symbol_from_stream(input, translator);
+			destination[decoded] = static_cast<byte>(value);
+		}
+	}
 
-		// Look up the corresponding byte value
-		auto decoded = translator.find(next.to_uint());
-		if (decoded == translator.end())
+	// Decode the final symbols with end-of-stream checks
+	for (; decoded < count; decoded++)
+	{
+		if (!table.decode<true>(input, input.peek_word(), value) || !unescape(input, value))
 			return false;
 
-		// Write the byte value to the output stream
-		output.put(decoded->second);
+		destination[decoded] = static_cast<byte>(value);
 	}
 
 	return true;
 }
+
+// ----------------------------------------------------------------------
+// Contexts
+// ----------------------------------------------------------------------
+compression::huffman::encoder::encoder(const options& settings) :
+	_settings(settings),
+	_output(),
+	_state(std::make_unique<code_state>())
+{
+}
+
+compression::huffman::encoder::~encoder()
+{
+}
+
+compression::huffman::encoder::encoder(encoder&&) = default;
+compression::huffman::encoder& compression::huffman::encoder::operator=(encoder&&) = default;
+
+bool compression::huffman::encoder::compress(bytes::stream& input)
+{
+	_output.clear();
+	return encode(*_state, input, _output, _settings);
+}
+
+compression::huffman::decoder::decoder() :
+	_output(),
+	_block()
+{
+}
+
+compression::huffman::decoder::~decoder()
+{
+}
+
+compression::huffman::decoder::decoder(decoder&&) = default;
+compression::huffman::decoder& compression::huffman::decoder::operator=(decoder&&) = default;
+
+bool compression::huffman::decoder::decompress(bytes::stream& input)
+{
+	_output.clear();
+	if (input.at_end())
+		return false;
+
+	if (compression::stored::is_stored(input))
+		return compression::stored::get(input, _output);
+
+	std::size_t count { 0 };
+	if (!_block.start(input, count))
+		return false;
+
+	_output.allocate(count);
+	return _block.decode(input, _output.put_span(count), count);
+}
@@ -0,0 +1,411 @@
+/////////////////////////////////////////////////////////////////////////
+// LZ77 compression algorithm implementation
+/////////////////////////////////////////////////////////////////////////
+#include <compression/lz77.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
+#include <vector>
+
+#include <compression/histogram.h>
+#include <compression/huffman.h>
+#include <compression/prefix_code.h>
+#include <compression/stored.h>
+
+namespace
+{
+	using byte = bytes::stream::byte_t;
+	using lz77 = compression::lz77;
+
+	// Literals are followed by the codes for match lengths in the same alphabet
+	constexpr std::size_t literals = 256;
+	constexpr std::size_t length_codes = 28;
+	constexpr std::size_t distance_codes = 32;
+	constexpr std::size_t max_code_length = 12;
+
+	using literal_prefix = compression::prefix_code<literals + length_codes, max_code_length>;
+	using literal_table = compression::prefix_table<literals + length_codes, max_code_length>;
+	using distance_prefix = compression::prefix_code<distance_codes, max_code_length>;
+	using distance_table = compression::prefix_table<distance_codes, max_code_length>;
+
+	// Tokens are coded in blocks, each with its own codes
+	constexpr std::size_t block_tokens = 1 << 16;
+
+	// Matches of the minimum length are not worth a distance beyond this
+	constexpr std::size_t too_far = 4096;
+
+	// A literal (with a length of zero) or a match
+	struct token
+	{
+		std::uint16_t length;
+		std::uint16_t value;	// The literal byte or the distance of the match
+	};
+
+	// ----------------------------------------------------------------------
+	// Length and distance codes
+	// ----------------------------------------------------------------------
+	// Match lengths (minus the minimum) below 8 have a code of their own, while each further
+	// doubling of the length is split over 4 codes followed by extra bits
+	constexpr std::size_t length_code(std::size_t length)
+	{
+		if (length < 8)
+			return length;
+
+		auto extra = static_cast<std::size_t>(std::bit_width(length)) - 3;
+		return 8 + 4 * (extra - 1) + ((length >> extra) & 3);
+	}
+
+	constexpr std::size_t length_extra(std::size_t code) { return code < 8 ? 0 : (code - 8) / 4 + 1; }
+	constexpr std::size_t length_base(std::size_t code) { return code < 8 ? code : (4 + (code - 8) % 4) << length_extra(code); }
+
+	// Distances (minus one) below 4 have a code of their own, while each further doubling of the
+	// distance is split over 2 codes followed by extra bits
+	constexpr std::size_t distance_code(std::size_t distance)
+	{
+		if (distance < 4)
+			return distance;
+
+		auto extra = static_cast<std::size_t>(std::bit_width(distance)) - 2;
+		return 2 * extra + 2 + ((distance >> extra) & 1);
+	}
+
+	constexpr std::size_t distance_extra(std::size_t code) { return code < 4 ? 0 : (code - 2) / 2; }
+	constexpr std::size_t distance_base(std::size_t code) { return code < 4 ? code : (2 + (code & 1)) << distance_extra(code); }
+
+	static_assert(length_code(lz77::max_match - lz77::min_match) == length_codes - 1);
+	static_assert(distance_code(lz77::window_size - 2) == distance_codes - 1);
+
+	// ----------------------------------------------------------------------
+	// Match finder
+	// ----------------------------------------------------------------------
+	// Finds the longest earlier match through chains of the positions with equal hashes of their first bytes
+	class match_finder
+	{
+		public:
+			static constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+
+			struct match
+			{
+				std::size_t length;
+				std::size_t distance;
+			};
+
+			match_finder(const byte* data, std::size_t count, std::size_t depth) :
+				_data(data), _count(count), _depth(depth), _head(std::size_t { 1 } << hash_bits, none), _previous(lz77::window_size, none)
+			{
+			}
+			~match_finder() {}
+
+			// The longest match for a position, or a length of zero when there is none
+			match find(std::size_t position) const
+			{
+				auto limit = std::min(lz77::max_match, _count - position);
+				if (limit < lz77::min_match)
+					return match { 0, 0 };
+
+				match best { lz77::min_match - 1, 0 };
+				auto candidate = _head[hash(position)];
+				for (auto chain = _depth; candidate != none && position - candidate < lz77::window_size && chain > 0; chain--)
+				{
+					// Only compare candidates that may improve on the best match so far
+					if (_data[candidate + best.length] == _data[position + best.length])
+					{
+						auto length = match_length(_data + candidate, _data + position, limit);
+						if (length > best.length)
+						{
+							best = match { length, position - candidate };
+							if (length == limit)
+								break;
+						}
+					}
+
+					auto next = _previous[candidate % lz77::window_size];
+					if (next == none || next >= candidate)
+						break;
+
+					candidate = next;
+				}
+
+				if (best.length < lz77::min_match || (best.length == lz77::min_match && best.distance > too_far))
+					return match { 0, 0 };
+
+				return best;
+			}
+
+			// Add a position to its chain
+			void insert(std::size_t position)
+			{
+				if (position + lz77::min_match > _count)
+					return;
+
+				auto& head = _head[hash(position)];
+				_previous[position % lz77::window_size] = head;
+				head = position;
+			}
+
+		private:
+			static constexpr std::size_t hash_bits = 15;
+
+			std::size_t hash(std::size_t position) const
+			{
+				auto bytes = static_cast<std::uint32_t>(_data[position]) << 16 | static_cast<std::uint32_t>(_data[position + 1]) << 8 | _data[position + 2];
+				return (bytes * 2654435761u) >> (32 - hash_bits);
+			}
+
+			// Number of equal bytes, comparing a word at a time
+			static std::size_t match_length(const byte* lhs, const byte* rhs, std::size_t limit)
+			{
+				std::size_t length { 0 };
+				for (; length + 8 <= limit; length += 8)
+				{
+					std::uint64_t l, r;
+					std::memcpy(&l, lhs + length, sizeof(l));
+					std::memcpy(&r, rhs + length, sizeof(r));
+					if (l != r)
+					{
+						if constexpr (std::endian::native == std::endian::little)
+							return length + static_cast<std::size_t>(std::countr_zero(l ^ r)) / 8;
+						else
+							return length + static_cast<std::size_t>(std::countl_zero(l ^ r)) / 8;
+					}
+				}
+
+				while (length < limit && lhs[length] == rhs[length])
+					length++;
+
+				return length;
+			}
+
+			const byte* _data;
+			std::size_t _count;
+			std::size_t _depth;
+			std::vector<std::size_t> _head;
+			std::vector<std::size_t> _previous;
+	};
+
+	// Split the data into literals and matches
+	std::vector<token> parse(const byte* data, std::size_t count, const compression::options& settings)
+	{
+		std::vector<token> tokens {};
+		match_finder finder { data, count, settings.search_depth() };
+
+		auto current = finder.find(0);
+		for (std::size_t position = 0; position < count;)
+		{
+			finder.insert(position);
+
+			// With lazy matching, a literal is taken when the next position has a longer match
+			auto next = current.length > 0 && settings.is_lazy() ? finder.find(position + 1) : match_finder::match { 0, 0 };
+			if (current.length == 0 || next.length > current.length)
+			{
+				tokens.push_back(token { 0, data[position++] });
+				current = current.length == 0 ? finder.find(position) : next;
+				continue;
+			}
+
+			tokens.push_back(token { static_cast<std::uint16_t>(current.length), static_cast<std::uint16_t>(current.distance) });
+			for (auto end = position + current.length; ++position < end;)
+				finder.insert(position);
+
+			current = finder.find(position);
+		}
+
+		return tokens;
+	}
+
+	// ----------------------------------------------------------------------
+	// Blocks
+	// ----------------------------------------------------------------------
+	// The codes for a block of tokens
+	struct block
+	{
+		std::size_t begin;
+		std::size_t end;
+		literal_prefix::lengths_t literal_lengths;
+		distance_prefix::lengths_t distance_lengths;
+	};
+
+	// Build the codes for a block, returning the number of bits of the block
+	std::size_t build_block(const std::vector<token>& tokens, block& b)
+	{
+		literal_prefix::counts_t literal_counts {};
+		distance_prefix::counts_t distance_counts {};
+		std::size_t bits = 6 + static_cast<std::size_t>(std::bit_width(b.end - b.begin));
+		for (auto i = b.begin; i < b.end; i++)
+		{
+			if (tokens[i].length == 0)
+			{
+				++literal_counts[tokens[i].value];
+				continue;
+			}
+
+			auto length = length_code(tokens[i].length - lz77::min_match);
+			auto distance = distance_code(tokens[i].value - 1u);
+			++literal_counts[literals + length];
+			++distance_counts[distance];
+			bits += length_extra(length) + distance_extra(distance);
+		}
+
+		b.literal_lengths = literal_prefix::lengths(literal_counts);
+		b.distance_lengths = distance_prefix::lengths(distance_counts);
+		return bits + literal_prefix::length_bits(b.literal_lengths) + literal_prefix::cost(literal_counts, b.literal_lengths)
+			+ distance_prefix::length_bits(b.distance_lengths) + distance_prefix::cost(distance_counts, b.distance_lengths);
+	}
+
+	// Write the codes and the tokens of a block
+	void put_block(bytes::stream& output, const std::vector<token>& tokens, const block& b)
+	{
+		output.put_size(b.end - b.begin);
+		literal_prefix::put_lengths(output, b.literal_lengths);
+		distance_prefix::put_lengths(output, b.distance_lengths);
+
+		literal_prefix literal_coder { b.literal_lengths };
+		distance_prefix distance_coder { b.distance_lengths };
+		for (auto i = b.begin; i < b.end; i++)
+		{
+			if (tokens[i].length == 0)
+			{
+				literal_coder.put(output, tokens[i].value);
+				continue;
+			}
+
+			auto length = tokens[i].length - lz77::min_match;
+			auto length_symbol = length_code(length);
+			literal_coder.put(output, literals + length_symbol);
+			output.put_word(length - length_base(length_symbol), length_extra(length_symbol));
+
+			auto distance = tokens[i].value - 1u;
+			auto distance_symbol = distance_code(distance);
+			distance_coder.put(output, distance_symbol);
+			output.put_word(distance - distance_base(distance_symbol), distance_extra(distance_symbol));
+		}
+	}
+}
+
+// ----------------------------------------------------------------------
+// Estimation
+// ----------------------------------------------------------------------
+std::size_t compression::lz77::estimate(const compression::histogram& freqs)
+{
+	return compression::huffman::estimate(freqs);
+}
+
+// ----------------------------------------------------------------------
+// Compression
+// ----------------------------------------------------------------------
+bool compression::lz77::compress(bytes::stream& input, bytes::stream& output)
+{
+	return compress(input, output, compression::options {});
+}
+
+bool compression::lz77::compress(bytes::stream& input, bytes::stream& output, const compression::options& settings)
+{
+	auto count = input.buffer().size() - input.index();
+	auto tokens = parse(input.buffer().data() + input.index(), count, settings);
+
+	// Build the codes of each block
+	std::vector<block> blocks {};
+	std::size_t bits = 1 + 6 + static_cast<std::size_t>(std::bit_width(count));
+	for (std::size_t begin = 0; begin < tokens.size(); begin += block_tokens)
+	{
+		blocks.push_back(block { begin, std::min(begin + block_tokens, tokens.size()), {}, {} });
+		bits += build_block(tokens, blocks.back());
+	}
+
+	// Store the data as-is if encoding would not make it smaller
+	if (bits >= compression::stored::bits(count, output.bitindex()))
+	{
+		compression::stored::put(input, output);
+		return true;
+	}
+
+	compression::stored::put_encoded(output);
+	output.put_size(count);
+	for (const auto& b : blocks)
+		put_block(output, tokens, b);
+
+	input.seek(input.buffer().size());
+	return true;
+}
+
+// ----------------------------------------------------------------------
+// Decompression
+// ----------------------------------------------------------------------
+bool compression::lz77::decompress(bytes::stream& input, bytes::stream& output)
+{
+	constexpr auto length_bases = [] { std::array<std::uint16_t, length_codes> r {}; for (std::size_t c = 0; c < r.size(); c++) r[c] = static_cast<std::uint16_t>(length_base(c)); return r; }();
+	constexpr auto distance_bases = [] { std::array<std::uint16_t, distance_codes> r {}; for (std::size_t c = 0; c < r.size(); c++) r[c] = static_cast<std::uint16_t>(distance_base(c)); return r; }();
+
+	// Ensure that some data is available
+	if (input.at_end())
+		return false;
+
+	// Stored blocks are copied directly
+	if (compression::stored::is_stored(input))
+		return compression::stored::get(input, output);
+
+	// Get the number of bytes
+	std::size_t count { 0 };
+	if (!input.read_size(count) || count > input.bits_remaining() * lz77::max_match)
+		return false;
+
+	output.allocate(count);
+	std::size_t decoded { 0 };
+	while (decoded < count)
+	{
+		// Get the number of tokens and the codes of the block
+		std::size_t tokens { 0 };
+		literal_prefix::lengths_t literal_lengths {};
+		distance_prefix::lengths_t distance_lengths {};
+		if (!input.read_size(tokens) || tokens == 0 || !literal_prefix::get_lengths(input, literal_lengths) || !distance_prefix::get_lengths(input, distance_lengths))
+			return false;
+
+		literal_table literal_entries { literal_lengths };
+		distance_table distance_entries { distance_lengths };
+
+		// Every token takes at most 43 bits, so a single word of input covers it
+		for (std::size_t i = 0; i < tokens; i++)
+		{
+			auto bits = input.bits_remaining() >= 64 ? input.peek_word_fast() : input.peek_word();
+			const auto& literal = literal_entries[bits];
+			if (literal.length == 0 || decoded == count)
+				return false;
+
+			std::size_t used = literal.length;
+			if (literal.symbol < literals)
+			{
+				if (used > input.bits_remaining())
+					return false;
+
+				output.put_fast(static_cast<byte>(literal.symbol));
+				input.skip_bits(used);
+				decoded++;
+				continue;
+			}
+
+			// Get the length and the distance of a match from their codes and extra bits
+			auto length_symbol = literal.symbol - literals;
+			auto length = lz77::min_match + length_bases[length_symbol] + ((bits >> used) & ((std::uint64_t { 1 } << length_extra(length_symbol)) - 1));
+			used += length_extra(length_symbol);
+
+			const auto& distance = distance_entries[bits >> used];
+			if (distance.length == 0)
+				return false;
+
+			used += distance.length;
+			auto offset = 1 + distance_bases[distance.symbol] + ((bits >> used) & ((std::uint64_t { 1 } << distance_extra(distance.symbol)) - 1));
+			used += distance_extra(distance.symbol);
+
+			if (used > input.bits_remaining() || offset > decoded || length > count - decoded)
+				return false;
+
+			output.put_repeat(offset, length);
+			input.skip_bits(used);
+			decoded += length;
+		}
+	}
+
+	return true;
+}
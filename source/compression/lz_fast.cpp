@@ -0,0 +1,297 @@
+/////////////////////////////////////////////////////////////////////////
+// Fast LZ compression algorithm implementation
+//
+// Each sequence starts with a token byte holding the number of literals
+// in the upper 4 bits and the match length minus 4 in the lower 4 bits,
+// where 15 means the number continues in further bytes (255 adding to it
+// and any other value ending it). The literals follow, then the offset of
+// the match in 2 bytes (lowest first) and the continued match length.
+// The last sequence has no match.
+/////////////////////////////////////////////////////////////////////////
+#include <compression/lz_fast.h>
+
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+#include <compression/histogram.h>
+#include <compression/stored.h>
+
+namespace
+{
+	using byte = bytes::stream::byte_t;
+	using lz_fast = compression::lz_fast;
+
+	constexpr std::size_t hash_bits = 14;
+
+	// Misses before the step between probed positions grows, so that incompressible data is skipped quickly
+	constexpr std::size_t skip_strength = 6;
+
+	// ----------------------------------------------------------------------
+	// Utility functions
+	// ----------------------------------------------------------------------
+	std::uint32_t read32(const byte* data)
+	{
+		std::uint32_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	std::size_t hash(std::uint32_t value)
+	{
+		return (value * 2654435761u) >> (32 - hash_bits);
+	}
+
+	// Number of equal bytes, comparing a word at a time
+	std::size_t match_length(const byte* lhs, const byte* rhs, std::size_t limit)
+	{
+		std::size_t length { 0 };
+		for (; length + 8 <= limit; length += 8)
+		{
+			std::uint64_t l, r;
+			std::memcpy(&l, lhs + length, sizeof(l));
+			std::memcpy(&r, rhs + length, sizeof(r));
+			if (l != r)
+			{
+				if constexpr (std::endian::native == std::endian::little)
+					return length + static_cast<std::size_t>(std::countr_zero(l ^ r)) / 8;
+				else
+					return length + static_cast<std::size_t>(std::countl_zero(l ^ r)) / 8;
+			}
+		}
+
+		while (length < limit && lhs[length] == rhs[length])
+			length++;
+
+		return length;
+	}
+
+	// Write the continuation of a number that did not fit the 4 bits of the token
+	void put_length(std::vector<byte>& output, std::size_t length)
+	{
+		if (length < 15)
+			return;
+
+		for (length -= 15; length >= 255; length -= 255)
+			output.push_back(255);
+
+		output.push_back(static_cast<byte>(length));
+	}
+
+	// Read the continuation of a number from the token, returning false at the end of the input
+	bool get_length(const byte*& data, const byte* end, std::size_t& length)
+	{
+		if (length < 15)
+			return true;
+
+		for (byte next = 255; next == 255; length += next)
+		{
+			if (data == end)
+				return false;
+
+			next = *data++;
+		}
+
+		return true;
+	}
+
+	// Copy bytes in words of 16 bytes, where up to 15 bytes beyond the end are written (and read)
+	void wide_copy(byte* destination, const byte* source, std::size_t count)
+	{
+		for (auto end = destination + count; destination < end; destination += 16, source += 16)
+			std::memcpy(destination, source, 16);
+	}
+
+	// Copy a match, which overlaps itself when the offset is less than the length. Words are only used
+	// when there is room for the excess and the offset is large enough for a word to not overlap.
+	void copy_match(byte* destination, std::size_t offset, std::size_t count, std::size_t room)
+	{
+		if (offset >= 16 && count + 15 <= room)
+		{
+			wide_copy(destination, destination - offset, count);
+			return;
+		}
+
+		// Copy the largest chunks that do not overlap, where every chunk doubles the repeated pattern
+		while (count > 0)
+		{
+			auto chunk = std::min(offset, count);
+			std::memcpy(destination, destination - offset, chunk);
+			destination += chunk;
+			count -= chunk;
+			offset += chunk;
+		}
+	}
+
+	// Write a sequence of literals followed by a match, where a match length of zero means no match
+	void put_sequence(std::vector<byte>& output, const byte* literals, std::size_t literal_count, std::size_t offset, std::size_t match)
+	{
+		auto match_code = match > 0 ? match - lz_fast::min_match : 0;
+		output.push_back(static_cast<byte>(std::min<std::size_t>(literal_count, 15) << 4 | std::min<std::size_t>(match_code, 15)));
+		put_length(output, literal_count);
+		output.insert(output.end(), literals, literals + literal_count);
+
+		if (match == 0)
+			return;
+
+		output.push_back(static_cast<byte>(offset));
+		output.push_back(static_cast<byte>(offset >> 8));
+		put_length(output, match_code);
+	}
+
+	// Encode the data as sequences
+	std::vector<byte> encode(const byte* data, std::size_t count)
+	{
+		std::vector<byte> result {};
+		result.reserve(count + count / 255 + 16);
+
+		std::vector<std::uint32_t> table(std::size_t { 1 } << hash_bits);
+		std::size_t anchor { 0 };
+		std::size_t misses { 0 };
+		for (std::size_t position = 0; position + lz_fast::min_match <= count;)
+		{
+			// Probe the last position with the same hash, which is checked as the table is not cleared
+			auto value = read32(data + position);
+			auto& entry = table[hash(value)];
+			std::size_t candidate = entry;
+			entry = static_cast<std::uint32_t>(position);
+
+			if (candidate >= position || position - candidate > lz_fast::max_offset || read32(data + candidate) != value)
+			{
+				position += 1 + (misses++ >> skip_strength);
+				continue;
+			}
+
+			// Extend the match backwards over the pending literals and then forwards
+			while (position > anchor && candidate > 0 && data[position - 1] == data[candidate - 1])
+			{
+				position--;
+				candidate--;
+			}
+
+			auto length = lz_fast::min_match + match_length(data + candidate + lz_fast::min_match, data + position + lz_fast::min_match, count - position - lz_fast::min_match);
+			put_sequence(result, data + anchor, position - anchor, position - candidate, length);
+
+			position += length;
+			anchor = position;
+			misses = 0;
+		}
+
+		if (anchor < count)
+			put_sequence(result, data + anchor, count - anchor, 0, 0);
+
+		return result;
+	}
+}
+
+// ----------------------------------------------------------------------
+// Estimation
+// ----------------------------------------------------------------------
+std::size_t compression::lz_fast::estimate(const compression::histogram& freqs)
+{
+	return freqs.total();
+}
+
+// ----------------------------------------------------------------------
+// Compression
+// ----------------------------------------------------------------------
+bool compression::lz_fast::compress(bytes::stream& input, bytes::stream& output)
+{
+	// The table holds 32-bit positions
+	auto count = input.buffer().size() - input.index();
+	if (count > 0xFFFFFFFF)
+	{
+		compression::stored::put(input, output);
+		return true;
+	}
+
+	auto sequences = encode(input.buffer().data() + input.index(), count);
+
+	// Store the data as-is if encoding would not make it smaller
+	if (sequences.size() >= count)
+	{
+		compression::stored::put(input, output);
+		return true;
+	}
+
+	// The sequences follow the number of bytes from the next byte boundary
+	compression::stored::put_encoded(output);
+	output.put_size(count);
+	output.align();
+	output.put_bytes(sequences.data(), sequences.size());
+
+	input.seek(input.buffer().size());
+	return true;
+}
+
+// ----------------------------------------------------------------------
+// Decompression
+// ----------------------------------------------------------------------
+bool compression::lz_fast::decompress(bytes::stream& input, bytes::stream& output)
+{
+	// Ensure that some data is available
+	if (input.at_end())
+		return false;
+
+	// Stored blocks are copied directly
+	if (compression::stored::is_stored(input))
+		return compression::stored::get(input, output);
+
+	// Get the number of bytes, which can be at most 255 times the remaining input
+	std::size_t count { 0 };
+	if (!input.read_size(count))
+		return false;
+
+	input.align();
+	if (count / 255 > input.buffer().size() - input.index())
+		return false;
+
+	auto data = input.buffer().data() + input.index();
+	auto end = input.buffer().data() + input.buffer().size();
+
+	output.allocate(count);
+	auto destination = output.put_span(count);
+	std::size_t decoded { 0 };
+	while (decoded < count)
+	{
+		if (data == end)
+			return false;
+
+		// Copy the literals
+		auto token = *data++;
+		std::size_t literal_count = token >> 4;
+		if (!get_length(data, end, literal_count) || literal_count > static_cast<std::size_t>(end - data) || literal_count > count - decoded)
+			return false;
+
+		if (literal_count + 15 <= static_cast<std::size_t>(end - data) && literal_count + 15 <= count - decoded)
+			wide_copy(destination + decoded, data, literal_count);
+		else
+			std::memcpy(destination + decoded, data, literal_count);
+
+		data += literal_count;
+		decoded += literal_count;
+		if (decoded == count)
+			break;
+
+		// Copy the match
+		if (end - data < 2)
+			return false;
+
+		std::size_t offset = data[0] | static_cast<std::size_t>(data[1]) << 8;
+		data += 2;
+
+		std::size_t match = token & 0x0F;
+		if (!get_length(data, end, match))
+			return false;
+
+		match += lz_fast::min_match;
+		if (offset == 0 || offset > decoded || match > count - decoded)
+			return false;
+
+		copy_match(destination + decoded, offset, match, count - decoded);
+		decoded += match;
+	}
+
+	input.seek(static_cast<std::size_t>(data - input.buffer().data()));
+	return true;
+}
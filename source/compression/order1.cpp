@@ -0,0 +1,262 @@
+/////////////////////////////////////////////////////////////////////////
+// Order-1 context modelled compression algorithm implementation
+/////////////////////////////////////////////////////////////////////////
+#include <compression/order1.h>
+
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+#include <compression/ans.h>
+#include <compression/histogram.h>
+#include <compression/stored.h>
+#include <compression/tans.h>
+
+namespace
+{
+	using namespace compression::ans;
+	using cluster_map = std::array<std::uint8_t, 256>;
+
+	// ----------------------------------------------------------------------
+	// Utility functions
+	// ----------------------------------------------------------------------
+	// The frequencies of the bytes following each byte value, where the first byte follows a zero
+	std::vector<compression::histogram> context_frequencies(const byte* data, std::size_t count)
+	{
+		std::vector<std::size_t> counts(256 * 256);
+		byte previous { 0 };
+		for (std::size_t i = 0; i < count; i++)
+		{
+			++counts[previous * 256 + data[i]];
+			previous = data[i];
+		}
+
+		std::vector<compression::histogram> result(256);
+		for (std::size_t context = 0; context < 256; context++)
+			for (std::size_t value = 0; value < 256; value++)
+				if (counts[context * 256 + value] > 0)
+					result[context].add(static_cast<byte>(value), counts[context * 256 + value]);
+
+		return result;
+	}
+
+	// Assign the contexts to tables, returning the number of tables. A context gets a table of its own when
+	// that saves the most bits compared to coding it with the frequencies of the whole input.
+	std::size_t assign_clusters(const std::vector<compression::histogram>& contexts, cluster_map& clusters)
+	{
+		compression::histogram all {};
+		for (const auto& freqs : contexts)
+			for (std::size_t value = 0; value < 256; value++)
+				if (freqs[static_cast<byte>(value)] > 0)
+					all.add(static_cast<byte>(value), freqs[static_cast<byte>(value)]);
+
+		auto shared = normalize(all);
+		std::vector<std::pair<double, std::size_t>> gains {};
+		for (std::size_t context = 0; context < contexts.size(); context++)
+		{
+			if (contexts[context].total() == 0)
+				continue;
+
+			auto own = normalize(contexts[context]);
+			auto gain = cost(contexts[context], shared) - cost(contexts[context], own) - static_cast<double>(frequency_bits(own));
+			gains.emplace_back(gain, context);
+		}
+
+		std::stable_sort(gains.begin(), gains.end(), [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+
+		// Contexts that gain get their own table, as long as a table is left for the remaining contexts
+		std::size_t own { 0 };
+		while (own < gains.size() && own + 1 < compression::order1::max_clusters && gains[own].first > 0)
+			own++;
+
+		std::vector<normalized_t> tables {};
+		for (std::size_t i = 0; i < own; i++)
+			tables.push_back(normalize(contexts[gains[i].second]));
+
+		tables.push_back(shared);
+
+		// Every other context joins the table that codes it in the fewest bits, where a table has to
+		// cover all of its values. The table shared by the contexts that join no other is only used
+		// when there are such contexts.
+		clusters.fill(0);
+		std::size_t count { own };
+		for (std::size_t i = 0; i < gains.size(); i++)
+		{
+			if (i < own)
+			{
+				clusters[gains[i].second] = static_cast<std::uint8_t>(i);
+				continue;
+			}
+
+			const auto& freqs = contexts[gains[i].second];
+			auto best = own;
+			auto best_bits = cost(freqs, shared);
+			for (std::size_t k = 0; k < own; k++)
+			{
+				auto is_covered = true;
+				for (std::size_t value = 0; value < 256 && is_covered; value++)
+					is_covered = freqs[static_cast<byte>(value)] == 0 || tables[k][value] > 0;
+
+				auto bits = is_covered ? cost(freqs, tables[k]) : best_bits;
+				if (bits < best_bits)
+				{
+					best = k;
+					best_bits = bits;
+				}
+			}
+
+			clusters[gains[i].second] = static_cast<std::uint8_t>(best);
+			if (best == own)
+				count = own + 1;
+		}
+
+		return count;
+	}
+
+	// Number of bits of the header, following the flag of the block
+	std::size_t header_bits(std::size_t count, std::size_t cluster_count, const std::vector<normalized_t>& normalized)
+	{
+		std::size_t bits = 6 + static_cast<std::size_t>(std::bit_width(count)) + 6 + 256 * static_cast<std::size_t>(std::bit_width(cluster_count - 1));
+		for (const auto& n : normalized)
+			bits += frequency_bits(n);
+
+		return bits;
+	}
+}
+
+// ----------------------------------------------------------------------
+// Estimation
+// ----------------------------------------------------------------------
+std::size_t compression::order1::estimate(const compression::histogram& freqs)
+{
+	return compression::tans::estimate(freqs);
+}
+
+// ----------------------------------------------------------------------
+// Compression
+// ----------------------------------------------------------------------
+bool compression::order1::compress(bytes::stream& input, bytes::stream& output)
+{
+	auto count = input.buffer().size() - input.index();
+	auto data = input.buffer().data() + input.index();
+	if (count == 0)
+	{
+		compression::stored::put(input, output);
+		return true;
+	}
+
+	// Build a table for each cluster of contexts
+	auto contexts = context_frequencies(data, count);
+	cluster_map clusters {};
+	auto cluster_count = assign_clusters(contexts, clusters);
+
+	std::vector<compression::histogram> cluster_freqs(cluster_count);
+	for (std::size_t context = 0; context < contexts.size(); context++)
+		for (std::size_t value = 0; value < 256; value++)
+			if (contexts[context][static_cast<byte>(value)] > 0)
+				cluster_freqs[clusters[context]].add(static_cast<byte>(value), contexts[context][static_cast<byte>(value)]);
+
+	std::vector<normalized_t> normalized {};
+	std::vector<encode_table> tables {};
+	tables.reserve(cluster_count);
+	for (const auto& freqs : cluster_freqs)
+	{
+		normalized.push_back(normalize(freqs));
+		tables.emplace_back(normalized.back());
+	}
+
+	// Encode the bytes in reverse order, as the decoder will visit the states in the opposite order
+	reverse_encoder encoder { count, [&](std::uint32_t& state, std::size_t i) { return tables[clusters[i > 0 ? data[i - 1] : 0]].encode(state, data[i]); } };
+
+	// Store the data as-is if encoding would not make it smaller
+	if (1 + header_bits(count, cluster_count, normalized) + table_log + encoder.bits() >= compression::stored::bits(count, output.bitindex()))
+	{
+		compression::stored::put(input, output);
+		return true;
+	}
+
+	compression::stored::put_encoded(output);
+
+	// Put the number of symbols, the table of each context and the normalized frequencies of each table
+	output.put_size(count);
+	output.put_word(cluster_count - 1, 6);
+
+	auto cluster_bits = static_cast<std::size_t>(std::bit_width(cluster_count - 1));
+	for (auto cluster : clusters)
+		output.put_word(cluster, cluster_bits);
+
+	for (const auto& n : normalized)
+		put_frequencies(output, n);
+
+	// Put the final state of the encoder, which is the first state of the decoder, followed by the bits
+	output.put_word(encoder.state() - table_size, table_log);
+	encoder.put(output);
+
+	input.seek(input.buffer().size());
+	return true;
+}
+
+// ----------------------------------------------------------------------
+// Decompression
+// ----------------------------------------------------------------------
+bool compression::order1::decompress(bytes::stream& input, bytes::stream& output)
+{
+	// Ensure that some data is available
+	if (input.at_end())
+		return false;
+
+	// Stored blocks are copied directly
+	if (compression::stored::is_stored(input))
+		return compression::stored::get(input, output);
+
+	// Get the number of symbols and the number of tables
+	std::size_t count { 0 };
+	if (!input.read_size(count) || input.bits_remaining() < 6)
+		return false;
+
+	auto cluster_count = static_cast<std::size_t>(input.read_word(6)) + 1;
+	if (cluster_count > max_clusters)
+		return false;
+
+	// Get the table of each context
+	auto cluster_bits = static_cast<std::size_t>(std::bit_width(cluster_count - 1));
+	if (input.bits_remaining() < 256 * cluster_bits)
+		return false;
+
+	cluster_map clusters {};
+	for (auto& cluster : clusters)
+	{
+		cluster = static_cast<std::uint8_t>(input.read_word(cluster_bits));
+		if (cluster >= cluster_count)
+			return false;
+	}
+
+	// Get the tables, which may neither be empty nor give every state to a single value (normalize never does)
+	std::vector<decode_table> tables {};
+	tables.reserve(cluster_count);
+	std::uint32_t max_frequency { 0 };
+	for (std::size_t i = 0; i < cluster_count; i++)
+	{
+		normalized_t normalized {};
+		if (!get_frequencies(input, normalized) || normalized == normalized_t {})
+			return false;
+
+		auto frequency = *std::max_element(normalized.cbegin(), normalized.cend());
+		if (frequency == table_size)
+			return false;
+
+		tables.emplace_back(normalized);
+		max_frequency = std::max(max_frequency, frequency);
+	}
+
+	// Every symbol may take zero bits, so only the initial state has to be available, but the symbols
+	// read without bits are limited by the tables
+	if (input.bits_remaining() < table_log)
+		return false;
+
+	auto state = static_cast<std::uint32_t>(input.read_word(table_log));
+	if (count > max_count(max_frequency, input.bits_remaining()))
+		return false;
+
+	return decode(input, output, count, state, [&](byte previous) -> const decode_table& { return tables[clusters[previous]]; });
+}
@@ -0,0 +1,322 @@
+/////////////////////////////////////////////////////////////////////////
+// Stride filters implementation
+//
+// The header holds the mode in the highest bit and the element width in
+// the lower bits of the first byte, and the stride in elements in the
+// second byte. Blocks hold block_elements elements, with byte j of every
+// element in the j-th plane of the block. The last block may be shorter,
+// and bytes after its last whole element are copied as they are.
+//
+// The loops work on whole elements of a fixed type for each width, with
+// the mode as a template parameter, so that the compiler can vectorize
+// them without intrinsics.
+/////////////////////////////////////////////////////////////////////////
+#include <compression/stride_filter.h>
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+	using byte = compression::stride_filter::byte;
+	using mode_t = compression::stride_filter::mode;
+
+	constexpr byte xor_flag = 0x80;
+
+	// ----------------------------------------------------------------------
+	// Utility functions
+	// ----------------------------------------------------------------------
+	// Elements are stored lowest byte first
+	template <typename T> T load(const byte* data)
+	{
+		T value { 0 };
+		if constexpr (std::endian::native == std::endian::little)
+		{
+			std::memcpy(&value, data, sizeof(T));
+		}
+		else
+		{
+			for (std::size_t j = 0; j < sizeof(T); j++)
+				value |= static_cast<T>(static_cast<T>(data[j]) << (8 * j));
+		}
+
+		return value;
+	}
+
+	template <typename T> void store(byte* data, T value)
+	{
+		if constexpr (std::endian::native == std::endian::little)
+		{
+			std::memcpy(data, &value, sizeof(T));
+		}
+		else
+		{
+			for (std::size_t j = 0; j < sizeof(T); j++)
+				data[j] = static_cast<byte>(value >> (8 * j));
+		}
+	}
+
+	// Call a function template with the unsigned type of an element width
+	template <typename F> void with_width(std::size_t width, F&& f)
+	{
+		switch (width)
+		{
+			case 1:
+				return f.template operator()<std::uint8_t>();
+			case 2:
+				return f.template operator()<std::uint16_t>();
+			case 4:
+				return f.template operator()<std::uint32_t>();
+			default:
+				assert(width == 8);
+				return f.template operator()<std::uint64_t>();
+		}
+	}
+
+	// ----------------------------------------------------------------------
+	// Block transforms
+	// ----------------------------------------------------------------------
+	// Group the bytes of the residuals of count elements, where the data starts with the stride elements before them
+	template <typename T, mode_t M> void encode_elements(const byte* data, std::size_t count, std::size_t stride, byte* planes)
+	{
+		auto previous = data;
+		auto current = data + stride * sizeof(T);
+		for (std::size_t e = 0; e < count; e++)
+		{
+			auto value = load<T>(current + e * sizeof(T));
+			auto base = load<T>(previous + e * sizeof(T));
+			auto residual = static_cast<T>(M == mode_t::subtract ? value - base : value ^ base);
+
+			for (std::size_t j = 0; j < sizeof(T); j++)
+				planes[j * count + e] = static_cast<byte>(residual >> (8 * j));
+		}
+	}
+
+	// Recover count elements from the grouped bytes of their residuals, after the stride elements at the start of the data
+	template <typename T, mode_t M> void decode_elements(const byte* planes, std::size_t count, std::size_t stride, byte* data)
+	{
+		auto residual = [&](std::size_t e)
+		{
+			T value { 0 };
+			for (std::size_t j = 0; j < sizeof(T); j++)
+				value |= static_cast<T>(static_cast<T>(planes[j * count + e]) << (8 * j));
+
+			return value;
+		};
+
+		// With a stride of one element, keep the previous element in a register instead of reading it back
+		auto current = data + stride * sizeof(T);
+		if (stride == 1)
+		{
+			auto base = load<T>(data);
+			for (std::size_t e = 0; e < count; e++)
+			{
+				base = static_cast<T>(M == mode_t::subtract ? residual(e) + base : residual(e) ^ base);
+				store<T>(current + e * sizeof(T), base);
+			}
+
+			return;
+		}
+
+		for (std::size_t e = 0; e < count; e++)
+		{
+			auto base = load<T>(data + e * sizeof(T));
+			store<T>(current + e * sizeof(T), static_cast<T>(M == mode_t::subtract ? residual(e) + base : residual(e) ^ base));
+		}
+	}
+}
+
+namespace compression
+{
+	// ----------------------------------------------------------------------
+	// Constructors
+	// ----------------------------------------------------------------------
+	stride_filter::stride_filter() :
+		_mode(mode::subtract),
+		_width(1),
+		_stride(1),
+		_has_header(false),
+		_header({}),
+		_header_count(0)
+	{
+	}
+
+	stride_filter::stride_filter(mode filter_mode, const options& settings) :
+		_mode(filter_mode),
+		_width(settings.element_width),
+		_stride(settings.detect_stride ? 0 : std::max<std::size_t>(settings.stride / settings.element_width, 1)),
+		_has_header(false),
+		_header({}),
+		_header_count(0)
+	{
+		assert(std::has_single_bit(_width) && _width <= 8);
+		assert(settings.stride % _width == 0 && _stride <= max_stride);
+	}
+
+	// ----------------------------------------------------------------------
+	// Stride detection
+	// ----------------------------------------------------------------------
+	std::size_t stride_filter::detect(const byte* data, std::size_t count, std::size_t width)
+	{
+		// Compare the strides over the same bytes, leaving room for the largest stride that is tried
+		count = std::min(count, detect_size);
+		auto start = std::min(max_stride * width, count / 2);
+
+		std::size_t best { 1 };
+		auto best_cost = std::numeric_limits<std::size_t>::max();
+		for (std::size_t stride = 1; stride * width <= start; stride++)
+		{
+			std::size_t cost { 0 };
+			auto distance = stride * width;
+			for (auto i = start; i < count; i++)
+				cost += static_cast<std::size_t>(std::abs(static_cast<std::int8_t>(data[i] - data[i - distance])));
+
+			// A longer stride must be clearly better, as multiples of the stride give similar differences
+			if (cost < best_cost - best_cost / 16)
+			{
+				best = stride;
+				best_cost = cost;
+			}
+		}
+
+		return best;
+	}
+
+	// ----------------------------------------------------------------------
+	// Filter interface
+	// ----------------------------------------------------------------------
+	void stride_filter::encode(const byte* data, std::size_t count, std::vector<byte>& output)
+	{
+		in_blocks(data, count, [&](const byte* block, std::size_t size) { encode_block(block, size, output); });
+	}
+
+	void stride_filter::finish_encode(std::vector<byte>& output)
+	{
+		if (!_pending.empty())
+			encode_block(_pending.data(), _pending.size(), output);
+
+		_pending.clear();
+	}
+
+	bool stride_filter::decode(const byte* data, std::size_t count, std::vector<byte>& output)
+	{
+		// Get the settings from the header, which may be split over chunks
+		for (; count > 0 && !_has_header; data++, count--)
+		{
+			_header[_header_count++] = *data;
+			if (_header_count < _header.size())
+				continue;
+
+			_mode = (_header[0] & xor_flag) != 0 ? mode::exclusive_or : mode::subtract;
+			_width = _header[0] & ~xor_flag;
+			_stride = _header[1];
+			if (!std::has_single_bit(_width) || _width > 8 || _stride == 0)
+				return false;
+
+			_history.assign(_stride * _width, 0);
+			_has_header = true;
+		}
+
+		in_blocks(data, count, [&](const byte* block, std::size_t size) { decode_block(block, size, output); });
+		return true;
+	}
+
+	bool stride_filter::finish_decode(std::vector<byte>& output)
+	{
+		if (!_has_header)
+			return _header_count == 0;
+
+		if (!_pending.empty())
+			decode_block(_pending.data(), _pending.size(), output);
+
+		_pending.clear();
+		return true;
+	}
+
+	// ----------------------------------------------------------------------
+	// Blocks
+	// ----------------------------------------------------------------------
+	// Call a function for every complete block, keeping the bytes of an incomplete block for the next chunk
+	template <typename F> void stride_filter::in_blocks(const byte* data, std::size_t count, F&& block)
+	{
+		auto block_size = block_elements * _width;
+		while (count > 0)
+		{
+			if (_pending.empty() && count >= block_size)
+			{
+				block(data, block_size);
+				data += block_size;
+				count -= block_size;
+				continue;
+			}
+
+			auto size = std::min(count, block_size - _pending.size());
+			_pending.insert(_pending.end(), data, data + size);
+			data += size;
+			count -= size;
+
+			if (_pending.size() == block_size)
+			{
+				block(_pending.data(), block_size);
+				_pending.clear();
+			}
+		}
+	}
+
+	void stride_filter::encode_block(const byte* data, std::size_t count, std::vector<byte>& output)
+	{
+		if (!_has_header)
+		{
+			if (_stride == 0)
+				_stride = detect(data, count, _width);
+
+			output.push_back(static_cast<byte>((_mode == mode::exclusive_or ? xor_flag : 0) | _width));
+			output.push_back(static_cast<byte>(_stride));
+			_history.assign(_stride * _width, 0);
+			_has_header = true;
+		}
+
+		// The elements of the block follow the stride elements before them
+		auto elements = count / _width;
+		_work.resize(_history.size() + elements * _width);
+		std::copy(_history.cbegin(), _history.cend(), _work.begin());
+		std::copy(data, data + elements * _width, _work.begin() + static_cast<std::ptrdiff_t>(_history.size()));
+
+		auto start = output.size();
+		output.resize(start + count);
+		with_width(_width, [&]<typename T>()
+		{
+			if (_mode == mode::subtract)
+				encode_elements<T, mode::subtract>(_work.data(), elements, _stride, output.data() + start);
+			else
+				encode_elements<T, mode::exclusive_or>(_work.data(), elements, _stride, output.data() + start);
+		});
+
+		std::copy(data + elements * _width, data + count, output.begin() + static_cast<std::ptrdiff_t>(start + elements * _width));
+		std::copy(_work.cend() - static_cast<std::ptrdiff_t>(_history.size()), _work.cend(), _history.begin());
+	}
+
+	void stride_filter::decode_block(const byte* data, std::size_t count, std::vector<byte>& output)
+	{
+		auto elements = count / _width;
+		_work.resize(_history.size() + elements * _width);
+		std::copy(_history.cbegin(), _history.cend(), _work.begin());
+
+		with_width(_width, [&]<typename T>()
+		{
+			if (_mode == mode::subtract)
+				decode_elements<T, mode::subtract>(data, elements, _stride, _work.data());
+			else
+				decode_elements<T, mode::exclusive_or>(data, elements, _stride, _work.data());
+		});
+
+		output.insert(output.end(), _work.cbegin() + static_cast<std::ptrdiff_t>(_history.size()), _work.cend());
+		output.insert(output.end(), data + elements * _width, data + count);
+		std::copy(_work.cend() - static_cast<std::ptrdiff_t>(_history.size()), _work.cend(), _history.begin());
+	}
+}
@@ -0,0 +1,110 @@
+/////////////////////////////////////////////////////////////////////////
+// Table-based asymmetric numeral systems compression algorithm implementation
+/////////////////////////////////////////////////////////////////////////
+#include <compression/tans.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <vector>
+
+#include <compression/ans.h>
+#include <compression/histogram.h>
+#include <compression/stored.h>
+
+namespace
+{
+	using namespace compression::ans;
+
+	// Number of bits of the header, following the flag of the block
+	std::size_t header_bits(std::size_t count, const normalized_t& normalized)
+	{
+		return 6 + static_cast<std::size_t>(std::bit_width(count)) + frequency_bits(normalized);
+	}
+}
+
+// ----------------------------------------------------------------------
+// Estimation
+// ----------------------------------------------------------------------
+std::size_t compression::tans::estimate(const compression::histogram& freqs)
+{
+	auto normalized = normalize(freqs);
+	auto bits = static_cast<double>(1 + header_bits(freqs.total(), normalized) + table_log) + cost(freqs, normalized);
+
+	auto encoded = static_cast<std::size_t>(std::ceil(bits));
+	return (std::min(encoded, compression::stored::bits(freqs.total())) + 7) / 8;
+}
+
+// ----------------------------------------------------------------------
+// Compression
+// ----------------------------------------------------------------------
+bool compression::tans::compress(bytes::stream& input, bytes::stream& output)
+{
+	compression::histogram freqs { input };
+	auto normalized = normalize(freqs);
+	auto count = freqs.total();
+
+	// Encode the bytes in reverse order, as the decoder will visit the states in the opposite order
+	encode_table table { normalized };
+	auto data = input.buffer().data() + input.index();
+	reverse_encoder encoder { count, [&](std::uint32_t& state, std::size_t i) { return table.encode(state, data[i]); } };
+
+	// Store the data as-is if encoding would not make it smaller
+	if (1 + header_bits(count, normalized) + table_log + encoder.bits() >= compression::stored::bits(count, output.bitindex()))
+	{
+		compression::stored::put(input, output);
+		return true;
+	}
+
+	compression::stored::put_encoded(output);
+
+	// Put the number of symbols and the normalized frequencies
+	output.put_size(count);
+	put_frequencies(output, normalized);
+
+	// Put the final state of the encoder, which is the first state of the decoder, followed by the bits
+	output.put_word(encoder.state() - table_size, table_log);
+	encoder.put(output);
+
+	input.seek(input.buffer().size());
+	return true;
+}
+
+// ----------------------------------------------------------------------
+// Decompression
+// ----------------------------------------------------------------------
+bool compression::tans::decompress(bytes::stream& input, bytes::stream& output)
+{
+	// Ensure that some data is available
+	if (input.at_end())
+		return false;
+
+	// Stored blocks are copied directly
+	if (compression::stored::is_stored(input))
+		return compression::stored::get(input, output);
+
+	// Get the number of symbols
+	std::size_t count { 0 };
+	if (!input.read_size(count))
+		return false;
+
+	// Get the normalized frequencies
+	normalized_t normalized {};
+	if (!get_frequencies(input, normalized))
+		return false;
+
+	if (normalized == normalized_t {})
+		return count == 0;
+
+	// Every symbol may take zero bits, so only the initial state has to be available, but the symbols
+	// read without bits are limited by the table
+	if (input.bits_remaining() < table_log)
+		return false;
+
+	decode_table table { normalized };
+	auto state = static_cast<std::uint32_t>(input.read_word(table_log));
+	if (count > max_count(*std::max_element(normalized.cbegin(), normalized.cend()), input.bits_remaining()))
+		return false;
+
+	return decode(input, output, count, state, [&](byte) -> const decode_table& { return table; });
+}
@@ -1,8 +1,13 @@
+#include <algorithm>
 #include <iostream>
 #include <string>
+#include <thread>
 
 #include <bytes/stream.h>
+#include <utility/batch_runner.h>
+#include <utility/parallel_runner.h>
 #include <utility/runsettings.h>
+#include <utility/server.h>
 
 int main(int argc, const char** argv)
 {
@@ -16,6 +21,47 @@ int main(int argc, const char** argv)
 		exit(-1);
 	}
 
+	// Run every file of a directory on worker threads, reporting the throughput
+	if (!settings.input_tree().empty())
+	{
+		if (!utility::batch_runner::run(settings, std::cerr))
+		{
+			std::cerr << "Could not run the algorithm on every file!" << std::endl;
+			exit(-1);
+		}
+
+		return 0;
+	}
+
+	// Serve requests over a socket until the process is stopped
+	if (!settings.serve_path().empty())
+	{
+		auto threads = settings.threads() > 0 ? settings.threads() : std::max(std::thread::hardware_concurrency(), 1u);
+		auto max_input_size = settings.max_memory() > 0 ? settings.max_memory() : utility::server::default_max_input_size;
+		utility::server server { settings.serve_path(), threads, max_input_size };
+		if (!server.valid())
+		{
+			std::cerr << "Could not listen on the socket \"" << settings.serve_path() << "\"!" << std::endl;
+			exit(-1);
+		}
+
+		server.wait();
+		return 0;
+	}
+
+	// Run on blocks of the input with worker threads, while reading and writing, in bounded memory
+	if (settings.threads() > 0 || settings.max_memory() > 0)
+	{
+		std::ios::sync_with_stdio(false);
+		if (!utility::parallel_runner::run(settings, std::cin, std::cout))
+		{
+			std::cerr << "Could not run the algorithm on the input!" << std::endl;
+			exit(-1);
+		}
+
+		return 0;
+	}
+
 	// Get input from stdin, i.e. pipe input
 	std::string input;
 	while (getline(std::cin, input, '\n'))
@@ -25,8 +71,21 @@ int main(int argc, const char** argv)
 			buffer.push_back('\n');
 	}
 
-	// Perform the requested operation
-	auto output = settings.run(std::move(buffer));
+	// Perform the requested operation, or have the server perform it
+	bytes::stream::buffer_t output {};
+	if (settings.connect_path().empty())
+	{
+		if (!settings.run(std::move(buffer), output))
+		{
+			std::cerr << "Could not run the algorithm on the input!" << std::endl;
+			exit(-1);
+		}
+	}
+	else if (!utility::server::request(settings.connect_path(), settings.arguments(), buffer, output))
+	{
+		std::cerr << "Could not run the request on the server \"" << settings.connect_path() << "\"!" << std::endl;
+		exit(-1);
+	}
 
 	// Write the output
 	for (auto i = output.cbegin(); i != output.cend(); i++)
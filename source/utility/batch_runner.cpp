@@ -0,0 +1,495 @@
+/////////////////////////////////////////////////////////////////////////
+// Batch runner implementation
+/////////////////////////////////////////////////////////////////////////
+#include <utility/batch_runner.h>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <bytes/stream.h>
+#include <utility/block_frame.h>
+#include <utility/parallel_runner.h>
+
+namespace
+{
+	using buffer_t = bytes::stream::buffer_t;
+	using run_mode = utility::runsettings::settings::mode;
+	using timer = std::chrono::steady_clock;
+
+	// Blocks written with one call
+	constexpr std::size_t max_blocks_per_write = 64;
+
+	// Blocks started and not yet written per worker. With the working memory of the algorithms, this stays within
+	// the blocks of memory per worker that parallel_runner::block_size assumes.
+	constexpr std::size_t started_blocks_per_worker = 4;
+
+	// A part of an input file, which for decompression is a frame without its header
+	struct block
+	{
+		std::size_t offset = 0;	// Offset in the input file
+		std::size_t size = 0;	// Bytes in the input file
+		std::size_t count = 0;	// Uncompressed bytes, for decompression
+		std::size_t position = 0;	// Offset in the output file, for decompression
+	};
+
+	// A file of the tree, with its blocks and the compressed blocks waiting for the blocks before them
+	struct file_job
+	{
+		std::filesystem::path input;
+		std::filesystem::path output;
+		std::filesystem::path name;	// Path relative to the trees
+		std::vector<block> blocks;
+		std::size_t input_size = 0;
+
+		std::mutex mutex;
+		std::vector<std::optional<bytes::stream>> pending;
+		std::size_t next = 0;	// Next block to write, for compression
+		std::size_t finished = 0;
+		std::size_t output_size = 0;
+		bool is_valid = true;
+		bool is_writing = false;	// Whether a worker is writing the pending blocks
+		int input_descriptor = -1;	// Open from the first block of the file to the last
+		int output_descriptor = -1;
+		timer::time_point start {};
+		timer::time_point end {};
+	};
+
+	// A block of a file
+	struct task
+	{
+		std::size_t file;
+		std::size_t block;
+	};
+
+	// Tasks of each worker, behind a single mutex. A worker takes its own tasks and steals those of the others, always
+	// from the front (stealing from the back would start the last blocks of a file, whose output then waits for the
+	// whole file), so that the blocks of a file start in order. As compressed blocks wait for the blocks before them,
+	// the blocks started and not yet written are limited, except for urgent tasks such as the next block to write of
+	// a file.
+	class task_queues
+	{
+		public:
+			task_queues(std::size_t workers, std::size_t max_started) : _mutex(), _is_ready(), _queues(workers), _started(0), _max_started(max_started) {}
+
+			void push(std::size_t worker, task next)
+			{
+				_queues[worker].push_back(next);
+			}
+
+			// Take a task, which fails once every queue is empty, as no tasks are added while running
+			template <typename Urgent>
+			std::optional<task> pop(std::size_t worker, Urgent is_urgent)
+			{
+				std::unique_lock lock { _mutex };
+				while (true)
+				{
+					auto is_empty = true;
+					for (std::size_t i = 0; i < _queues.size(); i++)
+					{
+						auto& queue = _queues[(worker + i) % _queues.size()];
+						if (queue.empty())
+							continue;
+
+						is_empty = false;
+						auto result = queue.front();
+						if (_started < _max_started || is_urgent(result))
+						{
+							queue.pop_front();
+							++_started;
+							return result;
+						}
+					}
+
+					if (is_empty)
+						return {};
+
+					_is_ready.wait(lock);
+				}
+			}
+
+			// Mark started tasks as written or dropped, letting the waiting workers start others
+			void finish(std::size_t count)
+			{
+				{
+					std::lock_guard lock { _mutex };
+					_started -= count;
+				}
+
+				_is_ready.notify_all();
+			}
+
+		private:
+			std::mutex _mutex;
+			std::condition_variable _is_ready;
+			std::vector<std::deque<task>> _queues;
+			std::size_t _started;
+			std::size_t _max_started;
+	};
+
+	// Split a file into blocks, where compressed files are split at their frames
+	bool plan_blocks(run_mode mode, std::size_t block_size, file_job& file)
+	{
+		if (mode == run_mode::compress)
+		{
+			for (std::size_t offset = 0; offset < file.input_size; offset += block_size)
+				file.blocks.push_back({ offset, std::min(block_size, file.input_size - offset), 0, 0 });
+
+			return true;
+		}
+
+		std::ifstream input { file.input, std::ios::binary };
+		std::size_t offset { 0 };
+		std::size_t position { 0 };
+		while (input)
+		{
+			utility::block_frame frame {};
+			auto is_end = false;
+			if (!frame.read(input, is_end))
+				return is_end;
+
+			offset += utility::block_frame::header_size;
+			if (offset + frame.size > file.input_size)
+				return false;
+
+			file.blocks.push_back({ offset, frame.size, frame.count, position });
+			input.seekg(static_cast<std::streamoff>(frame.size), std::ios::cur);
+			offset += frame.size;
+			position += frame.count;
+		}
+
+		return false;
+	}
+
+	// Open the files at the first block of the file, keeping them open until the last
+	bool open_files(file_job& file)
+	{
+		if (file.input_descriptor < 0)
+			file.input_descriptor = ::open(file.input.c_str(), O_RDONLY | O_CLOEXEC);
+
+		if (file.output_descriptor < 0)
+			file.output_descriptor = ::open(file.output.c_str(), O_WRONLY | O_CLOEXEC);
+
+		return file.input_descriptor >= 0 && file.output_descriptor >= 0;
+	}
+
+	void close_files(file_job& file)
+	{
+		for (auto descriptor : { &file.input_descriptor, &file.output_descriptor })
+		{
+			if (*descriptor >= 0)
+				::close(*descriptor);
+
+			*descriptor = -1;
+		}
+	}
+
+	// Read the block of the input file
+	bool read_block(int descriptor, const block& part, buffer_t& data)
+	{
+		data.resize(part.size);
+		std::size_t done { 0 };
+		while (done < part.size)
+		{
+			auto result = ::pread(descriptor, data.data() + done, part.size - done, static_cast<off_t>(part.offset + done));
+			if (result <= 0)
+				break;
+
+			done += static_cast<std::size_t>(result);
+		}
+
+		return done == part.size;
+	}
+
+	// Write all bytes of the vectors, continuing after partial writes
+	bool write_vectors(int descriptor, std::vector<iovec>& vectors)
+	{
+		std::size_t first { 0 };
+		while (first < vectors.size())
+		{
+			auto result = ::writev(descriptor, vectors.data() + first, static_cast<int>(vectors.size() - first));
+			if (result <= 0)
+				return false;
+
+			for (auto written = static_cast<std::size_t>(result); written > 0 && first < vectors.size();)
+			{
+				auto length = std::min(written, vectors[first].iov_len);
+				vectors[first].iov_base = static_cast<char*>(vectors[first].iov_base) + length;
+				vectors[first].iov_len -= length;
+				written -= length;
+				if (vectors[first].iov_len == 0)
+					first++;
+			}
+		}
+
+		return true;
+	}
+
+	// Append the compressed blocks that follow the blocks written so far, with their frame headers, a number of
+	// blocks per call. One worker writes at a time, outside the lock, taking the blocks that the others add meanwhile.
+	bool write_ready_blocks(task_queues& queues, file_job& file, std::unique_lock<std::mutex>& lock)
+	{
+		if (file.is_writing)
+			return true;
+
+		file.is_writing = true;
+		auto is_success = true;
+		while (is_success && file.next < file.pending.size() && file.pending[file.next].has_value())
+		{
+			std::vector<bytes::stream> ready {};
+			std::vector<utility::block_frame::header_t> headers {};
+			for (; file.next < file.pending.size() && ready.size() < max_blocks_per_write && file.pending[file.next].has_value(); file.next++)
+			{
+				ready.push_back(std::move(*file.pending[file.next]));
+				file.pending[file.next].reset();
+
+				const auto& data = ready.back().buffer();
+				headers.push_back(utility::block_frame { file.blocks[file.next].size, data.size() }.header());
+				file.output_size += utility::block_frame::header_size + data.size();
+			}
+
+			lock.unlock();
+			std::vector<iovec> vectors {};
+			for (std::size_t i = 0; i < ready.size(); i++)
+			{
+				const auto& data = ready[i].buffer();
+				vectors.push_back({ headers[i].data(), utility::block_frame::header_size });
+				vectors.push_back({ const_cast<bytes::stream::byte_t*>(data.data()), data.size() });
+			}
+
+			is_success = write_vectors(file.output_descriptor, vectors);
+			ready.clear();
+			queues.finish(headers.size());
+			lock.lock();
+		}
+
+		file.is_writing = false;
+		return is_success;
+	}
+
+	// Write a decompressed block at its place in the output file
+	bool write_block_at(int descriptor, const block& part, const buffer_t& data)
+	{
+		std::size_t done { 0 };
+		while (done < data.size())
+		{
+			auto result = ::pwrite(descriptor, data.data() + done, data.size() - done, static_cast<off_t>(part.position + done));
+			if (result <= 0)
+				break;
+
+			done += static_cast<std::size_t>(result);
+		}
+
+		return done == data.size();
+	}
+
+	// Read, run and write a block of a file, where the blocks of a file that failed are skipped
+	void run_task(const utility::runsettings& settings, task_queues& queues, file_job& file, std::size_t index)
+	{
+		int input_descriptor { -1 };
+		int output_descriptor { -1 };
+		auto is_valid = true;
+		{
+			std::lock_guard lock { file.mutex };
+			if (file.start == timer::time_point {})
+				file.start = timer::now();
+
+			is_valid = file.is_valid && open_files(file);
+			input_descriptor = file.input_descriptor;
+			output_descriptor = file.output_descriptor;
+		}
+
+		const auto& part = file.blocks[index];
+		buffer_t data {};
+		bytes::stream output {};
+		if (is_valid)
+		{
+			// A block running out of memory fails its file, as an exception leaving a worker would end the program
+			try
+			{
+				is_valid = read_block(input_descriptor, part, data);
+
+				bytes::stream input { std::move(data) };
+				is_valid = is_valid && settings.run(input, output);
+			}
+			catch (const std::bad_alloc&)
+			{
+				output = bytes::stream {};
+				is_valid = false;
+			}
+		}
+
+		// Decompressed blocks go to their place in any order, and compressed blocks wait for the blocks before them
+		auto is_decompressed = settings.mode() == run_mode::decompress;
+		if (is_decompressed)
+			is_valid = is_valid && output.buffer().size() == part.count && write_block_at(output_descriptor, part, output.buffer());
+
+		std::unique_lock lock { file.mutex };
+		std::size_t dropped { 0 };
+		if (is_decompressed || !is_valid)
+		{
+			file.output_size += is_decompressed ? output.buffer().size() : 0;
+			dropped++;
+		}
+		else
+		{
+			file.pending[index] = std::move(output);
+			is_valid = write_ready_blocks(queues, file, lock);
+		}
+
+		// A file that failed drops the blocks waiting to be written
+		file.is_valid = file.is_valid && is_valid;
+		if (!file.is_valid)
+		{
+			for (auto& waiting : file.pending)
+			{
+				dropped += waiting.has_value() ? 1 : 0;
+				waiting.reset();
+			}
+		}
+
+		// A task is finished only after writing, so the files are no longer used after the last one
+		if (++file.finished == file.blocks.size())
+		{
+			file.end = timer::now();
+			close_files(file);
+		}
+
+		lock.unlock();
+		queues.finish(dropped);
+	}
+
+	// Throughput of the uncompressed data in MB/s
+	double throughput(std::size_t count, timer::duration duration)
+	{
+		auto seconds = std::chrono::duration<double>(duration).count();
+		return seconds > 0 ? static_cast<double>(count) / seconds / 1e6 : 0.0;
+	}
+}
+
+// ----------------------------------------------------------------------
+// Batch
+// ----------------------------------------------------------------------
+bool utility::batch_runner::run(const runsettings& settings, const std::filesystem::path& input, const std::filesystem::path& output, std::size_t threads, std::size_t block_size, std::ostream& report)
+{
+	assert(threads > 0);
+	assert(block_size > 0 && block_size <= block_frame::max_block_size);
+	assert(settings.mode() != run_mode::train);
+
+	auto mode = settings.mode();
+	auto start = timer::now();
+
+	// Collect the files before creating any output, which may be inside the input tree
+	std::error_code error {};
+	std::vector<std::unique_ptr<file_job>> files {};
+	for (std::filesystem::recursive_directory_iterator entry { input, error }, end {}; !error && entry != end; entry.increment(error))
+	{
+		if (!entry->is_regular_file())
+			continue;
+
+		auto file = std::make_unique<file_job>();
+		file->input = entry->path();
+		file->name = std::filesystem::relative(entry->path(), input);
+		file->output = output / file->name;
+		file->input_size = static_cast<std::size_t>(entry->file_size());
+		files.push_back(std::move(file));
+	}
+
+	if (error)
+	{
+		report << "Could not read the directory \"" << input.string() << "\"." << std::endl;
+		return false;
+	}
+
+	// Plan the blocks, and create every output file, so that the blocks can be written in any order
+	task_queues queues { threads, threads * started_blocks_per_worker };
+	for (std::size_t i = 0; i < files.size(); i++)
+	{
+		auto& file = *files[i];
+		file.is_valid = plan_blocks(mode, block_size, file);
+		file.pending.resize(file.blocks.size());
+
+		std::filesystem::create_directories(file.output.parent_path(), error);
+		file.is_valid = file.is_valid && std::ofstream { file.output, std::ios::binary | std::ios::trunc }.good();
+		if (!file.is_valid)
+			continue;
+
+		for (std::size_t k = 0; k < file.blocks.size(); k++)
+			queues.push(i % threads, { i, k });
+	}
+
+	std::vector<std::jthread> workers {};
+	for (std::size_t worker = 0; worker < threads; worker++)
+	{
+		workers.emplace_back([&, worker]()
+		{
+			// The blocks of decompression are written as they finish, and the blocks of failed files are skipped
+			auto is_urgent = [&](const task& next)
+			{
+				auto& file = *files[next.file];
+				std::lock_guard lock { file.mutex };
+				return mode == run_mode::decompress || !file.is_valid || next.block == file.next;
+			};
+
+			while (auto next = queues.pop(worker, is_urgent))
+				run_task(settings, queues, *files[next->file], next->block);
+		});
+	}
+
+	for (auto& worker : workers)
+		worker.join();
+
+	// Report the throughput of the uncompressed data
+	auto duration = timer::now() - start;
+	auto is_success = true;
+	std::size_t total_input { 0 };
+	std::size_t total_output { 0 };
+	std::size_t total_uncompressed { 0 };
+	report << std::fixed << std::setprecision(1);
+	for (const auto& file : files)
+	{
+		is_success = is_success && file->is_valid;
+		total_input += file->input_size;
+		total_output += file->output_size;
+
+		auto uncompressed = mode == run_mode::compress ? file->input_size : file->output_size;
+		total_uncompressed += uncompressed;
+
+		report << file->name.string() << ": ";
+		if (!file->is_valid)
+		{
+			report << "failed" << std::endl;
+			continue;
+		}
+
+		auto file_duration = file->end - file->start;
+		report << file->input_size << " -> " << file->output_size << " bytes in " << std::chrono::duration<double, std::milli>(file_duration).count()
+			<< " ms (" << throughput(uncompressed, file_duration) << " MB/s)" << std::endl;
+	}
+
+	report << "Total: " << files.size() << " files, " << total_input << " -> " << total_output << " bytes in "
+		<< std::chrono::duration<double, std::milli>(duration).count() << " ms (" << throughput(total_uncompressed, duration) << " MB/s)" << std::endl;
+
+	return is_success;
+}
+
+bool utility::batch_runner::run(const runsettings& settings, std::ostream& report)
+{
+	auto threads = settings.threads() > 0 ? settings.threads() : std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+	auto block_size = settings.max_memory() > 0 ? parallel_runner::block_size(settings.max_memory(), threads) : parallel_runner::default_block_size;
+	return run(settings, settings.input_tree(), settings.output_tree(), threads, block_size, report);
+}
@@ -0,0 +1,52 @@
+/////////////////////////////////////////////////////////////////////////
+// Block framing implementation
+/////////////////////////////////////////////////////////////////////////
+#include <utility/block_frame.h>
+
+namespace
+{
+	using header_t = utility::block_frame::header_t;
+
+	std::size_t get_value(const header_t& header, std::size_t offset)
+	{
+		std::size_t result { 0 };
+		for (std::size_t i = 0; i < 4; i++)
+			result |= static_cast<std::size_t>(header[offset + i]) << (8 * i);
+
+		return result;
+	}
+}
+
+// ----------------------------------------------------------------------
+// Header
+// ----------------------------------------------------------------------
+auto utility::block_frame::header() const -> header_t
+{
+	header_t result {};
+	for (std::size_t i = 0; i < 4; i++)
+	{
+		result[i] = static_cast<unsigned char>(count >> (8 * i));
+		result[4 + i] = static_cast<unsigned char>(size >> (8 * i));
+	}
+
+	return result;
+}
+
+void utility::block_frame::write(std::ostream& output) const
+{
+	auto bytes = header();
+	output.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+bool utility::block_frame::read(std::istream& input, bool& is_end)
+{
+	header_t header {};
+	input.read(reinterpret_cast<char*>(header.data()), header.size());
+	is_end = input.gcount() == 0 && input.eof();
+	if (input.gcount() != static_cast<std::streamsize>(header.size()))
+		return false;
+
+	count = get_value(header, 0);
+	size = get_value(header, 4);
+	return valid();
+}
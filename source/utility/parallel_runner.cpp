@@ -0,0 +1,204 @@
+/////////////////////////////////////////////////////////////////////////
+// Parallel runner implementation
+/////////////////////////////////////////////////////////////////////////
+#include <utility/parallel_runner.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include <bytes/stream.h>
+#include <utility/block_frame.h>
+#include <utility/spsc_queue.h>
+
+namespace
+{
+	using run_mode = utility::runsettings::settings::mode;
+
+	// Blocks going around per worker, so that one is read and one written while the worker runs on another
+	constexpr std::size_t jobs_per_worker = 3;
+
+	// Blocks of memory per worker: the input and output of each job, and the working memory of an algorithm
+	constexpr std::size_t blocks_per_worker = 2 * jobs_per_worker + 2;
+
+	// A block passed from the reader to a worker, from the worker to the writer, and back to the reader
+	struct job
+	{
+		bytes::stream::buffer_t input;
+		bytes::stream output;
+		std::size_t count = 0;	// Size of the uncompressed block
+		bool is_valid = true;
+	};
+
+	// The jobs of a worker and the queues they go around in, where a null job marks the end of the input
+	struct lane
+	{
+		using queue_t = utility::spsc_queue<job*, 4>;
+		static_assert(jobs_per_worker < 4);
+
+		std::array<job, jobs_per_worker> jobs;
+		queue_t to_worker;
+		queue_t to_writer;
+		queue_t to_reader;
+	};
+
+	// Read the next block of the input, which fails at the end of the input. For decompression an invalid
+	// frame gives an invalid job, after which reading stops.
+	bool read_block(run_mode mode, std::istream& input, std::size_t block_size, job& block)
+	{
+		block.is_valid = true;
+		if (mode == run_mode::compress)
+		{
+			block.input.resize(block_size);
+			input.read(reinterpret_cast<char*>(block.input.data()), static_cast<std::streamsize>(block_size));
+			block.count = static_cast<std::size_t>(input.gcount());
+			block.input.resize(block.count);
+			return block.count > 0;
+		}
+
+		utility::block_frame frame {};
+		auto is_end = false;
+		block.is_valid = frame.read(input, is_end);
+		if (is_end)
+			return false;
+
+		if (block.is_valid)
+		{
+			block.count = frame.count;
+			block.input.resize(frame.size);
+			input.read(reinterpret_cast<char*>(block.input.data()), static_cast<std::streamsize>(frame.size));
+			block.is_valid = input.gcount() == static_cast<std::streamsize>(frame.size);
+		}
+
+		return true;
+	}
+
+	// Run the algorithm on a block, keeping the buffers for the next block. A block running out of memory
+	// fails, as an exception leaving a worker thread would end the program.
+	void run_block(const utility::runsettings& settings, job& block)
+	{
+		bytes::stream input { std::move(block.input) };
+		block.output.clear();
+		try
+		{
+			block.is_valid = settings.run(input, block.output);
+		}
+		catch (const std::bad_alloc&)
+		{
+			block.output = bytes::stream {};
+			block.is_valid = false;
+		}
+
+		if (settings.mode() == run_mode::decompress)
+			block.is_valid = block.is_valid && block.output.buffer().size() == block.count;
+
+		block.input = input.release();
+	}
+
+	// Write a block, framed for compression
+	bool write_block(run_mode mode, std::ostream& output, const job& block)
+	{
+		const auto& data = block.output.buffer();
+		if (mode == run_mode::compress)
+			utility::block_frame { block.count, data.size() }.write(output);
+
+		output.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+		return static_cast<bool>(output);
+	}
+}
+
+// ----------------------------------------------------------------------
+// Pipeline
+// ----------------------------------------------------------------------
+bool utility::parallel_runner::run(const runsettings& settings, std::istream& input, std::ostream& output, std::size_t threads, std::size_t block_size)
+{
+	assert(threads > 0 && threads <= max_threads);
+	assert(block_size > 0 && block_size <= block_frame::max_block_size);
+	assert(settings.mode() != run_mode::train);
+
+	auto mode = settings.mode();
+	std::vector<std::unique_ptr<lane>> lanes {};
+	for (std::size_t i = 0; i < threads; i++)
+	{
+		lanes.push_back(std::make_unique<lane>());
+		for (auto& block : lanes.back()->jobs)
+			lanes.back()->to_reader.push(&block);
+	}
+
+	// The reader stops at the end of the input or at the first invalid frame, ending every lane
+	std::jthread reader { [&]()
+	{
+		for (std::size_t i = 0; ; i++)
+		{
+			auto& next = *lanes[i % threads];
+			auto block = next.to_reader.pop();
+			if (!read_block(mode, input, block_size, *block))
+				break;
+
+			auto is_valid = block->is_valid;
+			next.to_worker.push(block);
+			if (!is_valid)
+				break;
+		}
+
+		for (auto& next : lanes)
+			next->to_worker.push(nullptr);
+	} };
+
+	std::vector<std::jthread> workers {};
+	for (auto& worker_lane : lanes)
+	{
+		workers.emplace_back([&settings, &next = *worker_lane]()
+		{
+			while (auto block = next.to_worker.pop())
+			{
+				if (block->is_valid)
+					run_block(settings, *block);
+
+				next.to_writer.push(block);
+			}
+
+			next.to_writer.push(nullptr);
+		});
+	}
+
+	// Write the blocks in order, and after a failure keep taking them without writing, until the reader is done
+	auto is_success = true;
+	for (std::size_t i = 0; ; i++)
+	{
+		auto& next = *lanes[i % threads];
+		auto block = next.to_writer.pop();
+		if (block == nullptr)
+			break;
+
+		is_success = is_success && block->is_valid && write_block(mode, output, *block);
+		next.to_reader.push(block);
+	}
+
+	reader.join();
+	for (auto& worker : workers)
+		worker.join();
+
+	output.flush();
+	return is_success && static_cast<bool>(output);
+}
+
+bool utility::parallel_runner::run(const runsettings& settings, std::istream& input, std::ostream& output)
+{
+	auto threads = std::max(settings.threads(), std::size_t { 1 });
+	auto size = settings.max_memory() > 0 ? block_size(settings.max_memory(), threads) : default_block_size;
+	return run(settings, input, output, threads, size);
+}
+
+// ----------------------------------------------------------------------
+// Memory limit
+// ----------------------------------------------------------------------
+std::size_t utility::parallel_runner::block_size(std::size_t max_memory, std::size_t threads)
+{
+	assert(threads > 0);
+	return std::clamp(max_memory / (threads * blocks_per_worker), min_block_size, block_frame::max_block_size);
+}
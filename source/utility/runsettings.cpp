@@ -3,39 +3,315 @@
 /////////////////////////////////////////////////////////////////////////
 #include <utility/runsettings.h>
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <string>
 #include <unordered_map>
 #include <optional>
 
 #include <compression/compression.h>
+#include <compression/histogram.h>
 #include <compression/identity.h>
 #include <compression/simple.h>
+#include <compression/static_huffman.h>
 #include <compression/huffman.h>
+#include <compression/adaptive_huffman.h>
+#include <compression/tans.h>
+#include <compression/order1.h>
+#include <compression/lz77.h>
+#include <compression/lz_fast.h>
+#include <compression/bwt.h>
+#include <compression/pipeline.h>
+#include <compression/rle.h>
+#include <compression/stride_filter.h>
+#include <compression/dedup.h>
+#include <compression/dictionary.h>
+#include <compression/tuned_simple.h>
+#include <utility/parallel_runner.h>
 
 namespace
 {
 	using algorithm_t = utility::runsettings::settings::algorithm;
+	using mode_t = utility::runsettings::settings::mode;
+	using filter_t = utility::runsettings::settings::filter;
 
 	// Shortcut for calling the algorithm with the correct mode
-	template <typename T> bytes::stream::buffer_t run_algorithm(utility::runsettings::settings::mode mode, bytes::stream::buffer_t&& input)
+	template <typename T> bool run_algorithm(mode_t mode, bytes::stream& input, bytes::stream& output, const compression::options& settings)
 	{
-		if (mode == utility::runsettings::settings::mode::decompress)
-			return decompress<T>(std::move(input));
+		if (mode == mode_t::decompress)
+			return T::decompress(input, output);
 
-		return compress<T>(std::move(input));
+		return compress<T>(input, output, settings);
 	}
 
-	// Map algorithm types to classes
+	// Map algorithm types to classes, including the relative time per byte for compressing and decompressing
 	template <algorithm_t> struct algorithm_choice;
-	template <> struct algorithm_choice<algorithm_t::identity> { using algorithm = typename compression::identity; };
-	template <> struct algorithm_choice<algorithm_t::simple2> { using algorithm = typename compression::simple2; };
-	template <> struct algorithm_choice<algorithm_t::simple3> { using algorithm = typename compression::simple3; };
-	template <> struct algorithm_choice<algorithm_t::simple4> { using algorithm = typename compression::simple4; };
-	template <> struct algorithm_choice<algorithm_t::simple5> { using algorithm = typename compression::simple5; };
-	template <> struct algorithm_choice<algorithm_t::simple6> { using algorithm = typename compression::simple6; };
-	template <> struct algorithm_choice<algorithm_t::simple7> { using algorithm = typename compression::simple7; };
-	template <> struct algorithm_choice<algorithm_t::huffman> { using algorithm = typename compression::huffman; };
+	template <> struct algorithm_choice<algorithm_t::identity> { using algorithm = typename compression::identity; static constexpr double cost = 0.0; };
+	template <> struct algorithm_choice<algorithm_t::simple2> { using algorithm = typename compression::simple2; static constexpr double cost = 1.0; };
+	template <> struct algorithm_choice<algorithm_t::simple3> { using algorithm = typename compression::simple3; static constexpr double cost = 1.0; };
+	template <> struct algorithm_choice<algorithm_t::simple4> { using algorithm = typename compression::simple4; static constexpr double cost = 1.0; };
+	template <> struct algorithm_choice<algorithm_t::simple5> { using algorithm = typename compression::simple5; static constexpr double cost = 1.0; };
+	template <> struct algorithm_choice<algorithm_t::simple6> { using algorithm = typename compression::simple6; static constexpr double cost = 1.0; };
+	template <> struct algorithm_choice<algorithm_t::simple7> { using algorithm = typename compression::simple7; static constexpr double cost = 1.0; };
+	template <> struct algorithm_choice<algorithm_t::huffman> { using algorithm = typename compression::huffman; static constexpr double cost = 2.0; };
+	template <> struct algorithm_choice<algorithm_t::simple> { using algorithm = typename compression::tuned_simple; static constexpr double cost = 1.0; };
+	template <> struct algorithm_choice<algorithm_t::adaptive_huffman> { using algorithm = typename compression::adaptive_huffman; static constexpr double cost = 2.0; };
+	template <> struct algorithm_choice<algorithm_t::tans> { using algorithm = typename compression::tans; static constexpr double cost = 1.5; };
+	template <> struct algorithm_choice<algorithm_t::order1> { using algorithm = typename compression::order1; static constexpr double cost = 2.0; };
+	template <> struct algorithm_choice<algorithm_t::lz77> { using algorithm = typename compression::lz77; static constexpr double cost = 4.0; };
+	template <> struct algorithm_choice<algorithm_t::lz_fast> { using algorithm = typename compression::lz_fast; static constexpr double cost = 0.5; };
+	template <> struct algorithm_choice<algorithm_t::bwt> { using algorithm = typename compression::block_sorting<compression::huffman>; static constexpr double cost = 6.0; };
+	template <> struct algorithm_choice<algorithm_t::static_text> { using algorithm = typename compression::static_text; static constexpr double cost = 1.0; };
+	template <> struct algorithm_choice<algorithm_t::static_json> { using algorithm = typename compression::static_json; static constexpr double cost = 1.0; };
+	template <> struct algorithm_choice<algorithm_t::static_binary> { using algorithm = typename compression::static_binary; static constexpr double cost = 1.0; };
+
+	// The algorithms considered by the automatic mode
+	constexpr algorithm_t registered_algorithms[]
+	{
+		algorithm_t::identity,
+		algorithm_t::simple2,
+		algorithm_t::simple3,
+		algorithm_t::simple4,
+		algorithm_t::simple5,
+		algorithm_t::simple6,
+		algorithm_t::simple7,
+		algorithm_t::huffman,
+		algorithm_t::simple,
+		algorithm_t::adaptive_huffman,
+		algorithm_t::tans,
+		algorithm_t::static_text,
+		algorithm_t::static_json,
+		algorithm_t::static_binary
+	};
+
+	// Call a function template with the algorithm_choice for an algorithm type
+	template <typename F> auto with_algorithm(algorithm_t algorithm, F&& f)
+	{
+		switch (algorithm)
+		{
+			case algorithm_t::identity:
+				return f.template operator()<algorithm_choice<algorithm_t::identity>>();
+			case algorithm_t::simple2:
+				return f.template operator()<algorithm_choice<algorithm_t::simple2>>();
+			case algorithm_t::simple3:
+				return f.template operator()<algorithm_choice<algorithm_t::simple3>>();
+			case algorithm_t::simple4:
+				return f.template operator()<algorithm_choice<algorithm_t::simple4>>();
+			case algorithm_t::simple5:
+				return f.template operator()<algorithm_choice<algorithm_t::simple5>>();
+			case algorithm_t::simple6:
+				return f.template operator()<algorithm_choice<algorithm_t::simple6>>();
+			case algorithm_t::simple7:
+				return f.template operator()<algorithm_choice<algorithm_t::simple7>>();
+			case algorithm_t::huffman:
+				return f.template operator()<algorithm_choice<algorithm_t::huffman>>();
+			case algorithm_t::simple:
+				return f.template operator()<algorithm_choice<algorithm_t::simple>>();
+			case algorithm_t::adaptive_huffman:
+				return f.template operator()<algorithm_choice<algorithm_t::adaptive_huffman>>();
+			case algorithm_t::tans:
+				return f.template operator()<algorithm_choice<algorithm_t::tans>>();
+			case algorithm_t::order1:
+				return f.template operator()<algorithm_choice<algorithm_t::order1>>();
+			case algorithm_t::lz77:
+				return f.template operator()<algorithm_choice<algorithm_t::lz77>>();
+			case algorithm_t::lz_fast:
+				return f.template operator()<algorithm_choice<algorithm_t::lz_fast>>();
+			case algorithm_t::bwt:
+				return f.template operator()<algorithm_choice<algorithm_t::bwt>>();
+			case algorithm_t::static_text:
+				return f.template operator()<algorithm_choice<algorithm_t::static_text>>();
+			case algorithm_t::static_json:
+				return f.template operator()<algorithm_choice<algorithm_t::static_json>>();
+			case algorithm_t::static_binary:
+				return f.template operator()<algorithm_choice<algorithm_t::static_binary>>();
+			case algorithm_t::automatic:
+				break;
+		}
+
+		// The automatic mode has no class of its own
+		assert(false);
+		return f.template operator()<algorithm_choice<algorithm_t::identity>>();
+	}
+
+	// Map filter types to classes
+	template <filter_t> struct filter_choice;
+	template <> struct filter_choice<filter_t::rle> { using filter = typename compression::rle; };
+	template <> struct filter_choice<filter_t::delta> { using filter = typename compression::delta; };
+	template <> struct filter_choice<filter_t::xor_delta> { using filter = typename compression::xor_delta; };
+
+	// Call a function template with the filter_choice for a filter type
+	template <typename F> auto with_filter(filter_t filter, F&& f)
+	{
+		switch (filter)
+		{
+			case filter_t::rle:
+				return f.template operator()<filter_choice<filter_t::rle>>();
+			case filter_t::delta:
+				return f.template operator()<filter_choice<filter_t::delta>>();
+			case filter_t::xor_delta:
+				return f.template operator()<filter_choice<filter_t::xor_delta>>();
+			case filter_t::none:
+				break;
+		}
+
+		// Without a filter the algorithm runs on its own
+		assert(false);
+		return f.template operator()<filter_choice<filter_t::rle>>();
+	}
+
+	// Number of bytes sampled for estimating output sizes in the automatic mode
+	constexpr std::size_t automatic_sample_size = 1 << 16;
+
+	// Choose the algorithm with the smallest estimated output, weighted by the speed preference
+	algorithm_t choose_algorithm(const bytes::stream& input, int speed)
+	{
+		auto freqs = compression::histogram::sample(input, automatic_sample_size);
+
+		auto best = algorithm_t::identity;
+		auto best_score = std::numeric_limits<double>::max();
+		for (auto candidate : registered_algorithms)
+		{
+			auto score = with_algorithm(candidate, [&]<typename choice>()
+			{
+				return static_cast<double>(choice::algorithm::estimate(freqs)) * (1.0 + speed * choice::cost / 10.0);
+			});
+
+			if (score < best_score)
+			{
+				best = candidate;
+				best_score = score;
+			}
+		}
+
+		return best;
+	}
+
+	// Run the automatic mode, where the first byte of the compressed data holds the chosen algorithm
+	bool run_automatic(mode_t mode, bytes::stream& input, bytes::stream& output, int speed, const compression::options& settings)
+	{
+		auto algorithm = algorithm_t::automatic;
+		if (mode == mode_t::decompress)
+		{
+			if (!input.at_end())
+				algorithm = static_cast<algorithm_t>(input.read());
+		}
+		else
+		{
+			algorithm = choose_algorithm(input, speed);
+			output.put(static_cast<bytes::stream::byte_t>(algorithm));
+		}
+
+		// Ensure that the algorithm is known (it may come from the input)
+		auto is_known = std::find(std::begin(registered_algorithms), std::end(registered_algorithms), algorithm) != std::end(registered_algorithms);
+		if (!is_known)
+			return false;
+
+		return with_algorithm(algorithm, [&]<typename choice>()
+		{
+			return run_algorithm<typename choice::algorithm>(mode, input, output, settings);
+		});
+	}
+
+	// Build a dictionary from the corpus with the codes of the algorithm, returning the contents of the dictionary file
+	bytes::stream::buffer_t train_dictionary(algorithm_t algorithm, bytes::stream::buffer_t&& corpus)
+	{
+		compression::histogram freqs { bytes::stream { std::move(corpus) } };
+		auto trained = [&]()
+		{
+			switch (algorithm)
+			{
+				case algorithm_t::simple2:
+					return compression::dictionary::train_simple(freqs, 2);
+				case algorithm_t::simple3:
+					return compression::dictionary::train_simple(freqs, 3);
+				case algorithm_t::simple4:
+					return compression::dictionary::train_simple(freqs, 4);
+				case algorithm_t::simple5:
+					return compression::dictionary::train_simple(freqs, 5);
+				case algorithm_t::simple6:
+					return compression::dictionary::train_simple(freqs, 6);
+				case algorithm_t::simple7:
+					return compression::dictionary::train_simple(freqs, 7);
+				case algorithm_t::simple:
+					return compression::dictionary::train_simple(freqs);
+				default:
+					assert(algorithm == algorithm_t::huffman);
+					return compression::dictionary::train_huffman(freqs);
+			}
+		}();
+
+		bytes::stream output {};
+		trained.save(output);
+		return output.release();
+	}
+
+	// Whether the train mode can build a dictionary with the codes of the algorithm
+	bool is_trainable(algorithm_t algorithm)
+	{
+		switch (algorithm)
+		{
+			case algorithm_t::simple2:
+			case algorithm_t::simple3:
+			case algorithm_t::simple4:
+			case algorithm_t::simple5:
+			case algorithm_t::simple6:
+			case algorithm_t::simple7:
+			case algorithm_t::simple:
+			case algorithm_t::huffman:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	// Read a dictionary file
+	std::optional<compression::dictionary> load_dictionary(const std::string& path)
+	{
+		std::ifstream file { path, std::ios::binary };
+		if (!file)
+			return {};
+
+		bytes::stream input { bytes::stream::buffer_t { std::istreambuf_iterator<char> { file }, std::istreambuf_iterator<char> {} } };
+		compression::dictionary result {};
+		if (!compression::dictionary::load(input, result))
+			return {};
+
+		return result;
+	}
+
+	// Parsing of a memory size, as a number of bytes with an optional suffix K, M or G
+	std::optional<std::size_t> memory_from_string(const std::string& memory)
+	{
+		// Up to 9 digits, so that the size cannot overflow
+		auto digits = std::min(memory.find_first_not_of("0123456789"), memory.size());
+		if (digits == 0 || digits > 9 || memory.size() > digits + 1)
+			return {};
+
+		std::size_t shift { 0 };
+		if (memory.size() > digits)
+		{
+			switch (memory[digits])
+			{
+				case 'K':
+					shift = 10;
+					break;
+				case 'M':
+					shift = 20;
+					break;
+				case 'G':
+					shift = 30;
+					break;
+				default:
+					return {};
+			}
+		}
+
+		return static_cast<std::size_t>(std::stoull(memory.substr(0, digits))) << shift;
+	}
 
 	// Parsing of algorithm type
 	auto algorithm_from_string(const std::string& algorithm)
@@ -51,12 +327,39 @@ namespace
 		algorithms["simple6"] = algorithm_t::simple6;
 		algorithms["simple7"] = algorithm_t::simple7;
 		algorithms["huffman"] = algorithm_t::huffman;
+		algorithms["simple"] = algorithm_t::simple;
+		algorithms["adaptive"] = algorithm_t::adaptive_huffman;
+		algorithms["tans"] = algorithm_t::tans;
+		algorithms["order1"] = algorithm_t::order1;
+		algorithms["lz77"] = algorithm_t::lz77;
+		algorithms["lz_fast"] = algorithm_t::lz_fast;
+		algorithms["bwt"] = algorithm_t::bwt;
+		algorithms["static_text"] = algorithm_t::static_text;
+		algorithms["static_json"] = algorithm_t::static_json;
+		algorithms["static_binary"] = algorithm_t::static_binary;
+		algorithms["auto"] = algorithm_t::automatic;
 
 		if (algorithms.contains(algorithm))
 			result = algorithms.at(algorithm);
 
 		return result;
 	}
+
+	// Parsing of filter type
+	auto filter_from_string(const std::string& filter)
+	{
+		std::optional<filter_t> result {};
+		std::unordered_map<std::string, filter_t> filters {};
+
+		filters["rle"] = filter_t::rle;
+		filters["delta"] = filter_t::delta;
+		filters["xor"] = filter_t::xor_delta;
+
+		if (filters.contains(filter))
+			result = filters.at(filter);
+
+		return result;
+	}
 }
 
 namespace utility
@@ -68,6 +371,18 @@ namespace utility
 	runsettings::runsettings() :
 		_mode(settings::mode::compress),
 		_algorithm(settings::algorithm::identity),
+		_filter(settings::filter::none),
+		_dedup(false),
+		_dictionary(),
+		_speed(0),
+		_threads(0),
+		_max_memory(0),
+		_serve_path(),
+		_connect_path(),
+		_arguments(),
+		_input_tree(),
+		_output_tree(),
+		_options(),
 		_valid(true)
 	{
 	}
@@ -83,9 +398,22 @@ namespace utility
 	runsettings::runsettings(int argc, const char** argv) :
 		_mode(settings::mode::compress),
 		_algorithm(settings::algorithm::identity),
+		_filter(settings::filter::none),
+		_dedup(false),
+		_dictionary(),
+		_speed(0),
+		_threads(0),
+		_max_memory(0),
+		_serve_path(),
+		_connect_path(),
+		_arguments(),
+		_input_tree(),
+		_output_tree(),
+		_options(),
 		_valid(false)
 	{
 		auto isValid = true;
+		std::string dictionary_path {};
 
 		for (int i = 1; i < argc; i++)
 		{
@@ -109,6 +437,10 @@ namespace utility
 				{
 					_mode = settings::mode::decompress;
 				}
+				else if (mode.compare("train") == 0)
+				{
+					_mode = settings::mode::train;
+				}
 				else
 				{
 					std::cerr << "Invalid mode \"" << mode << "\" specified for the '-m' option." << std::endl;
@@ -126,8 +458,32 @@ namespace utility
 					break;
 				}
 
+				// A filter may precede the algorithm, separated by a '+'
 				auto algorithm_str = std::string(argv[++i]);
+				auto separator = algorithm_str.find('+');
+				if (separator != std::string::npos)
+				{
+					auto filter_str = algorithm_str.substr(0, separator);
+					auto filter = filter_from_string(filter_str);
+					if (!filter.has_value())
+					{
+						std::cerr << "Invalid filter \"" << filter_str << "\" specified for the '-a' option." << std::endl;
+						isValid	 = false;
+						break;
+					}
+
+					_filter = filter.value();
+					algorithm_str = algorithm_str.substr(separator + 1);
+				}
+
 				auto algorithm = algorithm_from_string(algorithm_str);
+				if (algorithm == settings::algorithm::automatic && _filter != settings::filter::none)
+				{
+					std::cerr << "The automatic mode cannot follow a filter in the '-a' option." << std::endl;
+					isValid	 = false;
+					break;
+				}
+
 				if (algorithm.has_value())
 				{
 					_algorithm = algorithm.value();
@@ -139,6 +495,209 @@ namespace utility
 					break;
 				}
 			}
+			else if (value.compare("-s") == 0)	// Speed preference
+			{
+				// Require the speed preference to be specified
+				if(i+1 >= argc)
+				{
+					std::cerr << "Please supply a speed preference from 0 to 9 with the '-s' option." << std::endl;
+					isValid	 = false;
+					break;
+				}
+
+				auto speed = std::string(argv[++i]);
+				if (speed.size() == 1 && speed[0] >= '0' && speed[0] <= '9')
+				{
+					_speed = speed[0] - '0';
+				}
+				else
+				{
+					std::cerr << "Invalid speed preference \"" << speed << "\" specified for the '-s' option." << std::endl;
+					isValid	 = false;
+					break;
+				}
+			}
+			else if (value.compare("-l") == 0)	// Compression level
+			{
+				// Require the level to be specified
+				if(i+1 >= argc)
+				{
+					std::cerr << "Please supply a compression level from 1 to 9 with the '-l' option." << std::endl;
+					isValid	 = false;
+					break;
+				}
+
+				auto level = std::string(argv[++i]);
+				if (level.size() == 1 && level[0] >= '0' + compression::options::min_level && level[0] <= '0' + compression::options::max_level)
+				{
+					_options.level = level[0] - '0';
+				}
+				else
+				{
+					std::cerr << "Invalid compression level \"" << level << "\" specified for the '-l' option." << std::endl;
+					isValid	 = false;
+					break;
+				}
+			}
+			else if (value.compare("-t") == 0)	// Worker threads
+			{
+				// Require the number of threads to be specified
+				if(i+1 >= argc)
+				{
+					std::cerr << "Please supply a number of worker threads with the '-t' option." << std::endl;
+					isValid	 = false;
+					break;
+				}
+
+				auto threads = std::string(argv[++i]);
+				if (!threads.empty() && threads.size() <= 2 && std::all_of(threads.cbegin(), threads.cend(), [](char c) { return c >= '0' && c <= '9'; }) &&
+					std::stoul(threads) >= 1 && std::stoul(threads) <= parallel_runner::max_threads)
+				{
+					_threads = std::stoul(threads);
+				}
+				else
+				{
+					std::cerr << "Invalid number of worker threads \"" << threads << "\" specified for the '-t' option." << std::endl;
+					isValid	 = false;
+					break;
+				}
+			}
+			else if (value.compare("--max-memory") == 0)	// Memory limit, running on blocks of the input
+			{
+				// Require the size to be specified
+				if(i+1 >= argc)
+				{
+					std::cerr << "Please supply a memory size, e.g. \"256M\", with the '--max-memory' option." << std::endl;
+					isValid	 = false;
+					break;
+				}
+
+				auto memory_str = std::string(argv[++i]);
+				auto memory = memory_from_string(memory_str);
+				if (memory.has_value() && memory.value() >= parallel_runner::min_memory)
+				{
+					_max_memory = memory.value();
+				}
+				else
+				{
+					std::cerr << "Invalid memory size \"" << memory_str << "\" specified for the '--max-memory' option, which needs at least 1M." << std::endl;
+					isValid	 = false;
+					break;
+				}
+			}
+			else if (value.compare("--serve") == 0)	// Socket on which to serve requests
+			{
+				// Require the socket to be specified
+				if(i+1 >= argc)
+				{
+					std::cerr << "Please supply a socket path with the '--serve' option." << std::endl;
+					isValid	 = false;
+					break;
+				}
+
+				_serve_path = std::string(argv[++i]);
+			}
+			else if (value.compare("--connect") == 0)	// Socket of the server running the request
+			{
+				// Require the socket to be specified
+				if(i+1 >= argc)
+				{
+					std::cerr << "Please supply a socket path with the '--connect' option." << std::endl;
+					isValid	 = false;
+					break;
+				}
+
+				_connect_path = std::string(argv[++i]);
+			}
+			else if (value.compare("-r") == 0)	// Input directory
+			{
+				// Require the directory to be specified
+				if(i+1 >= argc)
+				{
+					std::cerr << "Please supply an input directory with the '-r' option." << std::endl;
+					isValid	 = false;
+					break;
+				}
+
+				_input_tree = std::string(argv[++i]);
+			}
+			else if (value.compare("-o") == 0)	// Output directory
+			{
+				// Require the directory to be specified
+				if(i+1 >= argc)
+				{
+					std::cerr << "Please supply an output directory with the '-o' option." << std::endl;
+					isValid	 = false;
+					break;
+				}
+
+				_output_tree = std::string(argv[++i]);
+			}
+			else if (value.compare("--dedup") == 0)	// Deduplication of repeated chunks
+			{
+				_dedup = true;
+			}
+			else if (value.compare("--dict") == 0)	// Dictionary file replacing the algorithm
+			{
+				// Require the file to be specified
+				if(i+1 >= argc)
+				{
+					std::cerr << "Please supply a dictionary file with the '--dict' option." << std::endl;
+					isValid	 = false;
+					break;
+				}
+
+				dictionary_path = std::string(argv[++i]);
+			}
+			else if (value.compare("--width") == 0)	// Element width of the stride filters
+			{
+				// Require the width to be specified
+				if(i+1 >= argc)
+				{
+					std::cerr << "Please supply an element width of 1, 2, 4 or 8 bytes with the '--width' option." << std::endl;
+					isValid	 = false;
+					break;
+				}
+
+				auto width = std::string(argv[++i]);
+				if (width == "1" || width == "2" || width == "4" || width == "8")
+				{
+					_options.element_width = static_cast<std::size_t>(width[0] - '0');
+				}
+				else
+				{
+					std::cerr << "Invalid element width \"" << width << "\" specified for the '--width' option." << std::endl;
+					isValid	 = false;
+					break;
+				}
+			}
+			else if (value.compare("--stride") == 0)	// Stride of the stride filters
+			{
+				// Require the stride to be specified
+				if(i+1 >= argc)
+				{
+					std::cerr << "Please supply a stride in bytes, or \"auto\", with the '--stride' option." << std::endl;
+					isValid	 = false;
+					break;
+				}
+
+				auto stride = std::string(argv[++i]);
+				if (stride == "auto")
+				{
+					_options.detect_stride = true;
+				}
+				else if (!stride.empty() && stride.size() <= 4 && std::all_of(stride.cbegin(), stride.cend(), [](char c) { return c >= '0' && c <= '9'; }))
+				{
+					_options.stride = std::stoul(stride);
+					_options.detect_stride = false;
+				}
+				else
+				{
+					std::cerr << "Invalid stride \"" << stride << "\" specified for the '--stride' option." << std::endl;
+					isValid	 = false;
+					break;
+				}
+			}
 			else
 			{
 				isValid	 = false;
@@ -146,6 +705,88 @@ namespace utility
 			}
 		}
 
+		// A server runs the request with every argument but the server socket
+		for (int i = 1; i < argc; i++)
+		{
+			if (std::string(argv[i]).compare("--connect") == 0)
+				i++;
+			else
+				_arguments.emplace_back(argv[i]);
+		}
+
+		// A server takes its requests from clients, and a client has the server run the whole input
+		if (isValid && !_serve_path.empty() && !_connect_path.empty())
+		{
+			std::cerr << "The '--serve' and '--connect' options cannot be combined." << std::endl;
+			isValid	 = false;
+		}
+
+		if (isValid && !_connect_path.empty() && (_threads > 0 || _max_memory > 0))
+		{
+			std::cerr << "The '--connect' option cannot be combined with the '-t' or '--max-memory' options." << std::endl;
+			isValid	 = false;
+		}
+
+		// Every file of the input directory is written to the output directory, in blocks
+		if (isValid && (_input_tree.empty() != _output_tree.empty()))
+		{
+			std::cerr << "The '-r' and '-o' options must be given together." << std::endl;
+			isValid	 = false;
+		}
+
+		if (isValid && !_input_tree.empty() && (_mode == settings::mode::train || !_serve_path.empty() || !_connect_path.empty()))
+		{
+			std::cerr << "The '-r' option cannot be combined with the train mode, '--serve' or '--connect'." << std::endl;
+			isValid	 = false;
+		}
+
+		// The automatic mode records its choice in the first byte, which deduplication would move
+		if (isValid && _dedup && _algorithm == settings::algorithm::automatic)
+		{
+			std::cerr << "The automatic mode cannot be combined with the '--dedup' option." << std::endl;
+			isValid	 = false;
+		}
+
+		// The stride must hold whole elements
+		if (isValid && (_options.stride % _options.element_width != 0 || _options.stride / _options.element_width > compression::stride_filter::max_stride))
+		{
+			std::cerr << "The stride must be a multiple of the element width, of at most " << compression::stride_filter::max_stride << " elements." << std::endl;
+			isValid	 = false;
+		}
+
+		// The train mode writes a dictionary built with the codes of the algorithm, which must have a code table
+		if (isValid && _mode == settings::mode::train && (!is_trainable(_algorithm) || _filter != settings::filter::none || _dedup || !dictionary_path.empty()))
+		{
+			std::cerr << "The train mode needs one of the algorithms 'huffman', 'simple' or 'simple2' to 'simple7', without filters, '--dedup' or '--dict'." << std::endl;
+			isValid	 = false;
+		}
+
+		// The dictionary is built from the whole corpus at once
+		if (isValid && _mode == settings::mode::train && (_threads > 0 || _max_memory > 0))
+		{
+			std::cerr << "The train mode cannot be combined with the '-t' or '--max-memory' options." << std::endl;
+			isValid	 = false;
+		}
+
+		// A dictionary replaces the algorithm, so only its codes are used
+		if (isValid && !dictionary_path.empty())
+		{
+			if (_algorithm == settings::algorithm::automatic || _filter != settings::filter::none || _dedup)
+			{
+				std::cerr << "The '--dict' option cannot be combined with '-a auto', filters or '--dedup'." << std::endl;
+				isValid	 = false;
+			}
+			else
+			{
+				_dictionary = load_dictionary(dictionary_path);
+				if (!_dictionary.has_value())
+				{
+					std::cerr << "Could not load the dictionary \"" << dictionary_path << "\"." << std::endl;
+					isValid	 = false;
+				}
+			}
+		}
+
 		_valid = isValid;
 	}
 
@@ -153,26 +794,73 @@ namespace utility
 	// Public interface
 	// ----------------------------------------------------------------------
 	// Run an algorithm
-	bytes::stream::buffer_t runsettings::run(bytes::stream::buffer_t&& input)
-	{
-		switch (_algorithm)
-		{
-			case settings::algorithm::identity:
-				return run_algorithm<compression::identity>(_mode, std::move(input));
-			case settings::algorithm::simple2:
-				return run_algorithm<compression::simple2>(_mode, std::move(input));
-			case settings::algorithm::simple3:
-				return run_algorithm<compression::simple3>(_mode, std::move(input));
-			case settings::algorithm::simple4:
-				return run_algorithm<compression::simple4>(_mode, std::move(input));
-			case settings::algorithm::simple5:
-				return run_algorithm<compression::simple5>(_mode, std::move(input));
-			case settings::algorithm::simple6:
-				return run_algorithm<compression::simple6>(_mode, std::move(input));
-			case settings::algorithm::simple7:
-				return run_algorithm<compression::simple7>(_mode, std::move(input));
-			case settings::algorithm::huffman:
-				return run_algorithm<compression::huffman>(_mode, std::move(input));
+	bool runsettings::run(bytes::stream::buffer_t&& input, bytes::stream::buffer_t& output) const
+	{
+		if (_mode == settings::mode::train)
+		{
+			output = train_dictionary(_algorithm, std::move(input));
+			return true;
 		}
+
+		bytes::stream in { std::move(input) };
+		bytes::stream out {};
+		auto is_success = run(in, out);
+		output = out.release();
+		return is_success;
+	}
+
+	// Run an algorithm on a stream, appending to the output
+	bool runsettings::run(bytes::stream& input, bytes::stream& output) const
+	{
+		assert(_mode != settings::mode::train);
+		if (_dictionary.has_value())
+			return _mode == settings::mode::decompress ? _dictionary->decompress(input, output) : _dictionary->compress(input, output);
+
+		if (_algorithm == settings::algorithm::automatic)
+			return run_automatic(_mode, input, output, _speed, _options);
+
+		// Deduplication runs in front of the filter and algorithm
+		auto run_with = [&]<typename T>()
+		{
+			if (_dedup)
+				return run_algorithm<compression::dedup<T>>(_mode, input, output, _options);
+
+			return run_algorithm<T>(_mode, input, output, _options);
+		};
+
+		if (_filter != settings::filter::none)
+		{
+			return with_filter(_filter, [&]<typename filter_choice>()
+			{
+				return with_algorithm(_algorithm, [&]<typename choice>()
+				{
+					return run_with.template operator()<compression::pipeline<typename filter_choice::filter, typename choice::algorithm>>();
+				});
+			});
+		}
+
+		return with_algorithm(_algorithm, [&]<typename choice>()
+		{
+			return run_with.template operator()<typename choice::algorithm>();
+		});
+	}
+
+	// Run an algorithm on its own, without filters, deduplication or a dictionary
+	bool runsettings::run(settings::mode mode, settings::algorithm algorithm, bytes::stream& input, bytes::stream& output, const compression::options& options)
+	{
+		assert(mode != settings::mode::train);
+		if (algorithm == settings::algorithm::automatic)
+			return run_automatic(mode, input, output, 0, options);
+
+		return with_algorithm(algorithm, [&]<typename choice>()
+		{
+			return run_algorithm<typename choice::algorithm>(mode, input, output, options);
+		});
+	}
+
+	// Choose an algorithm in the same way as the automatic mode
+	auto runsettings::choose(const bytes::stream::buffer_t& input) const -> settings::algorithm
+	{
+		return choose_algorithm(bytes::stream { input }, _speed);
 	}
 }
@@ -0,0 +1,340 @@
+/////////////////////////////////////////////////////////////////////////
+// Server implementation
+/////////////////////////////////////////////////////////////////////////
+#include <utility/server.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <unordered_map>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <utility/runsettings.h>
+
+namespace
+{
+	using buffer_t = bytes::stream::buffer_t;
+	using status_t = utility::server::status;
+
+	// Run settings of a worker by their arguments, where the arguments are joined by null characters
+	using settings_cache = std::unordered_map<std::string, std::unique_ptr<utility::runsettings>>;
+	constexpr std::size_t max_cached_settings = 16;
+
+	// Bytes of a buffer read at a time, so that the buffer grows with the bytes that arrive rather than the announced size
+	constexpr std::size_t read_chunk_size = std::size_t { 1 } << 16;
+
+	// Read exactly count bytes, which fails once the connection is closed
+	bool read_all(int connection, void* data, std::size_t count)
+	{
+		auto bytes = static_cast<char*>(data);
+		while (count > 0)
+		{
+			auto result = ::recv(connection, bytes, count, 0);
+			if (result < 0 && errno == EINTR)
+				continue;
+
+			if (result <= 0)
+				return false;
+
+			bytes += result;
+			count -= static_cast<std::size_t>(result);
+		}
+
+		return true;
+	}
+
+	// Write exactly count bytes, which fails once the connection is closed
+	bool write_all(int connection, const void* data, std::size_t count)
+	{
+		auto bytes = static_cast<const char*>(data);
+		while (count > 0)
+		{
+			auto result = ::send(connection, bytes, count, MSG_NOSIGNAL);
+			if (result < 0 && errno == EINTR)
+				continue;
+
+			if (result <= 0)
+				return false;
+
+			bytes += result;
+			count -= static_cast<std::size_t>(result);
+		}
+
+		return true;
+	}
+
+	// Read count bytes into the buffer, a chunk at a time
+	bool read_buffer(int connection, buffer_t& buffer, std::size_t count)
+	{
+		buffer.clear();
+		while (buffer.size() < count)
+		{
+			auto offset = buffer.size();
+			buffer.resize(offset + std::min(count - offset, read_chunk_size));
+			if (!read_all(connection, buffer.data() + offset, buffer.size() - offset))
+				return false;
+		}
+
+		return true;
+	}
+
+	// Numbers of the given number of bytes, little-endian
+	bool read_number(int connection, std::uint64_t& value, std::size_t size)
+	{
+		std::array<unsigned char, 8> bytes {};
+		if (!read_all(connection, bytes.data(), size))
+			return false;
+
+		value = 0;
+		for (std::size_t i = 0; i < size; i++)
+			value |= static_cast<std::uint64_t>(bytes[i]) << (8 * i);
+
+		return true;
+	}
+
+	bool write_number(int connection, std::uint64_t value, std::size_t size)
+	{
+		std::array<unsigned char, 8> bytes {};
+		for (std::size_t i = 0; i < size; i++)
+			bytes[i] = static_cast<unsigned char>(value >> (8 * i));
+
+		return write_all(connection, bytes.data(), size);
+	}
+
+	// Address of the socket, which fails for paths that do not fit
+	bool make_address(const std::string& path, sockaddr_un& address)
+	{
+		address = {};
+		address.sun_family = AF_UNIX;
+		if (path.empty() || path.size() >= sizeof(address.sun_path))
+			return false;
+
+		std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+		return true;
+	}
+
+	// Run a request with the settings for its arguments, where the settings are parsed once per worker
+	status_t run_request(settings_cache& cache, const std::vector<std::string>& arguments, buffer_t&& input, buffer_t& output)
+	{
+		std::string key {};
+		for (const auto& argument : arguments)
+			key.append(argument).push_back('\0');
+
+		auto cached = cache.find(key);
+		if (cached == cache.end())
+		{
+			if (cache.size() >= max_cached_settings)
+				cache.clear();
+
+			std::vector<const char*> argv { "p3run" };
+			for (const auto& argument : arguments)
+				argv.push_back(argument.c_str());
+
+			cached = cache.emplace(key, std::make_unique<utility::runsettings>(static_cast<int>(argv.size()), argv.data())).first;
+		}
+
+		// The request runs on the whole input, without the options of the server or of blocks
+		const auto& settings = *cached->second;
+		if (!settings.valid() || !settings.serve_path().empty() || !settings.connect_path().empty() || settings.threads() > 0 || settings.max_memory() > 0)
+			return status_t::invalid_arguments;
+
+		return settings.run(std::move(input), output) ? status_t::success : status_t::failed;
+	}
+
+	// Write the status of a request and its output
+	bool write_response(int connection, status_t result, const buffer_t& output)
+	{
+		return write_number(connection, static_cast<std::uint64_t>(result), 1) &&
+			write_number(connection, output.size(), 8) &&
+			write_all(connection, output.data(), output.size());
+	}
+
+	// Read a request and write its response, which fails once the connection is closed. A request that
+	// runs out of memory fails, where the connection is closed if the rest of its input is not read.
+	bool respond(int connection, settings_cache& cache, std::size_t max_input_size)
+	{
+		std::uint64_t count { 0 };
+		if (!read_number(connection, count, 4) || count > utility::server::max_arguments)
+			return false;
+
+		std::vector<std::string> arguments(count);
+		for (auto& argument : arguments)
+		{
+			std::uint64_t size { 0 };
+			if (!read_number(connection, size, 4) || size > utility::server::max_argument_size)
+				return false;
+
+			argument.resize(size);
+			if (!read_all(connection, argument.data(), size))
+				return false;
+		}
+
+		std::uint64_t size { 0 };
+		if (!read_number(connection, size, 8) || size > max_input_size)
+			return false;
+
+		buffer_t input {};
+		try
+		{
+			if (!read_buffer(connection, input, size))
+				return false;
+		}
+		catch (const std::bad_alloc&)
+		{
+			write_response(connection, status_t::failed, buffer_t {});
+			return false;
+		}
+
+		buffer_t output {};
+		auto result = status_t::failed;
+		try
+		{
+			result = run_request(cache, arguments, std::move(input), output);
+		}
+		catch (const std::bad_alloc&)
+		{
+			buffer_t {}.swap(output);
+			result = status_t::failed;
+		}
+
+		return write_response(connection, result, output);
+	}
+}
+
+// ----------------------------------------------------------------------
+// Constructor / destructor
+// ----------------------------------------------------------------------
+utility::server::server(const std::string& path, std::size_t threads, std::size_t max_input_size) :
+	_path(path),
+	_max_input_size(max_input_size),
+	_socket(-1),
+	_is_stopping(false),
+	_connections(std::make_unique<std::atomic<int>[]>(threads)),
+	_workers()
+{
+	assert(threads > 0);
+	sockaddr_un address {};
+	if (!make_address(path, address))
+		return;
+
+	// Replace the socket of an earlier server, but no other kind of file
+	struct stat file {};
+	if (::stat(path.c_str(), &file) == 0 && S_ISSOCK(file.st_mode))
+		::unlink(path.c_str());
+
+	_socket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (_socket < 0)
+		return;
+
+	if (::bind(_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || ::listen(_socket, SOMAXCONN) != 0)
+	{
+		::close(_socket);
+		_socket = -1;
+		return;
+	}
+
+	for (std::size_t i = 0; i < threads; i++)
+	{
+		_connections[i] = -1;
+		_workers.emplace_back([this, i]() { serve(i); });
+	}
+}
+
+utility::server::~server()
+{
+	stop();
+}
+
+// ----------------------------------------------------------------------
+// Workers
+// ----------------------------------------------------------------------
+void utility::server::stop()
+{
+	if (_socket < 0 || _is_stopping.exchange(true))
+		return;
+
+	// Wake the workers waiting for a connection or for the next request
+	::shutdown(_socket, SHUT_RDWR);
+	for (std::size_t i = 0; i < _workers.size(); i++)
+	{
+		auto connection = _connections[i].load();
+		if (connection >= 0)
+			::shutdown(connection, SHUT_RDWR);
+	}
+
+	wait();
+	::close(_socket);
+	::unlink(_path.c_str());
+}
+
+void utility::server::wait()
+{
+	for (auto& worker : _workers)
+		if (worker.joinable())
+			worker.join();
+}
+
+// Accept connections and run their requests until the server is stopped
+void utility::server::serve(std::size_t worker)
+{
+	settings_cache cache {};
+	while (!_is_stopping)
+	{
+		auto connection = ::accept4(_socket, nullptr, nullptr, SOCK_CLOEXEC);
+		if (connection < 0)
+		{
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+
+			break;
+		}
+
+		_connections[worker] = connection;
+		while (!_is_stopping && respond(connection, cache, _max_input_size))
+			;
+
+		_connections[worker] = -1;
+		::close(connection);
+	}
+}
+
+// ----------------------------------------------------------------------
+// Client
+// ----------------------------------------------------------------------
+bool utility::server::request(const std::string& path, const std::vector<std::string>& arguments, const buffer_t& input, buffer_t& output)
+{
+	sockaddr_un address {};
+	if (!make_address(path, address) || arguments.size() > max_arguments)
+		return false;
+
+	auto connection = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (connection < 0)
+		return false;
+
+	auto is_success = ::connect(connection, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0 &&
+		write_number(connection, arguments.size(), 4);
+
+	for (const auto& argument : arguments)
+	{
+		is_success = is_success && argument.size() <= max_argument_size &&
+			write_number(connection, argument.size(), 4) &&
+			write_all(connection, argument.data(), argument.size());
+	}
+
+	is_success = is_success && write_number(connection, input.size(), 8) && write_all(connection, input.data(), input.size());
+
+	std::uint64_t result { 0 };
+	std::uint64_t size { 0 };
+	is_success = is_success && read_number(connection, result, 1) && read_number(connection, size, 8) && size <= max_output_size &&
+		read_buffer(connection, output, size) && result == static_cast<std::uint64_t>(status::success);
+
+	::close(connection);
+	return is_success;
+}
@@ -0,0 +1,131 @@
+/////////////////////////////////////////////////////////////////////////
+// Compressing stream buffers implementation
+/////////////////////////////////////////////////////////////////////////
+#include <utility/streambuf.h>
+
+#include <cassert>
+
+#include <utility/block_frame.h>
+
+namespace utility
+{
+	// ----------------------------------------------------------------------
+	// Compressing output buffer
+	// ----------------------------------------------------------------------
+	// Constructor
+	compressing_ostreambuf::compressing_ostreambuf(std::ostream& output, algorithm_t algorithm, const compression::options& settings, std::size_t block_size) :
+		_output(output),
+		_algorithm(algorithm),
+		_settings(settings),
+		_block(block_size),
+		_compressed()
+	{
+		assert(block_size > 0 && block_size <= block_frame::max_block_size);
+		setp(_block.data(), _block.data() + _block.size());
+	}
+
+	// Destructor
+	compressing_ostreambuf::~compressing_ostreambuf()
+	{
+		sync();
+	}
+
+	auto compressing_ostreambuf::overflow(int_type c) -> int_type
+	{
+		if (!put_block())
+			return traits_type::eof();
+
+		if (!traits_type::eq_int_type(c, traits_type::eof()))
+		{
+			*pptr() = traits_type::to_char_type(c);
+			pbump(1);
+		}
+
+		return traits_type::not_eof(c);
+	}
+
+	int compressing_ostreambuf::sync()
+	{
+		if (!put_block())
+			return -1;
+
+		_output.flush();
+		return _output ? 0 : -1;
+	}
+
+	// Compress the bytes written since the last block
+	bool compressing_ostreambuf::put_block()
+	{
+		auto count = static_cast<std::size_t>(pptr() - pbase());
+		if (count == 0)
+			return true;
+
+		bytes::stream input { bytes::stream::buffer_t { pbase(), pptr() } };
+		_compressed.clear();
+		if (!runsettings::run(runsettings::settings::mode::compress, _algorithm, input, _compressed, _settings))
+			return false;
+
+		block_frame { count, _compressed.buffer().size() }.write(_output);
+		_output.write(reinterpret_cast<const char*>(_compressed.buffer().data()), _compressed.buffer().size());
+
+		setp(_block.data(), _block.data() + _block.size());
+		return static_cast<bool>(_output);
+	}
+
+	// ----------------------------------------------------------------------
+	// Decompressing input buffer
+	// ----------------------------------------------------------------------
+	// Constructor
+	decompressing_istreambuf::decompressing_istreambuf(std::istream& input, algorithm_t algorithm) :
+		_input(input),
+		_algorithm(algorithm),
+		_block(),
+		_valid(true)
+	{
+		setg(nullptr, nullptr, nullptr);
+	}
+
+	// Destructor
+	decompressing_istreambuf::~decompressing_istreambuf()
+	{
+	}
+
+	auto decompressing_istreambuf::underflow() -> int_type
+	{
+		if (gptr() == egptr() && !get_block())
+			return traits_type::eof();
+
+		return traits_type::to_int_type(*gptr());
+	}
+
+	// Read and decompress the next block, which fails at the end of the input
+	bool decompressing_istreambuf::get_block()
+	{
+		if (!_valid)
+			return false;
+
+		// The end of the input is only valid between frames
+		block_frame frame {};
+		auto is_end = false;
+		if (!frame.read(_input, is_end))
+		{
+			_valid = is_end;
+			return false;
+		}
+
+		bytes::stream::buffer_t compressed(frame.size);
+		_input.read(reinterpret_cast<char*>(compressed.data()), static_cast<std::streamsize>(frame.size));
+		_valid = _input.gcount() == static_cast<std::streamsize>(frame.size);
+
+		bytes::stream input { std::move(compressed) };
+		_block.clear();
+		_valid = _valid && runsettings::run(runsettings::settings::mode::decompress, _algorithm, input, _block) && _block.buffer().size() == frame.count;
+		if (!_valid)
+			return false;
+
+		// The get area is only read from, as putting back characters does not write to it
+		auto data = reinterpret_cast<char*>(const_cast<bytes::stream::byte_t*>(_block.buffer().data()));
+		setg(data, data, data + frame.count);
+		return true;
+	}
+}
@@ -8,39 +8,39 @@
 TEST(bytes_dynamic_bitset, adding_bits)
 {
 	bytes::dynamic_bitset bitset {};
-	EXPECT_EQ(bitset.bits.size(), 0);
+	EXPECT_EQ(bitset.size(), 0);
 	EXPECT_EQ(bitset.to_uint(), 0);
 
 	bitset.add(std::bitset<1>(0));
-	EXPECT_EQ(bitset.bits.size(), 1);
+	EXPECT_EQ(bitset.size(), 1);
 	EXPECT_EQ(bitset.to_uint(), 0);
 
 	bitset.add(std::bitset<1>(1));
-	EXPECT_EQ(bitset.bits.size(), 2);
+	EXPECT_EQ(bitset.size(), 2);
 	EXPECT_EQ(bitset.to_uint(), 1);
 
 	bitset.add(std::bitset<1>(1));
-	EXPECT_EQ(bitset.bits.size(), 3);
+	EXPECT_EQ(bitset.size(), 3);
 	EXPECT_EQ(bitset.to_uint(), 3);
 
 	bitset.add(std::bitset<4>(0b1011));
-	EXPECT_EQ(bitset.bits.size(), 7);
+	EXPECT_EQ(bitset.size(), 7);
 	EXPECT_EQ(bitset.to_uint(), 0b0111011);
 
 	bytes::dynamic_bitset bitset2 {};
 	bitset2.add(std::bitset<3>(0b010));
-	EXPECT_EQ(bitset2.bits.size(), 3);
+	EXPECT_EQ(bitset2.size(), 3);
 	EXPECT_EQ(bitset2.to_uint(), 0b010);
 
 	bitset.add(bitset2);
-	EXPECT_EQ(bitset.bits.size(), 10);
+	EXPECT_EQ(bitset.size(), 10);
 	EXPECT_EQ(bitset.to_uint(), 0b0111011010);
 }
 
 TEST(bytes_dynamic_bitset, construct_from_bitset)
 {
 	bytes::dynamic_bitset bitset { std::bitset<10>(0b0011001011) };
-	EXPECT_EQ(bitset.bits.size(), 10);
+	EXPECT_EQ(bitset.size(), 10);
 	EXPECT_EQ(bitset.to_uint(), 0b0011001011);
 }
 
@@ -48,7 +48,7 @@ TEST(bytes_dynamic_bitset, construct_from_vector)
 {
 	std::vector<bool> v { true, true, false, true };
 	bytes::dynamic_bitset bitset { v };
-	EXPECT_EQ(bitset.bits.size(), 4);
+	EXPECT_EQ(bitset.size(), 4);
 	EXPECT_EQ(bitset.to_uint(), 0b1101);
 }
 
@@ -61,3 +61,39 @@ TEST(bytes_dynamic_bitset, hash)
 	EXPECT_EQ(bitset2.hash(), bitset2.hash());
 	EXPECT_NE(bitset.hash(), bitset2.hash());
 }
+
+TEST(bytes_dynamic_bitset, adding_bits_across_words)
+{
+	bytes::dynamic_bitset bitset {};
+	bitset.add(std::bitset<60>(0));
+	bitset.add(std::bitset<8>(0b10110011));
+	EXPECT_EQ(bitset.size(), 68);
+	EXPECT_EQ(bitset.word_count(), 2);
+	EXPECT_EQ(bitset.to_uint(), 0b10110011);
+	EXPECT_TRUE(bitset.test(60));
+	EXPECT_FALSE(bitset.test(61));
+	EXPECT_TRUE(bitset.test(67));
+
+	bytes::dynamic_bitset bitset2 { std::bitset<100>(1) };
+	EXPECT_EQ(bitset2.size(), 100);
+	EXPECT_EQ(bitset2.to_uint(), 1);
+
+	bitset2.add(bitset);
+	EXPECT_EQ(bitset2.size(), 168);
+	EXPECT_EQ(bitset2.word_count(), 3);
+	EXPECT_EQ(bitset2.to_uint(), 0b10110011);
+	EXPECT_TRUE(bitset2.test(99));
+}
+
+TEST(bytes_dynamic_bitset, copy_and_move)
+{
+	bytes::dynamic_bitset bitset { std::bitset<70>(0b1011) };
+	bytes::dynamic_bitset copy { bitset };
+	EXPECT_EQ(copy.size(), 70);
+	EXPECT_EQ(copy.hash(), bitset.hash());
+
+	bytes::dynamic_bitset moved { std::move(bitset) };
+	EXPECT_EQ(moved.size(), 70);
+	EXPECT_EQ(moved.to_uint(), 0b1011);
+	EXPECT_EQ(moved.hash(), copy.hash());
+}
@@ -4,6 +4,7 @@
 #include <gtest/gtest.h>
 
 #include <bytes/stream.h>
+#include <bytes/dynamic_bitset.h>
 
 TEST(bytes_stream, put_bytes)
 {
@@ -68,6 +69,22 @@ TEST(bytes_stream, put_bits_and_bytes)
 	EXPECT_EQ(stream.buffer()[8], 0xFF);
 }
 
+TEST(bytes_stream, put_dynamic_bits)
+{
+	bytes::stream stream;
+	bytes::dynamic_bitset bitset { std::bitset<4>(0b0101) };
+	bitset.add(std::bitset<64>(0xEFBEADDEEFBEADDEull));
+
+	stream.put_bits(std::bitset<4>(0x2));
+	stream.put_bits(bitset);
+
+	EXPECT_EQ(stream.buffer().size(), 9);
+	EXPECT_EQ(stream.buffer()[0], 0xA2);
+	EXPECT_EQ(stream.buffer()[1], 0xF7);
+	EXPECT_EQ(stream.buffer()[8], 0x7B);
+	EXPECT_EQ(stream.bitindex(), 0);
+}
+
 TEST(bytes_stream, read_and_peek)
 {
 	bytes::stream::buffer_t buffer { 0xDE, 0xAD, 0xBE, 0xEF };
@@ -137,3 +154,104 @@ TEST(bytes_stream, seek_and_read_bits)
 	EXPECT_FALSE(stream.at_end());
 	EXPECT_EQ(stream.peek_bits<32>().to_ulong(), 0xDEADBEEF);
 }
+
+TEST(bytes_stream, put_and_read_words)
+{
+	bytes::stream stream;
+
+	stream.put_bits(std::bitset<3>(0x5));
+	stream.put_size(0);
+	stream.put_size(123456789);
+	stream.put_word(0xDEADBEEF, 32);
+	stream.put_word(0xFFFF, 4);
+
+	stream.seek(0);
+	EXPECT_EQ(stream.read_word(3), 0x5);
+	std::size_t first { 1 };
+	std::size_t second { 0 };
+	EXPECT_TRUE(stream.read_size(first));
+	EXPECT_TRUE(stream.read_size(second));
+	EXPECT_EQ(first, 0);
+	EXPECT_EQ(second, 123456789);
+	EXPECT_EQ(stream.peek_word() & 0xFFFFFFFF, 0xDEADBEEF);
+	stream.skip_bits(16);
+	EXPECT_EQ(stream.read_word(16), 0xDEAD);
+	EXPECT_EQ(stream.read_word(4), 0xF);
+	EXPECT_EQ(stream.bits_remaining(), 2);	// Padding of the final byte
+}
+
+TEST(bytes_stream, read_size_beyond_end)
+{
+	bytes::stream stream;
+	stream.put_size(123456789);
+
+	// Drop the final byte of the size, and the width alone
+	auto buffer = stream.buffer();
+	buffer.pop_back();
+	bytes::stream truncated { std::move(buffer) };
+	bytes::stream width_only { bytes::stream::buffer_t { 0x3F } };
+
+	std::size_t size { 0 };
+	EXPECT_FALSE(truncated.read_size(size));
+	EXPECT_FALSE(width_only.read_size(size));
+}
+
+TEST(bytes_stream, put_bytes_aligned)
+{
+	bytes::stream stream;
+	const bytes::stream::byte_t data[] { 0xDE, 0xAD, 0xBE, 0xEF };
+
+	stream.put_bits(std::bitset<3>(0x5));
+	stream.align();
+	stream.put_bytes(data, 4);
+	stream.align();
+	stream.put(0x42);
+
+	EXPECT_EQ(stream.buffer().size(), 6);
+	EXPECT_EQ(stream.buffer()[0], 0x05);
+	EXPECT_EQ(stream.buffer()[1], 0xDE);
+	EXPECT_EQ(stream.buffer()[4], 0xEF);
+	EXPECT_EQ(stream.buffer()[5], 0x42);
+}
+
+TEST(bytes_stream, put_repeat_overlapping)
+{
+	bytes::stream stream;
+	stream.put(0x01);
+	stream.put(0x02);
+	stream.put(0x03);
+
+	stream.allocate(10);
+	stream.put_repeat(2, 7);
+	stream.put_repeat(9, 3);
+
+	const bytes::stream::buffer_t expected { 0x01, 0x02, 0x03, 0x02, 0x03, 0x02, 0x03, 0x02, 0x03, 0x02, 0x02, 0x03, 0x02 };
+	EXPECT_EQ(stream.buffer(), expected);
+}
+
+TEST(bytes_stream, clear)
+{
+	bytes::stream stream;
+	stream.put(0x01);
+	stream.put_word(0x5, 3);
+
+	stream.clear();
+	stream.put(0x02);
+
+	const bytes::stream::buffer_t expected { 0x02 };
+	EXPECT_EQ(stream.buffer(), expected);
+	EXPECT_EQ(stream.bitindex(), 0);
+}
+
+TEST(bytes_stream, release)
+{
+	bytes::stream stream { bytes::stream::buffer_t { 0x01, 0x02 } };
+	stream.read();
+
+	auto buffer = stream.release();
+
+	const bytes::stream::buffer_t expected { 0x01, 0x02 };
+	EXPECT_EQ(buffer, expected);
+	EXPECT_TRUE(stream.buffer().empty());
+	EXPECT_EQ(stream.index(), 0);
+}
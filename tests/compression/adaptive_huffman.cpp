@@ -0,0 +1,126 @@
+///////////////////////////////////////////////////////////////////////
+// Tests of the adaptive Huffman algorithm
+///////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <compression/compression.h>
+#include <compression/adaptive_huffman.h>
+#include <compression/histogram.h>
+
+TEST(algorithm_adaptive_huffman, compress_decompress_text)
+{
+	// Arrange
+	const std::string input = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+
+	// Act
+	auto compressed = compress<compression::adaptive_huffman>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<compression::adaptive_huffman>(std::move(compressed));
+
+	// Assert
+	bytes::stream::buffer_t expected { input.cbegin(), input.cend() };
+	EXPECT_EQ(decompressed, expected);
+}
+
+TEST(algorithm_adaptive_huffman, compress_decompress_full_range)
+{
+	// Arrange
+	std::vector<bytes::stream::byte_t> input {};
+	for (auto i = 0; i <= 255; i++)
+		input.push_back(static_cast<bytes::stream::byte_t>(i));
+
+	// Act
+	auto compressed = compress<compression::adaptive_huffman>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<compression::adaptive_huffman>(std::move(compressed));
+
+	// Assert
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_adaptive_huffman, compress_decompress_empty_range)
+{
+	// Arrange
+	std::vector<bytes::stream::byte_t> input {};
+
+	// Act
+	auto compressed = compress<compression::adaptive_huffman>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<compression::adaptive_huffman>(std::move(compressed));
+
+	// Assert
+	EXPECT_EQ(decompressed.size(), 0);
+}
+
+TEST(algorithm_adaptive_huffman, long_skewed_input)
+{
+	// Arrange - a changing distribution over many rebuilds, including every byte value
+	std::vector<bytes::stream::byte_t> input {};
+	for (std::size_t i = 0; i < 300000; i++)
+		input.push_back(static_cast<bytes::stream::byte_t>(i < 150000 ? (i * i) % 7 : 255 - (i * i) % 5));
+	for (auto i = 0; i <= 255; i++)
+		input.push_back(static_cast<bytes::stream::byte_t>(i));
+
+	// Act
+	auto compressed = compress<compression::adaptive_huffman>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::adaptive_huffman>(std::move(compressed));
+
+	// Assert
+	EXPECT_LT(compressed_size, input.size() / 2);
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_adaptive_huffman, decompress_truncated)
+{
+	// Arrange
+	const std::string text = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+	auto compressed = compress<compression::adaptive_huffman>(bytes::stream::buffer_t { text.cbegin(), text.cend() });
+	compressed.resize(compressed.size() / 2);
+
+	bytes::stream input { std::move(compressed) };
+	bytes::stream output {};
+
+	// Act
+	auto is_success = compression::adaptive_huffman::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
+
+TEST(algorithm_adaptive_huffman, compress_incompressible)
+{
+	// Arrange - pseudo-random bytes, which the codes cannot make smaller
+	std::vector<bytes::stream::byte_t> input {};
+	std::uint32_t random { 1 };
+	for (auto i = 0; i < 100000; i++)
+	{
+		random = random * 1103515245 + 12345;
+		input.push_back(static_cast<bytes::stream::byte_t>(random >> 24));
+	}
+
+	// Act
+	auto compressed = compress<compression::adaptive_huffman>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::adaptive_huffman>(std::move(compressed));
+
+	// Assert
+	EXPECT_LE(compressed_size, input.size() + 4);
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_adaptive_huffman, estimate)
+{
+	// Arrange
+	const std::string text = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+	bytes::stream::buffer_t input {};
+	for (auto i = 0; i < 200; i++)
+		input.insert(input.end(), text.cbegin(), text.cend());
+
+	// Act
+	auto estimate = compression::adaptive_huffman::estimate(compression::histogram { bytes::stream { input } });
+	auto compressed = compress<compression::adaptive_huffman>(std::move(input));
+
+	// Assert - within 5% of the actual size
+	EXPECT_LT(compressed.size(), 200 * text.size());
+	EXPECT_NEAR(static_cast<double>(estimate), static_cast<double>(compressed.size()), compressed.size() * 0.05);
+}
@@ -0,0 +1,141 @@
+///////////////////////////////////////////////////////////////////////
+// Tests of the batches of small records
+///////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <compression/batch.h>
+#include <compression/compression.h>
+#include <compression/histogram.h>
+#include <compression/huffman.h>
+
+namespace
+{
+	using buffer_t = bytes::stream::buffer_t;
+
+	// Log lines of a similar layout
+	std::vector<buffer_t> records(std::size_t count)
+	{
+		std::vector<buffer_t> result {};
+		for (std::size_t i = 0; i < count; i++)
+		{
+			auto line = "2024-05-0" + std::to_string(i % 9 + 1) + " INFO request " + std::to_string(i * 31 % 997) + " served in " + std::to_string(i % 50) + " ms\n";
+			result.emplace_back(line.cbegin(), line.cend());
+		}
+
+		return result;
+	}
+}
+
+TEST(compression_batch, compress_decompress_records)
+{
+	// Arrange
+	auto input = records(500);
+	std::vector<buffer_t> payloads {};
+	std::vector<buffer_t> output {};
+
+	// Act
+	buffer_t header {};
+	auto is_compressed = compression::batch::compress(input, header, payloads);
+	auto is_success = compression::batch::decompress(header, payloads, output);
+
+	// Assert
+	EXPECT_TRUE(is_compressed);
+	EXPECT_TRUE(is_success);
+	EXPECT_EQ(payloads.size(), input.size());
+	EXPECT_EQ(output, input);
+}
+
+TEST(compression_batch, decompress_single_record)
+{
+	// Arrange
+	auto input = records(100);
+	buffer_t header {};
+	std::vector<buffer_t> payloads {};
+	EXPECT_TRUE(compression::batch::compress(input, header, payloads));
+
+	// Act
+	compression::dictionary table {};
+	buffer_t record {};
+	auto is_open = compression::batch::open(header, table);
+	auto is_success = compression::batch::decompress(table, payloads[42], record);
+
+	// Assert
+	EXPECT_TRUE(is_open);
+	EXPECT_TRUE(is_success);
+	EXPECT_EQ(record, input[42]);
+}
+
+TEST(compression_batch, compress_decompress_empty_records)
+{
+	// Arrange
+	std::vector<buffer_t> input { buffer_t {}, buffer_t { 'a' }, buffer_t {} };
+	std::vector<buffer_t> payloads {};
+	std::vector<buffer_t> output {};
+
+	// Act
+	buffer_t header {};
+	auto is_compressed = compression::batch::compress(input, header, payloads);
+	auto is_success = compression::batch::decompress(header, payloads, output);
+
+	// Assert
+	EXPECT_TRUE(is_compressed);
+	EXPECT_TRUE(is_success);
+	EXPECT_EQ(output, input);
+}
+
+TEST(compression_batch, smaller_than_huffman_per_record)
+{
+	// Arrange
+	auto input = records(200);
+	std::vector<buffer_t> payloads {};
+
+	// Act
+	buffer_t header {};
+	compression::batch::compress(input, header, payloads);
+	std::size_t batch_size { header.size() };
+	std::size_t huffman_size { 0 };
+	for (std::size_t i = 0; i < input.size(); i++)
+	{
+		batch_size += payloads[i].size();
+		huffman_size += compress<compression::huffman>(buffer_t { input[i] }).size();
+	}
+
+	// Assert
+	EXPECT_LT(batch_size, huffman_size);
+}
+
+TEST(compression_batch, sample_records)
+{
+	// Arrange
+	auto input = records(1000);
+
+	// Act
+	auto all = compression::batch::frequencies(input, 0);
+	auto sample = compression::batch::frequencies(input, 4096);
+
+	// Assert
+	EXPECT_GT(all.total(), 4096 * 4);
+	EXPECT_LE(sample.total(), 4096 + 64);
+	EXPECT_GT(sample.total(), 4096 / 2);
+}
+
+TEST(compression_batch, fail_on_other_header)
+{
+	// Arrange
+	auto input = records(50);
+	std::vector<buffer_t> payloads {};
+	std::vector<buffer_t> other_payloads {};
+	std::vector<buffer_t> output {};
+	buffer_t header {};
+	buffer_t other_header {};
+	compression::batch::compress(input, header, payloads);
+	compression::batch::compress(std::vector<buffer_t> { buffer_t(100, 0) }, other_header, other_payloads);
+
+	// Act
+	auto is_success = compression::batch::decompress(header, other_payloads, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
@@ -0,0 +1,267 @@
+///////////////////////////////////////////////////////////////////////
+// Tests of the Burrows-Wheeler transform
+///////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+
+#include <compression/compression.h>
+#include <compression/bwt.h>
+#include <compression/huffman.h>
+#include <compression/simple.h>
+
+namespace
+{
+	using bwt_huffman = compression::block_sorting<compression::huffman>;
+
+	// Pseudo-random words, which repeat in many contexts
+	bytes::stream::buffer_t words(std::size_t size)
+	{
+		const std::string vocabulary[] { "the ", "quick ", "brown ", "fox ", "jumps ", "over ", "lazy ", "dog ", "and ", "runs ", "away.\n" };
+		bytes::stream::buffer_t result {};
+		std::uint32_t random { 1 };
+		while (result.size() < size)
+		{
+			random = random * 1103515245 + 12345;
+			const auto& word = vocabulary[(random >> 16) % std::size(vocabulary)];
+			result.insert(result.end(), word.cbegin(), word.cend());
+		}
+
+		return result;
+	}
+
+	// Pseudo-random bytes, which coding cannot make smaller
+	bytes::stream::buffer_t noise(std::size_t size)
+	{
+		bytes::stream::buffer_t result(size);
+		std::uint32_t random { 1 };
+		for (auto& value : result)
+		{
+			random = random * 1103515245 + 12345;
+			value = static_cast<bytes::stream::byte_t>(random >> 24);
+		}
+
+		return result;
+	}
+}
+
+TEST(algorithm_bwt, suffix_array)
+{
+	// Arrange - strings with repeats, runs and a range of byte values
+	std::vector<std::string> inputs { "banana", "mississippi", "aaaaaaaaaa", "abababababab", "", "z" };
+	std::string random {};
+	std::uint32_t state { 1 };
+	for (auto i = 0; i < 2000; i++)
+	{
+		state = state * 1103515245 + 12345;
+		random.push_back(static_cast<char>('a' + (state >> 16) % 3));
+	}
+	inputs.push_back(random);
+
+	for (const auto& input : inputs)
+	{
+		std::vector<std::uint32_t> expected(input.size());
+		std::iota(expected.begin(), expected.end(), 0u);
+		std::sort(expected.begin(), expected.end(), [&](auto lhs, auto rhs) { return input.compare(lhs, std::string::npos, input, rhs, std::string::npos) < 0; });
+
+		// Act
+		auto sa = compression::bwt::suffix_array(reinterpret_cast<const bytes::stream::byte_t*>(input.data()), input.size());
+
+		// Assert
+		EXPECT_EQ(sa, expected) << input;
+	}
+}
+
+TEST(algorithm_bwt, compress_decompress_text)
+{
+	// Arrange
+	const std::string input = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+
+	// Act
+	auto compressed = compress<bwt_huffman>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<bwt_huffman>(std::move(compressed));
+
+	// Assert
+	bytes::stream::buffer_t expected { input.cbegin(), input.cend() };
+	EXPECT_EQ(decompressed, expected);
+}
+
+TEST(algorithm_bwt, compress_decompress_full_range)
+{
+	// Arrange - every byte value, so that the move-to-front values need escapes
+	std::vector<bytes::stream::byte_t> input {};
+	for (auto i = 0; i <= 255; i++)
+		input.push_back(static_cast<bytes::stream::byte_t>(255 - i));
+	for (auto i = 0; i <= 255; i++)
+		input.push_back(static_cast<bytes::stream::byte_t>(i));
+
+	// Act
+	auto compressed = compress<bwt_huffman>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<bwt_huffman>(std::move(compressed));
+
+	// Assert
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_bwt, compress_decompress_empty_range)
+{
+	// Arrange
+	std::vector<bytes::stream::byte_t> input {};
+
+	// Act
+	auto compressed = compress<bwt_huffman>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<bwt_huffman>(std::move(compressed));
+
+	// Assert
+	EXPECT_EQ(decompressed.size(), 0);
+}
+
+TEST(algorithm_bwt, compress_decompress_simple)
+{
+	// Arrange
+	auto input = words(20000);
+
+	// Act
+	auto compressed = compress<compression::block_sorting<compression::simple5>>(bytes::stream::buffer_t { input });
+	auto simple_size = compress<compression::simple5>(bytes::stream::buffer_t { input }).size();
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::block_sorting<compression::simple5>>(std::move(compressed));
+
+	// Assert
+	EXPECT_LT(compressed_size, simple_size);
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_bwt, repeated_words)
+{
+	// Arrange
+	auto input = words(100000);
+
+	// Act
+	auto compressed = compress<bwt_huffman>(bytes::stream::buffer_t { input });
+	auto huffman_size = compress<compression::huffman>(bytes::stream::buffer_t { input }).size();
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<bwt_huffman>(std::move(compressed));
+
+	// Assert
+	EXPECT_LT(compressed_size, huffman_size / 2);
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_bwt, long_run)
+{
+	// Arrange - a run far longer than a run digit can count
+	bytes::stream::buffer_t input(100000, 'a');
+	input.push_back('b');
+
+	// Act
+	auto compressed = compress<bwt_huffman>(bytes::stream::buffer_t { input });
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<bwt_huffman>(std::move(compressed));
+
+	// Assert
+	EXPECT_LT(compressed_size, 100);
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_bwt, several_blocks)
+{
+	// Arrange - the lowest level transforms blocks of 512 KB
+	auto input = words(1200000);
+	compression::options settings { .level = 1 };
+
+	// Act
+	auto compressed = compress<bwt_huffman>(bytes::stream::buffer_t { input }, settings);
+	auto decompressed = decompress<bwt_huffman>(std::move(compressed));
+
+	// Assert
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_bwt, move_to_front_far_values)
+{
+	// Arrange - runs of every byte value in a pseudo-random order, which move values from far back in the
+	// move-to-front order (including the escaped positions) to the front
+	bytes::stream::buffer_t input {};
+	std::uint32_t random { 1 };
+	for (auto i = 0; i < 4096; i++)
+	{
+		random = random * 1103515245 + 12345;
+		input.insert(input.end(), 64, static_cast<bytes::stream::byte_t>(random >> 24));
+	}
+
+	// Act
+	auto compressed = compress<compression::bwt>(bytes::stream::buffer_t { input });
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::bwt>(std::move(compressed));
+
+	// Assert
+	EXPECT_LT(compressed_size, input.size() / 4);
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_bwt, compress_incompressible)
+{
+	// Arrange
+	auto input = noise(300000);
+
+	// Act
+	auto compressed = compress<compression::bwt>(bytes::stream::buffer_t { input });
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::bwt>(std::move(compressed));
+
+	// Assert
+	EXPECT_LE(compressed_size, input.size() + 8);
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_bwt, stored_and_coded_blocks)
+{
+	// Arrange - pseudo-random bytes followed by words, where the lowest level transforms blocks of 512 KB
+	auto input = noise(600000);
+	input.resize(1200000);
+
+	auto text = words(600000);
+	std::copy(text.cbegin(), text.cbegin() + 600000, input.begin() + 600000);
+	compression::options settings { .level = 1 };
+
+	// Act
+	auto compressed = compress<compression::bwt>(bytes::stream::buffer_t { input }, settings);
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::bwt>(std::move(compressed));
+
+	// Assert - the first block is stored, and the words of the others are still coded
+	EXPECT_LT(compressed_size, 900000);
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_bwt, decompress_truncated)
+{
+	// Arrange
+	auto compressed = compress<compression::bwt>(words(5000));
+	compressed.resize(compressed.size() / 2);
+
+	bytes::stream input { std::move(compressed) };
+	bytes::stream output {};
+
+	// Act
+	auto is_success = compression::bwt::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
+
+TEST(algorithm_bwt, decompress_truncated_header)
+{
+	// Arrange
+	bytes::stream input { bytes::stream::buffer_t { 0x7E, 0xFF } };
+	bytes::stream output {};
+
+	// Act
+	auto is_success = compression::bwt::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
@@ -0,0 +1,136 @@
+///////////////////////////////////////////////////////////////////////
+// Tests of the deduplication of repeated chunks
+///////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+
+#include <compression/compression.h>
+#include <compression/dedup.h>
+#include <compression/huffman.h>
+#include <compression/identity.h>
+#include <compression/lz77.h>
+
+namespace
+{
+	using dedup_huffman = compression::dedup<compression::huffman>;
+
+	// Pseudo-random bytes, which no coder can compress
+	bytes::stream::buffer_t noise(std::size_t size, std::uint32_t seed)
+	{
+		bytes::stream::buffer_t result(size);
+		for (auto& value : result)
+		{
+			seed = seed * 1103515245 + 12345;
+			value = static_cast<bytes::stream::byte_t>(seed >> 24);
+		}
+
+		return result;
+	}
+}
+
+TEST(algorithm_dedup, compress_decompress_text)
+{
+	// Arrange
+	const std::string input = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+
+	// Act
+	auto compressed = compress<dedup_huffman>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<dedup_huffman>(std::move(compressed));
+
+	// Assert
+	bytes::stream::buffer_t expected { input.cbegin(), input.cend() };
+	EXPECT_EQ(decompressed, expected);
+}
+
+TEST(algorithm_dedup, compress_decompress_empty_range)
+{
+	// Arrange
+	std::vector<bytes::stream::byte_t> input {};
+
+	// Act
+	auto compressed = compress<dedup_huffman>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<dedup_huffman>(std::move(compressed));
+
+	// Assert
+	EXPECT_EQ(decompressed.size(), 0);
+}
+
+TEST(algorithm_dedup, chunks_follow_content)
+{
+	// Arrange - the same data behind a different prefix
+	auto data = noise(200000, 1);
+	auto shifted = noise(1234, 2);
+	shifted.insert(shifted.end(), data.cbegin(), data.cend());
+
+	// Act
+	std::vector<std::size_t> cuts {};
+	std::vector<std::size_t> shifted_cuts {};
+	for (std::size_t start = 0; start < data.size(); start += compression::chunk_table::cut(data.data() + start, data.size() - start))
+		cuts.push_back(start);
+	for (std::size_t start = 0; start < shifted.size(); start += compression::chunk_table::cut(shifted.data() + start, shifted.size() - start))
+		shifted_cuts.push_back(start >= 1234 ? start - 1234 : 0);
+
+	// Assert - after the first few chunks the cuts are found at the same places
+	auto common = std::count_if(cuts.cbegin(), cuts.cend(), [&](auto cut) { return std::find(shifted_cuts.cbegin(), shifted_cuts.cend(), cut) != shifted_cuts.cend(); });
+	EXPECT_GT(cuts.size(), 200000 / compression::chunk_table::max_size);
+	EXPECT_GT(common, static_cast<std::ptrdiff_t>(cuts.size()) - 3);
+}
+
+TEST(algorithm_dedup, distant_repeats)
+{
+	// Arrange - a region repeated beyond the window of lz77, with different data in between
+	auto region = noise(50000, 1);
+	auto input = region;
+	auto filler = noise(100000, 2);
+	input.insert(input.end(), filler.cbegin(), filler.cend());
+	input.insert(input.end(), region.cbegin(), region.cend());
+	input.insert(input.end(), filler.cbegin(), filler.cbegin() + 5000);
+	input.insert(input.end(), region.cbegin(), region.cend());
+
+	// Act
+	auto compressed = compress<compression::dedup<compression::lz77>>(bytes::stream::buffer_t { input });
+	auto lz77_size = compress<compression::lz77>(bytes::stream::buffer_t { input }).size();
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::dedup<compression::lz77>>(std::move(compressed));
+
+	// Assert
+	EXPECT_LT(compressed_size, 170000);
+	EXPECT_GT(lz77_size, 200000);
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_dedup, decompress_truncated)
+{
+	// Arrange
+	auto region = noise(30000, 1);
+	bytes::stream::buffer_t input(2 * region.size());
+	std::copy(region.cbegin(), region.cend(), input.begin());
+	std::copy(region.cbegin(), region.cend(), input.begin() + region.size());
+
+	auto compressed = compress<compression::dedup<compression::identity>>(std::move(input));
+	compressed.resize(compressed.size() / 2);
+
+	bytes::stream in { std::move(compressed) };
+	bytes::stream out {};
+
+	// Act
+	auto is_success = compression::dedup<compression::identity>::decompress(in, out);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
+
+TEST(algorithm_dedup, decompress_truncated_header)
+{
+	// Arrange
+	bytes::stream input { bytes::stream::buffer_t { 0x7E, 0xFF } };
+	bytes::stream output {};
+
+	// Act
+	auto is_success = compression::dedup<compression::identity>::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
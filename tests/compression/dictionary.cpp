@@ -0,0 +1,190 @@
+///////////////////////////////////////////////////////////////////////
+// Tests of the trained dictionaries
+///////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <compression/compression.h>
+#include <compression/dictionary.h>
+#include <compression/histogram.h>
+#include <compression/huffman.h>
+
+namespace
+{
+	using buffer_t = bytes::stream::buffer_t;
+
+	// Records of a few hundred bytes with a similar layout
+	buffer_t record(std::size_t number)
+	{
+		std::string result { "{\"id\": " + std::to_string(number) + ", \"name\": \"user" + std::to_string(number * 7 % 1000) + "\", \"tags\": [" };
+		for (std::size_t i = 0; i < 20 + number % 10; i++)
+			result += "\"tag" + std::to_string((number + i) % 13) + "\", ";
+
+		result += "\"last\"]}";
+		return buffer_t { result.cbegin(), result.cend() };
+	}
+
+	compression::histogram corpus()
+	{
+		compression::histogram result {};
+		for (std::size_t number = 0; number < 100; number++)
+		{
+			auto data = record(number);
+			result.add(data.data(), data.size());
+		}
+
+		return result;
+	}
+
+	buffer_t compress_with(const compression::dictionary& dict, buffer_t&& data)
+	{
+		bytes::stream input { std::move(data) };
+		bytes::stream output {};
+		EXPECT_TRUE(dict.compress(input, output));
+		return output.buffer();
+	}
+}
+
+TEST(compression_dictionary, compress_decompress_record)
+{
+	// Arrange
+	auto dict = compression::dictionary::train_huffman(corpus());
+	auto input = record(1234);
+
+	// Act
+	bytes::stream compressed { compress_with(dict, buffer_t { input }) };
+	bytes::stream decompressed {};
+	auto is_success = dict.decompress(compressed, decompressed);
+
+	// Assert
+	EXPECT_TRUE(is_success);
+	EXPECT_EQ(decompressed.buffer(), input);
+}
+
+TEST(compression_dictionary, compress_decompress_unseen_bytes)
+{
+	// Arrange
+	auto dict = compression::dictionary::train_simple(corpus(), 5);
+	buffer_t input { 0, 1, 2, 250, 255, '{', '}' };
+
+	// Act
+	bytes::stream compressed { compress_with(dict, buffer_t { input }) };
+	bytes::stream decompressed {};
+	auto is_success = dict.decompress(compressed, decompressed);
+
+	// Assert
+	EXPECT_TRUE(is_success);
+	EXPECT_EQ(decompressed.buffer(), input);
+}
+
+TEST(compression_dictionary, compress_decompress_empty_range)
+{
+	// Arrange
+	auto dict = compression::dictionary::train_simple(corpus());
+
+	// Act
+	bytes::stream compressed { compress_with(dict, buffer_t {}) };
+	bytes::stream decompressed {};
+	auto is_success = dict.decompress(compressed, decompressed);
+
+	// Assert
+	EXPECT_TRUE(is_success);
+	EXPECT_EQ(decompressed.buffer().size(), 0);
+}
+
+TEST(compression_dictionary, compress_span)
+{
+	// Arrange
+	auto dict = compression::dictionary::train_huffman(corpus());
+	auto data = record(1234);
+
+	// Act
+	bytes::stream output {};
+	auto is_success = dict.compress(data, output);
+
+	// Assert
+	EXPECT_TRUE(is_success);
+	EXPECT_EQ(output.buffer(), compress_with(dict, buffer_t { data }));
+}
+
+TEST(compression_dictionary, smaller_than_huffman_for_records)
+{
+	// Arrange
+	auto dict = compression::dictionary::train_huffman(corpus());
+	auto input = record(4321);
+
+	// Act
+	auto with_dictionary = compress_with(dict, buffer_t { input });
+	auto with_huffman = compress<compression::huffman>(buffer_t { input });
+
+	// Assert
+	EXPECT_LT(with_dictionary.size(), input.size() * 3 / 4);
+	EXPECT_LT(with_dictionary.size(), with_huffman.size());
+}
+
+TEST(compression_dictionary, save_load)
+{
+	// Arrange
+	auto dict = compression::dictionary::train_simple(corpus());
+	bytes::stream file {};
+	dict.save(file);
+
+	// Act
+	bytes::stream input { buffer_t { file.buffer() } };
+	compression::dictionary loaded {};
+	auto is_success = compression::dictionary::load(input, loaded);
+
+	// Assert
+	EXPECT_TRUE(is_success);
+	EXPECT_EQ(loaded.id(), dict.id());
+	EXPECT_EQ(loaded.lengths(), dict.lengths());
+}
+
+TEST(compression_dictionary, fail_on_corrupt_file)
+{
+	// Arrange
+	auto dict = compression::dictionary::train_huffman(corpus());
+	bytes::stream file {};
+	dict.save(file);
+	auto contents = file.buffer();
+	contents[4] ^= 1;
+
+	// Act
+	bytes::stream input { std::move(contents) };
+	compression::dictionary loaded {};
+	auto is_success = compression::dictionary::load(input, loaded);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
+
+TEST(compression_dictionary, decompress_truncated_header)
+{
+	// Arrange
+	auto dict = compression::dictionary::train_huffman(corpus());
+	bytes::stream input { bytes::stream::buffer_t { 0x7E, 0xFF } };
+	bytes::stream output {};
+
+	// Act
+	auto is_success = dict.decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
+
+TEST(compression_dictionary, fail_on_other_dictionary)
+{
+	// Arrange
+	auto huffman_dict = compression::dictionary::train_huffman(corpus());
+	auto simple_dict = compression::dictionary::train_simple(corpus(), 4);
+
+	// Act
+	bytes::stream compressed { compress_with(huffman_dict, record(1)) };
+	bytes::stream decompressed {};
+	auto is_success = simple_dict.decompress(compressed, decompressed);
+
+	// Assert
+	EXPECT_NE(huffman_dict.id(), simple_dict.id());
+	EXPECT_FALSE(is_success);
+}
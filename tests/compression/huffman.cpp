@@ -7,6 +7,7 @@
 
 #include <compression/compression.h>
 #include <compression/huffman.h>
+#include <compression/histogram.h>
 
 TEST(algorithm_huffman, compress_decompress_text)
 {
@@ -94,3 +95,211 @@ TEST(algorithm_huffman, compress_decompress_empty_range)
 	for (std::size_t i = 0; i < expected.size(); i++)
 		EXPECT_EQ(decompressed[i], expected[i]);
 }
+
+TEST(algorithm_huffman, compress_decompress_single_symbol)
+{
+	// Arrange
+	const std::string input = { "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa" };
+
+	// Act
+	auto compressed = compress<compression::huffman>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<compression::huffman>(std::move(compressed));
+
+	// Assert
+	bytes::stream::buffer_t expected { input.cbegin(), input.cend() };
+	EXPECT_EQ(decompressed, expected);
+}
+
+TEST(algorithm_huffman, compress_decompress_long_codes)
+{
+	// Arrange - a skewed distribution, such that some codes are longer than the decoder lookup table
+	std::vector<bytes::stream::byte_t> input {};
+	for (auto i = 0; i < 16; i++)
+		input.insert(input.end(), std::size_t { 1 } << i, static_cast<bytes::stream::byte_t>(i * 7));
+
+	for (std::size_t i = 0; i < input.size(); i++)
+		std::swap(input[i], input[(i * 7919) % input.size()]);
+
+	// Act
+	auto compressed = compress<compression::huffman>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<compression::huffman>(std::move(compressed));
+
+	// Assert
+	bytes::stream::buffer_t expected { input.cbegin(), input.cend() };
+	EXPECT_EQ(decompressed, expected);
+}
+
+TEST(algorithm_huffman, decompress_truncated)
+{
+	// Arrange
+	const std::string text = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+	auto compressed = compress<compression::huffman>(bytes::stream::buffer_t { text.cbegin(), text.cend() });
+	compressed.resize(compressed.size() - 4);
+
+	// Act
+	bytes::stream input { std::move(compressed) };
+	bytes::stream output {};
+	auto is_success = compression::huffman::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
+
+TEST(algorithm_huffman, decompress_truncated_header)
+{
+	// Arrange
+	bytes::stream input { bytes::stream::buffer_t { 0x7E, 0xFF } };
+	bytes::stream output {};
+
+	// Act
+	auto is_success = compression::huffman::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
+
+TEST(algorithm_huffman, decompress_stored_size_overflow)
+{
+	// Arrange - a stored block whose size in bits does not fit in a word
+	bytes::stream input {};
+	input.put_word(1, 1);
+	input.put_size(std::size_t { 1 } << 61);
+	input.align();
+	input.put_word(0, 64);
+	input.seek(0);
+
+	bytes::stream output {};
+
+	// Act
+	auto is_success = compression::huffman::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
+
+TEST(algorithm_huffman, decompress_single_symbol_without_code)
+{
+	// Arrange - a block of 2^40 symbols of a single symbol with an empty code
+	bytes::stream input {};
+	input.put_word(0, 1);
+	input.put_size(std::size_t { 1 } << 40);
+	input.put_bits<9>(1);
+	input.put_bits<8>('a');
+	input.put_bits<9>(0);
+	input.seek(0);
+
+	bytes::stream output {};
+
+	// Act
+	auto is_success = compression::huffman::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+	EXPECT_TRUE(output.buffer().empty());
+}
+
+TEST(algorithm_huffman, compress_incompressible)
+{
+	// Arrange - every byte value occurs equally often
+	std::vector<bytes::stream::byte_t> input {};
+	for (auto i = 0; i < 4096; i++)
+		input.push_back(static_cast<bytes::stream::byte_t>((i * 167) ^ (i >> 8)));
+
+	// Act
+	auto compressed = compress<compression::huffman>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::huffman>(std::move(compressed));
+
+	// Assert
+	EXPECT_LE(compressed_size, input.size() + 3);
+	EXPECT_EQ(compressed_size, compression::huffman::estimate(compression::histogram { bytes::stream { input } }));
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_huffman, estimate)
+{
+	// Arrange
+	const std::string text = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+	bytes::stream::buffer_t input {};
+	for (auto i = 0; i < 20; i++)
+		input.insert(input.end(), text.cbegin(), text.cend());
+
+	// Act
+	auto estimate = compression::huffman::estimate(compression::histogram { bytes::stream { input } });
+	auto compressed = compress<compression::huffman>(std::move(input));
+
+	// Assert
+	EXPECT_LT(compressed.size(), 20 * text.size());
+	EXPECT_EQ(estimate, compressed.size());
+}
+
+TEST(algorithm_huffman, compress_decompress_sampled)
+{
+	// Arrange - bytes missing from the sampled frequencies are escaped
+	const std::string text = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+	bytes::stream::buffer_t input {};
+	while (input.size() < 200000)
+		input.insert(input.end(), text.cbegin(), text.cend());
+
+	for (std::size_t i = 0; i < 256; i++)
+		input[(input.size() / 16) * (i % 16) + 5000 + i] = static_cast<bytes::stream::byte_t>(i);
+
+	// Act
+	auto compressed = compress<compression::huffman>(bytes::stream::buffer_t { input }, compression::options { .level = 1 });
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::huffman>(std::move(compressed));
+
+	// Assert
+	EXPECT_LT(compressed_size, input.size());
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_huffman, reuse_contexts)
+{
+	// Arrange - inputs of different sizes and alphabets, coded by the same contexts
+	const std::vector<std::string> texts { "Hello world!", "", "aaaaaaaa", "The quick brown fox jumps over the lazy dog", "x" };
+	compression::huffman::encoder encoder {};
+	compression::huffman::decoder decoder {};
+
+	for (const auto& text : texts)
+	{
+		bytes::stream::buffer_t input { text.cbegin(), text.cend() };
+
+		// Act
+		bytes::stream uncompressed { input };
+		auto is_compressed = encoder.compress(uncompressed);
+		auto compressed = encoder.output();
+
+		bytes::stream stream { compressed };
+		auto is_decompressed = decoder.decompress(stream);
+
+		// Assert - the output is the same as that of the static functions
+		EXPECT_TRUE(is_compressed);
+		EXPECT_TRUE(is_decompressed);
+		EXPECT_EQ(compressed, compress<compression::huffman>(bytes::stream::buffer_t { input }));
+		EXPECT_EQ(decoder.output(), input);
+	}
+}
+
+TEST(algorithm_huffman, context_options)
+{
+	// Arrange - the sampling levels escape bytes missing from the sample
+	bytes::stream::buffer_t input(100000, 'a');
+	for (std::size_t i = 0; i < input.size(); i += 97)
+		input[i] = static_cast<bytes::stream::byte_t>(i % 256);
+
+	compression::options settings { .level = 1 };
+	compression::huffman::encoder encoder { settings };
+	compression::huffman::decoder decoder {};
+
+	// Act
+	bytes::stream uncompressed { input };
+	encoder.compress(uncompressed);
+	bytes::stream compressed { encoder.output() };
+	auto is_success = decoder.decompress(compressed);
+
+	// Assert
+	EXPECT_TRUE(is_success);
+	EXPECT_EQ(encoder.output(), compress<compression::huffman>(bytes::stream::buffer_t { input }, settings));
+	EXPECT_EQ(decoder.output(), input);
+}
@@ -0,0 +1,128 @@
+///////////////////////////////////////////////////////////////////////
+// Tests of the LZ77 algorithm
+///////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <compression/compression.h>
+#include <compression/huffman.h>
+#include <compression/lz77.h>
+
+TEST(algorithm_lz77, compress_decompress_text)
+{
+	// Arrange
+	const std::string input = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+
+	// Act
+	auto compressed = compress<compression::lz77>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<compression::lz77>(std::move(compressed));
+
+	// Assert
+	bytes::stream::buffer_t expected { input.cbegin(), input.cend() };
+	EXPECT_EQ(decompressed, expected);
+}
+
+TEST(algorithm_lz77, compress_decompress_full_range)
+{
+	// Arrange
+	std::vector<bytes::stream::byte_t> input {};
+	for (auto i = 0; i <= 255; i++)
+		input.push_back(static_cast<bytes::stream::byte_t>(i));
+
+	// Act
+	auto compressed = compress<compression::lz77>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<compression::lz77>(std::move(compressed));
+
+	// Assert
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_lz77, compress_decompress_empty_range)
+{
+	// Arrange
+	std::vector<bytes::stream::byte_t> input {};
+
+	// Act
+	auto compressed = compress<compression::lz77>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<compression::lz77>(std::move(compressed));
+
+	// Assert
+	EXPECT_EQ(decompressed.size(), 0);
+}
+
+TEST(algorithm_lz77, repeated_records)
+{
+	// Arrange - log-like records that mostly repeat earlier ones, over more than a window and a block
+	const std::string fields[] { "{\"level\":\"info\",\"service\":\"api\",\"latency_ms\":", "{\"level\":\"warn\",\"service\":\"db\",\"latency_ms\":" };
+	bytes::stream::buffer_t input {};
+	std::uint32_t random { 1 };
+	while (input.size() < 300000)
+	{
+		random = random * 1103515245 + 12345;
+		auto record = fields[(random >> 16) % 2] + std::to_string((random >> 8) % 1000) + "}\n";
+		input.insert(input.end(), record.cbegin(), record.cend());
+	}
+
+	// Act
+	auto compressed = compress<compression::lz77>(bytes::stream::buffer_t { input });
+	auto huffman_size = compress<compression::huffman>(bytes::stream::buffer_t { input }).size();
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::lz77>(std::move(compressed));
+
+	// Assert
+	EXPECT_LT(compressed_size, huffman_size / 4);
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_lz77, levels)
+{
+	// Arrange - runs that overlap their own matches
+	bytes::stream::buffer_t input {};
+	for (auto i = 0; i < 50000; i++)
+		input.insert(input.end(), static_cast<std::size_t>(i % 7 + 1), static_cast<bytes::stream::byte_t>(i % 5));
+
+	for (auto level = compression::options::min_level; level <= compression::options::max_level; level++)
+	{
+		// Act
+		auto compressed = compress<compression::lz77>(bytes::stream::buffer_t { input }, compression::options { .level = level });
+		auto decompressed = decompress<compression::lz77>(std::move(compressed));
+
+		// Assert
+		EXPECT_EQ(decompressed, input);
+	}
+}
+
+TEST(algorithm_lz77, decompress_truncated)
+{
+	// Arrange
+	const std::string text = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+	bytes::stream::buffer_t data {};
+	for (auto i = 0; i < 20; i++)
+		data.insert(data.end(), text.cbegin(), text.cend());
+
+	auto compressed = compress<compression::lz77>(std::move(data));
+	compressed.resize(compressed.size() / 2);
+
+	bytes::stream input { std::move(compressed) };
+	bytes::stream output {};
+
+	// Act
+	auto is_success = compression::lz77::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
+
+TEST(algorithm_lz77, decompress_truncated_header)
+{
+	// Arrange
+	bytes::stream input { bytes::stream::buffer_t { 0x7E, 0xFF } };
+	bytes::stream output {};
+
+	// Act
+	auto is_success = compression::lz77::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
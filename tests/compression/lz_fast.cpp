@@ -0,0 +1,134 @@
+///////////////////////////////////////////////////////////////////////
+// Tests of the fast LZ algorithm
+///////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <compression/compression.h>
+#include <compression/huffman.h>
+#include <compression/lz_fast.h>
+
+TEST(algorithm_lz_fast, compress_decompress_text)
+{
+	// Arrange
+	const std::string input = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+
+	// Act
+	auto compressed = compress<compression::lz_fast>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<compression::lz_fast>(std::move(compressed));
+
+	// Assert
+	bytes::stream::buffer_t expected { input.cbegin(), input.cend() };
+	EXPECT_EQ(decompressed, expected);
+}
+
+TEST(algorithm_lz_fast, compress_decompress_full_range)
+{
+	// Arrange
+	std::vector<bytes::stream::byte_t> input {};
+	for (auto i = 0; i <= 255; i++)
+		input.push_back(static_cast<bytes::stream::byte_t>(i));
+
+	// Act
+	auto compressed = compress<compression::lz_fast>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<compression::lz_fast>(std::move(compressed));
+
+	// Assert
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_lz_fast, compress_decompress_empty_range)
+{
+	// Arrange
+	std::vector<bytes::stream::byte_t> input {};
+
+	// Act
+	auto compressed = compress<compression::lz_fast>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<compression::lz_fast>(std::move(compressed));
+
+	// Assert
+	EXPECT_EQ(decompressed.size(), 0);
+}
+
+TEST(algorithm_lz_fast, repeated_records)
+{
+	// Arrange - log-like records that mostly repeat earlier ones, over more than a window and a block
+	const std::string fields[] { "{\"level\":\"info\",\"service\":\"api\",\"latency_ms\":", "{\"level\":\"warn\",\"service\":\"db\",\"latency_ms\":" };
+	bytes::stream::buffer_t input {};
+	std::uint32_t random { 1 };
+	while (input.size() < 300000)
+	{
+		random = random * 1103515245 + 12345;
+		auto record = fields[(random >> 16) % 2] + std::to_string((random >> 8) % 1000) + "}\n";
+		input.insert(input.end(), record.cbegin(), record.cend());
+	}
+
+	// Act
+	auto compressed = compress<compression::lz_fast>(bytes::stream::buffer_t { input });
+	auto huffman_size = compress<compression::huffman>(bytes::stream::buffer_t { input }).size();
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::lz_fast>(std::move(compressed));
+
+	// Assert
+	EXPECT_LT(compressed_size, huffman_size / 2);
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_lz_fast, long_runs)
+{
+	// Arrange - literal runs and matches with lengths that continue over several bytes, and overlapping matches
+	bytes::stream::buffer_t input {};
+	std::uint32_t random { 1 };
+	for (auto i = 0; i < 1000; i++)
+	{
+		random = random * 1103515245 + 12345;
+		input.push_back(static_cast<bytes::stream::byte_t>(random >> 24));
+	}
+	input.insert(input.end(), 5000, 'a');
+	input.insert(input.end(), input.begin(), input.begin() + 600);
+	input.insert(input.end(), { 'x', 'y', 'z' });
+
+	// Act
+	auto compressed = compress<compression::lz_fast>(bytes::stream::buffer_t { input });
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::lz_fast>(std::move(compressed));
+
+	// Assert
+	EXPECT_LT(compressed_size, 1100);
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_lz_fast, decompress_truncated)
+{
+	// Arrange
+	const std::string text = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+	bytes::stream::buffer_t data {};
+	for (auto i = 0; i < 20; i++)
+		data.insert(data.end(), text.cbegin(), text.cend());
+
+	auto compressed = compress<compression::lz_fast>(std::move(data));
+	compressed.resize(compressed.size() / 2);
+
+	bytes::stream input { std::move(compressed) };
+	bytes::stream output {};
+
+	// Act
+	auto is_success = compression::lz_fast::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
+
+TEST(algorithm_lz_fast, decompress_truncated_header)
+{
+	// Arrange
+	bytes::stream input { bytes::stream::buffer_t { 0x7E, 0xFF } };
+	bytes::stream output {};
+
+	// Act
+	auto is_success = compression::lz_fast::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
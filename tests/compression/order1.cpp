@@ -0,0 +1,186 @@
+///////////////////////////////////////////////////////////////////////
+// Tests of the order-1 context algorithm
+///////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <compression/ans.h>
+#include <compression/compression.h>
+#include <compression/order1.h>
+#include <compression/stored.h>
+#include <compression/tans.h>
+
+TEST(algorithm_order1, compress_decompress_text)
+{
+	// Arrange
+	const std::string input = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+
+	// Act
+	auto compressed = compress<compression::order1>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<compression::order1>(std::move(compressed));
+
+	// Assert
+	bytes::stream::buffer_t expected { input.cbegin(), input.cend() };
+	EXPECT_EQ(decompressed, expected);
+}
+
+TEST(algorithm_order1, compress_decompress_full_range)
+{
+	// Arrange
+	std::vector<bytes::stream::byte_t> input {};
+	for (auto i = 0; i <= 255; i++)
+		input.push_back(static_cast<bytes::stream::byte_t>(i));
+
+	// Act
+	auto compressed = compress<compression::order1>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<compression::order1>(std::move(compressed));
+
+	// Assert
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_order1, compress_decompress_empty_range)
+{
+	// Arrange
+	std::vector<bytes::stream::byte_t> input {};
+
+	// Act
+	auto compressed = compress<compression::order1>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<compression::order1>(std::move(compressed));
+
+	// Assert
+	EXPECT_EQ(decompressed.size(), 0);
+}
+
+TEST(algorithm_order1, correlated_beats_order0)
+{
+	// Arrange - words in a pseudo-random order, where each letter mostly follows from the previous one
+	const std::string words[] { "alpha ", "bravo ", "charlie ", "delta ", "echo ", "foxtrot ", "golf ", "hotel " };
+	bytes::stream::buffer_t input {};
+	std::uint32_t random { 1 };
+	while (input.size() < 200000)
+	{
+		random = random * 1103515245 + 12345;
+		const auto& word = words[(random >> 16) % 8];
+		input.insert(input.end(), word.cbegin(), word.cend());
+	}
+
+	// Act
+	auto compressed = compress<compression::order1>(bytes::stream::buffer_t { input });
+	auto tans_size = compress<compression::tans>(bytes::stream::buffer_t { input }).size();
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::order1>(std::move(compressed));
+
+	// Assert
+	EXPECT_LT(compressed_size, tans_size / 2);
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_order1, decompress_truncated)
+{
+	// Arrange
+	const std::string text = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+	bytes::stream::buffer_t data {};
+	for (auto i = 0; i < 20; i++)
+		data.insert(data.end(), text.cbegin(), text.cend());
+
+	auto compressed = compress<compression::order1>(std::move(data));
+	compressed.resize(compressed.size() / 2);
+
+	bytes::stream input { std::move(compressed) };
+	bytes::stream output {};
+
+	// Act
+	auto is_success = compression::order1::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
+
+TEST(algorithm_order1, decompress_truncated_header)
+{
+	// Arrange
+	bytes::stream input { bytes::stream::buffer_t { 0x7E, 0xFF } };
+	bytes::stream output {};
+
+	// Act
+	auto is_success = compression::order1::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
+
+TEST(algorithm_order1, decompress_impossible_count)
+{
+	// Arrange - a header of a single table of two values, claiming far more values than the bits allow
+	compression::histogram freqs {};
+	freqs.add('a', 3);
+	freqs.add('b', 1);
+
+	bytes::stream input {};
+	compression::stored::put_encoded(input);
+	input.put_size(std::size_t { 1 } << 40);
+	input.put_word(0, 6);
+	compression::ans::put_frequencies(input, compression::ans::normalize(freqs));
+	input.put_word(0, compression::ans::table_log);
+	input.put_word(0, 64);
+	input.seek(0);
+
+	bytes::stream output {};
+
+	// Act
+	auto is_success = compression::order1::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+	EXPECT_EQ(output.buffer().size(), 0);
+}
+
+TEST(algorithm_order1, decompress_single_value_tables)
+{
+	// Arrange - two tables of a single value each, where 'b' follows 'a' and 'a' follows everything else,
+	// which read every value without bits, claiming 2^36 values
+	bytes::stream input {};
+	compression::stored::put_encoded(input);
+	input.put_size(std::size_t { 1 } << 36);
+	input.put_word(1, 6);
+	for (std::size_t context = 0; context < 256; context++)
+		input.put_word(context == 'a' ? 1 : 0, 1);
+
+	for (auto value : { 'a', 'b' })
+	{
+		input.put_word(1, 9);
+		input.put_word(static_cast<std::uint64_t>(value), 8);
+	}
+
+	input.put_word(0, compression::ans::table_log);
+	input.seek(0);
+
+	bytes::stream output {};
+
+	// Act
+	auto is_success = compression::order1::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+	EXPECT_EQ(output.buffer().size(), 0);
+}
+
+TEST(algorithm_order1, compress_decompress_single_followers)
+{
+	// Arrange - every byte has a single byte following it
+	bytes::stream::buffer_t input {};
+	while (input.size() < (1 << 20))
+		for (auto value : { 'a', 'b', 'c' })
+			input.push_back(static_cast<bytes::stream::byte_t>(value));
+
+	// Act
+	auto compressed = compress<compression::order1>(bytes::stream::buffer_t { input });
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::order1>(std::move(compressed));
+
+	// Assert
+	EXPECT_LT(compressed_size, 256);
+	EXPECT_EQ(decompressed, input);
+}
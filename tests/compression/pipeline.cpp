@@ -0,0 +1,114 @@
+///////////////////////////////////////////////////////////////////////
+// Tests of the pipeline of filters and an algorithm
+///////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <compression/compression.h>
+#include <compression/huffman.h>
+#include <compression/identity.h>
+#include <compression/pipeline.h>
+#include <compression/rle.h>
+#include <compression/simple.h>
+
+namespace
+{
+	// Records with runs of padding, over several chunks of the pipeline
+	bytes::stream::buffer_t padded_records(std::size_t size)
+	{
+		bytes::stream::buffer_t result {};
+		std::uint32_t random { 1 };
+		while (result.size() < size)
+		{
+			random = random * 1103515245 + 12345;
+			auto field = std::to_string(random >> 20);
+			result.insert(result.end(), field.cbegin(), field.cend());
+			result.insert(result.end(), 10 + (random >> 8) % 300, ' ');
+		}
+
+		return result;
+	}
+}
+
+static_assert(compression_algorithm<compression::pipeline<compression::rle, compression::simple5>>);
+static_assert(configurable_algorithm<compression::pipeline<compression::rle, compression::huffman>>);
+
+TEST(pipeline, compress_decompress_text)
+{
+	// Arrange
+	using algorithm = compression::pipeline<compression::rle, compression::huffman>;
+	const std::string input = { "Hello world!!! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+
+	// Act
+	auto compressed = compress<algorithm>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<algorithm>(std::move(compressed));
+
+	// Assert
+	bytes::stream::buffer_t expected { input.cbegin(), input.cend() };
+	EXPECT_EQ(decompressed, expected);
+}
+
+TEST(pipeline, compress_decompress_empty_range)
+{
+	// Arrange
+	using algorithm = compression::pipeline<compression::rle, compression::simple5>;
+	std::vector<bytes::stream::byte_t> input {};
+
+	// Act
+	auto compressed = compress<algorithm>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<algorithm>(std::move(compressed));
+
+	// Assert
+	EXPECT_EQ(decompressed.size(), 0);
+}
+
+TEST(pipeline, rle_simple5)
+{
+	// Arrange
+	using algorithm = compression::pipeline<compression::rle, compression::simple5>;
+	auto input = padded_records(300000);
+
+	// Act
+	auto compressed = compress<algorithm>(bytes::stream::buffer_t { input });
+	auto simple_size = compress<compression::simple5>(bytes::stream::buffer_t { input }).size();
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<algorithm>(std::move(compressed));
+
+	// Assert
+	EXPECT_LT(compressed_size, simple_size / 4);
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(pipeline, chained_filters)
+{
+	// Arrange - the second filter sees the counts written by the first one, which continue over chunks
+	using algorithm = compression::pipeline<compression::rle, compression::rle, compression::identity>;
+	auto input = padded_records(200000);
+	input.insert(input.end(), 100000, 0);
+
+	// Act
+	auto compressed = compress<algorithm>(bytes::stream::buffer_t { input });
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<algorithm>(std::move(compressed));
+
+	// Assert
+	EXPECT_LT(compressed_size, input.size() / 10);
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(pipeline, decompress_incomplete_filter)
+{
+	// Arrange - a pair without its number of repeats
+	using algorithm = compression::pipeline<compression::rle, compression::identity>;
+	auto compressed = compress<compression::identity>(bytes::stream::buffer_t { 'a', 'b', 'b' });
+
+	bytes::stream input { std::move(compressed) };
+	bytes::stream output {};
+
+	// Act
+	auto is_success = algorithm::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
@@ -0,0 +1,132 @@
+///////////////////////////////////////////////////////////////////////
+// Tests of the pull-based decompression
+///////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <compression/compression.h>
+#include <compression/huffman.h>
+#include <compression/reader.h>
+#include <compression/simple.h>
+
+#include <test_data.h>
+
+namespace
+{
+	using buffer_t = bytes::stream::buffer_t;
+
+	// Read all bytes in parts of the given size
+	template <typename T> buffer_t read_all(compression::reader<T>& reader, std::size_t part)
+	{
+		buffer_t result {};
+		while (reader.read(result, part) > 0)
+			;
+
+		return result;
+	}
+}
+
+TEST(compression_reader, read_huffman_in_parts)
+{
+	// Arrange
+	auto input = test_data::lines<buffer_t>(1000);
+	compression::reader<compression::huffman> reader { compress<compression::huffman>(buffer_t { input }) };
+
+	// Act
+	auto output = read_all(reader, 1000);
+
+	// Assert
+	EXPECT_TRUE(reader.valid());
+	EXPECT_TRUE(reader.at_end());
+	EXPECT_EQ(output, input);
+}
+
+TEST(compression_reader, read_simple_in_parts)
+{
+	// Arrange
+	auto input = test_data::lines<buffer_t>(1000);
+	compression::reader<compression::simple5> reader { compress<compression::simple5>(buffer_t { input }) };
+
+	// Act
+	auto output = read_all(reader, 7);
+
+	// Assert
+	EXPECT_TRUE(reader.valid());
+	EXPECT_EQ(output, input);
+}
+
+TEST(compression_reader, read_first_line)
+{
+	// Arrange
+	auto input = test_data::lines<buffer_t>(10000);
+	compression::reader<compression::huffman> reader { compress<compression::huffman>(buffer_t { input }) };
+
+	// Act
+	buffer_t output {};
+	auto decoded = reader.read(output, 16);
+
+	// Assert - the rest of the data is not decoded
+	EXPECT_EQ(decoded, 16);
+	EXPECT_EQ(output, buffer_t(input.cbegin(), input.cbegin() + 16));
+	EXPECT_EQ(reader.remaining(), input.size() - 16);
+}
+
+TEST(compression_reader, read_stored_data)
+{
+	// Arrange - data that cannot be compressed is stored
+	buffer_t input(256);
+	for (std::size_t i = 0; i < input.size(); i++)
+		input[i] = static_cast<bytes::stream::byte_t>(i);
+
+	compression::reader<compression::huffman> reader { compress<compression::huffman>(buffer_t { input }) };
+
+	// Act
+	auto output = read_all(reader, 100);
+
+	// Assert
+	EXPECT_TRUE(reader.valid());
+	EXPECT_EQ(output, input);
+}
+
+TEST(compression_reader, read_single_symbol)
+{
+	// Arrange
+	buffer_t input(1000, 'a');
+	compression::reader<compression::huffman> reader { compress<compression::huffman>(buffer_t { input }) };
+
+	// Act
+	auto output = read_all(reader, 300);
+
+	// Assert
+	EXPECT_EQ(output, input);
+}
+
+TEST(compression_reader, read_empty_range)
+{
+	// Arrange
+	compression::reader<compression::simple3> reader { compress<compression::simple3>(buffer_t {}) };
+
+	// Act
+	auto output = read_all(reader, 10);
+
+	// Assert
+	EXPECT_TRUE(reader.valid());
+	EXPECT_EQ(output.size(), 0);
+}
+
+TEST(compression_reader, fail_on_truncated_data)
+{
+	// Arrange
+	auto input = test_data::lines<buffer_t>(100);
+	auto compressed = compress<compression::huffman>(buffer_t { input });
+	compressed.resize(compressed.size() / 2);
+	compression::reader<compression::huffman> reader { std::move(compressed) };
+
+	// Act
+	auto output = read_all(reader, 64);
+
+	// Assert
+	EXPECT_FALSE(reader.valid());
+	EXPECT_LT(output.size(), input.size());
+}
@@ -0,0 +1,78 @@
+///////////////////////////////////////////////////////////////////////
+// Tests of the run-length filter
+///////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <compression/rle.h>
+
+namespace
+{
+	using byte = bytes::stream::byte_t;
+
+	// Pass data through a filter in chunks of the given size
+	template <typename Encode, typename Finish> std::vector<byte> in_chunks(const std::vector<byte>& data, std::size_t chunk, Encode&& encode, Finish&& finish)
+	{
+		std::vector<byte> result {};
+		for (std::size_t start = 0; start < data.size(); start += chunk)
+			encode(data.data() + start, std::min(chunk, data.size() - start), result);
+
+		finish(result);
+		return result;
+	}
+}
+
+TEST(filter_rle, encode_runs)
+{
+	// Arrange
+	std::vector<byte> input { 'a', 'b', 'b', 'c', 'c', 'c', 'c', 'd' };
+	compression::rle filter {};
+
+	// Act
+	auto encoded = in_chunks(input, input.size(), [&](auto data, auto count, auto& output) { filter.encode(data, count, output); }, [&](auto& output) { filter.finish_encode(output); });
+
+	// Assert
+	std::vector<byte> expected { 'a', 'b', 'b', 0, 'c', 'c', 2, 'd' };
+	EXPECT_EQ(encoded, expected);
+}
+
+TEST(filter_rle, encode_decode_across_chunks)
+{
+	// Arrange - runs longer than a count can hold, and runs ending with the data
+	std::vector<byte> input { 'x' };
+	input.insert(input.end(), 600, 'a');
+	input.insert(input.end(), { 'b', 'c', 'c' });
+	input.insert(input.end(), 257, 'd');
+
+	for (std::size_t chunk : { 1, 2, 3, 7, 1000 })
+	{
+		compression::rle encoder {};
+		compression::rle decoder {};
+		auto is_complete = false;
+
+		// Act
+		auto encoded = in_chunks(input, chunk, [&](auto data, auto count, auto& output) { encoder.encode(data, count, output); }, [&](auto& output) { encoder.finish_encode(output); });
+		auto decoded = in_chunks(encoded, chunk, [&](auto data, auto count, auto& output) { decoder.decode(data, count, output); }, [&](auto& output) { is_complete = decoder.finish_decode(output); });
+
+		// Assert
+		EXPECT_LT(encoded.size(), 20);
+		EXPECT_TRUE(is_complete);
+		EXPECT_EQ(decoded, input) << chunk;
+	}
+}
+
+TEST(filter_rle, decode_missing_count)
+{
+	// Arrange
+	std::vector<byte> input { 'a', 'b', 'b' };
+	std::vector<byte> output {};
+	compression::rle filter {};
+
+	// Act
+	filter.decode(input.data(), input.size(), output);
+	auto is_complete = filter.finish_decode(output);
+
+	// Assert
+	EXPECT_FALSE(is_complete);
+}
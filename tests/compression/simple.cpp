@@ -179,3 +179,108 @@ TEST(algorithm_simple, compress_decompress_empty_range)
 	for (std::size_t i = 0; i < expected.size(); i++)
 		EXPECT_EQ(decompressed[i], expected[i]);
 }
+
+TEST(algorithm_simple, compress_decompress_long_input)
+{
+	// Arrange
+	std::vector<bytes::stream::byte_t> input {};
+	std::uint32_t state { 12345 };
+	for (auto i = 0; i < 10000; i++)
+	{
+		state = state * 1103515245 + 12345;
+		input.push_back(static_cast<bytes::stream::byte_t>((state >> 16) % ((i % 3) == 0 ? 256 : 16)));
+	}
+
+	// Act
+	auto compressed = compress<compression::simple4>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<compression::simple4>(std::move(compressed));
+
+	// Assert
+	bytes::stream::buffer_t expected { input.cbegin(), input.cend() };
+	EXPECT_EQ(decompressed, expected);
+}
+
+TEST(algorithm_simple, decompress_truncated)
+{
+	// Arrange
+	const std::string text = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+	auto compressed = compress<compression::simple5>(bytes::stream::buffer_t { text.cbegin(), text.cend() });
+	compressed.resize(compressed.size() - 4);
+
+	// Act
+	bytes::stream input { std::move(compressed) };
+	bytes::stream output {};
+	auto is_success = compression::simple5::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
+
+TEST(algorithm_simple, decompress_truncated_header)
+{
+	// Arrange
+	bytes::stream input { bytes::stream::buffer_t { 0x7E, 0xFF } };
+	bytes::stream output {};
+
+	// Act
+	auto is_success = compression::simple5::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
+
+TEST(algorithm_simple, compress_incompressible)
+{
+	// Arrange - every byte value occurs equally often
+	std::vector<bytes::stream::byte_t> input {};
+	for (auto i = 0; i < 4096; i++)
+		input.push_back(static_cast<bytes::stream::byte_t>((i * 167) ^ (i >> 8)));
+
+	// Act
+	auto compressed = compress<compression::simple2>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::simple2>(std::move(compressed));
+
+	// Assert
+	EXPECT_LE(compressed_size, input.size() + 3);
+	EXPECT_EQ(compressed_size, compression::simple2::estimate(compression::histogram { bytes::stream { input } }));
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_simple, estimate)
+{
+	// Arrange
+	const std::string text = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+	bytes::stream::buffer_t input {};
+	for (auto i = 0; i < 20; i++)
+		input.insert(input.end(), text.cbegin(), text.cend());
+
+	// Act
+	auto estimate = compression::simple5::estimate(compression::histogram { bytes::stream { input } });
+	auto compressed = compress<compression::simple5>(std::move(input));
+
+	// Assert
+	EXPECT_LT(compressed.size(), 20 * text.size());
+	EXPECT_EQ(estimate, compressed.size());
+}
+
+TEST(algorithm_simple, compress_decompress_sampled)
+{
+	// Arrange - bytes missing from the sampled frequencies are escaped
+	const std::string text = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+	bytes::stream::buffer_t input {};
+	while (input.size() < 200000)
+		input.insert(input.end(), text.cbegin(), text.cend());
+
+	for (std::size_t i = 0; i < 256; i++)
+		input[(input.size() / 16) * (i % 16) + 5000 + i] = static_cast<bytes::stream::byte_t>(i);
+
+	// Act
+	auto compressed = compress<compression::simple4>(bytes::stream::buffer_t { input }, compression::options { .level = 1 });
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::simple4>(std::move(compressed));
+
+	// Assert
+	EXPECT_LT(compressed_size, input.size());
+	EXPECT_EQ(decompressed, input);
+}
@@ -0,0 +1,134 @@
+///////////////////////////////////////////////////////////////////////
+// Tests of the static Huffman coding algorithm
+///////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <compression/compression.h>
+#include <compression/huffman.h>
+#include <compression/static_huffman.h>
+
+// The codes and table are built by the compiler
+static_assert(compression::static_text::lengths[' '] < compression::static_text::lengths['q']);
+static_assert(compression::static_json::lengths['"'] < compression::static_json::lengths['Q']);
+static_assert(compression::static_binary::lengths[0] == 1);
+static_assert(compression::static_binary::table[0].symbol == 0);
+
+TEST(algorithm_static_huffman, lengths_match_prefix_code)
+{
+	// Arrange
+	using code_t = compression::static_text::code_t;
+
+	// Act
+	auto text_lengths = code_t::lengths(compression::profiles::english_text::frequencies);
+	auto binary_lengths = code_t::lengths(compression::profiles::zero_heavy_binary::frequencies);
+
+	// Assert
+	EXPECT_EQ(compression::static_text::lengths, text_lengths);
+	EXPECT_EQ(compression::static_binary::lengths, binary_lengths);
+}
+
+TEST(algorithm_static_huffman, compress_decompress_text)
+{
+	// Arrange
+	const std::string input = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+
+	// Act
+	auto compressed = compress<compression::static_text>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::static_text>(std::move(compressed));
+
+	// Assert
+	bytes::stream::buffer_t expected { input.cbegin(), input.cend() };
+	EXPECT_EQ(decompressed, expected);
+	EXPECT_LT(compressed_size, input.size() * 3 / 4);
+}
+
+TEST(algorithm_static_huffman, compress_decompress_empty_range)
+{
+	// Arrange
+	std::vector<bytes::stream::byte_t> input {};
+
+	// Act
+	auto compressed = compress<compression::static_json>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<compression::static_json>(std::move(compressed));
+
+	// Assert
+	EXPECT_EQ(decompressed.size(), 0);
+}
+
+TEST(algorithm_static_huffman, compress_decompress_all_bytes)
+{
+	// Arrange
+	bytes::stream::buffer_t input(4096);
+	for (std::size_t i = 0; i < input.size(); i++)
+		input[i] = static_cast<bytes::stream::byte_t>(i % 16 == 0 ? i / 16 : 0);
+
+	// Act
+	auto compressed = compress<compression::static_binary>(bytes::stream::buffer_t { input });
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::static_binary>(std::move(compressed));
+
+	// Assert
+	EXPECT_EQ(decompressed, input);
+	EXPECT_LT(compressed_size, input.size() / 4);
+}
+
+TEST(algorithm_static_huffman, store_mismatched_data)
+{
+	// Arrange - binary data is coded with long codes by the text profile, so it is stored
+	bytes::stream::buffer_t input(256);
+	for (std::size_t i = 0; i < input.size(); i++)
+		input[i] = static_cast<bytes::stream::byte_t>(i);
+
+	// Act
+	auto compressed = compress<compression::static_text>(bytes::stream::buffer_t { input });
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::static_text>(std::move(compressed));
+
+	// Assert
+	EXPECT_EQ(decompressed, input);
+	EXPECT_LE(compressed_size, input.size() + 3);
+}
+
+TEST(algorithm_static_huffman, decompress_truncated_header)
+{
+	// Arrange
+	bytes::stream input { bytes::stream::buffer_t { 0x7E, 0xFF } };
+	bytes::stream output {};
+
+	// Act
+	auto is_success = compression::static_text::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
+
+TEST(algorithm_static_huffman, smaller_than_huffman_for_small_json)
+{
+	// Arrange
+	const std::string input = { "{\"id\": 42, \"name\": \"user\", \"tags\": [\"a\", \"b\"]}" };
+
+	// Act
+	auto with_profile = compress<compression::static_json>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto with_huffman = compress<compression::huffman>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+
+	// Assert
+	EXPECT_LT(with_profile.size(), with_huffman.size());
+	EXPECT_LT(with_profile.size(), input.size());
+}
+
+TEST(algorithm_static_huffman, estimate)
+{
+	// Arrange
+	const std::string input = { "The estimate matches the output size for the same text, as the codes are fixed." };
+	bytes::stream stream { bytes::stream::buffer_t { input.cbegin(), input.cend() } };
+
+	// Act
+	auto estimated = compression::static_text::estimate(compression::histogram { stream });
+	auto compressed = compress<compression::static_text>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+
+	// Assert
+	EXPECT_EQ(estimated, compressed.size());
+}
@@ -0,0 +1,137 @@
+///////////////////////////////////////////////////////////////////////
+// Tests of the stride filters
+///////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+#include <compression/compression.h>
+#include <compression/huffman.h>
+#include <compression/pipeline.h>
+#include <compression/stride_filter.h>
+
+namespace
+{
+	using byte = bytes::stream::byte_t;
+
+	// Telemetry records of a 32-bit counter, a slowly changing 32-bit value and a float
+	bytes::stream::buffer_t records(std::size_t count)
+	{
+		bytes::stream::buffer_t result(count * 12);
+		std::uint32_t random { 1 };
+		std::uint32_t value { 100000 };
+		for (std::size_t i = 0; i < count; i++)
+		{
+			random = random * 1103515245 + 12345;
+			value += (random >> 16) % 5;
+			auto counter = static_cast<std::uint32_t>(i);
+			auto reading = 20.0f + static_cast<float>(i % 64) / 4.0f;
+
+			std::memcpy(result.data() + i * 12, &counter, 4);
+			std::memcpy(result.data() + i * 12 + 4, &value, 4);
+			std::memcpy(result.data() + i * 12 + 8, &reading, 4);
+		}
+
+		return result;
+	}
+
+	// Encode and decode with a filter, in chunks of the given size
+	std::vector<byte> round_trip(compression::stride_filter& encoder, const std::vector<byte>& data, std::size_t chunk)
+	{
+		std::vector<byte> encoded {};
+		for (std::size_t start = 0; start < data.size(); start += chunk)
+			encoder.encode(data.data() + start, std::min(chunk, data.size() - start), encoded);
+		encoder.finish_encode(encoded);
+
+		compression::stride_filter decoder {};
+		std::vector<byte> decoded {};
+		for (std::size_t start = 0; start < encoded.size(); start += chunk + 1)
+			EXPECT_TRUE(decoder.decode(encoded.data() + start, std::min(chunk + 1, encoded.size() - start), decoded));
+		EXPECT_TRUE(decoder.finish_decode(decoded));
+
+		return decoded;
+	}
+}
+
+static_assert(filter_stage<compression::delta>);
+static_assert(filter_stage<compression::xor_delta>);
+
+TEST(filter_stride, encode_decode_widths)
+{
+	// Arrange - a size that is no multiple of a block or element
+	auto input = records(5000);
+	input.push_back(42);
+
+	for (std::size_t width : { 1, 2, 4, 8 })
+	{
+		for (auto mode : { compression::stride_filter::mode::subtract, compression::stride_filter::mode::exclusive_or })
+		{
+			compression::options settings { .element_width = width, .stride = 24 };
+			compression::stride_filter encoder { mode, settings };
+
+			// Act
+			auto decoded = round_trip(encoder, input, 1000);
+
+			// Assert
+			EXPECT_EQ(decoded, input) << width;
+		}
+	}
+}
+
+TEST(filter_stride, encode_decode_empty)
+{
+	// Arrange
+	compression::options settings { .element_width = 4 };
+	compression::delta encoder { settings };
+
+	// Act
+	auto decoded = round_trip(encoder, {}, 1000);
+
+	// Assert
+	EXPECT_TRUE(decoded.empty());
+}
+
+TEST(filter_stride, detect_stride)
+{
+	// Arrange
+	auto input = records(2000);
+
+	// Act
+	auto stride = compression::stride_filter::detect(input.data(), input.size(), 4);
+
+	// Assert
+	EXPECT_EQ(stride, 3);
+}
+
+TEST(filter_stride, delta_huffman)
+{
+	// Arrange
+	using algorithm = compression::pipeline<compression::delta, compression::huffman>;
+	auto input = records(50000);
+	compression::options settings { .element_width = 4, .detect_stride = true };
+
+	// Act
+	auto compressed = compress<algorithm>(bytes::stream::buffer_t { input }, settings);
+	auto huffman_size = compress<compression::huffman>(bytes::stream::buffer_t { input }).size();
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<algorithm>(std::move(compressed));
+
+	// Assert
+	EXPECT_LT(compressed_size, huffman_size / 2);
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(filter_stride, decode_invalid_header)
+{
+	// Arrange - an element width of 3 bytes
+	std::vector<byte> input { 3, 1, 0, 0, 0 };
+	std::vector<byte> output {};
+	compression::stride_filter decoder {};
+
+	// Act
+	auto is_success = decoder.decode(input.data(), input.size(), output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
@@ -0,0 +1,215 @@
+///////////////////////////////////////////////////////////////////////
+// Tests of the tANS algorithm
+///////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <compression/ans.h>
+#include <compression/compression.h>
+#include <compression/huffman.h>
+#include <compression/stored.h>
+#include <compression/tans.h>
+#include <compression/histogram.h>
+
+TEST(algorithm_tans, compress_decompress_text)
+{
+	// Arrange
+	const std::string input = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+
+	// Act
+	auto compressed = compress<compression::tans>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<compression::tans>(std::move(compressed));
+
+	// Assert
+	bytes::stream::buffer_t expected { input.cbegin(), input.cend() };
+	EXPECT_EQ(decompressed, expected);
+}
+
+TEST(algorithm_tans, compress_decompress_full_range)
+{
+	// Arrange
+	std::vector<bytes::stream::byte_t> input {};
+	for (auto i = 0; i <= 255; i++)
+		input.push_back(static_cast<bytes::stream::byte_t>(i));
+
+	// Act
+	auto compressed = compress<compression::tans>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<compression::tans>(std::move(compressed));
+
+	// Assert
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_tans, compress_decompress_empty_range)
+{
+	// Arrange
+	std::vector<bytes::stream::byte_t> input {};
+
+	// Act
+	auto compressed = compress<compression::tans>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<compression::tans>(std::move(compressed));
+
+	// Assert
+	EXPECT_EQ(decompressed.size(), 0);
+}
+
+TEST(algorithm_tans, single_symbol)
+{
+	// Arrange
+	bytes::stream::buffer_t input(1000, 'a');
+
+	// Act
+	auto compressed = compress<compression::tans>(bytes::stream::buffer_t { input });
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::tans>(std::move(compressed));
+
+	// Assert
+	EXPECT_LT(compressed_size, 12);
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_tans, skewed_beats_huffman)
+{
+	// Arrange - one value dominates, which Huffman cannot code in less than a bit
+	bytes::stream::buffer_t input {};
+	for (auto i = 0; i < 100000; i++)
+		input.push_back(static_cast<bytes::stream::byte_t>(i % 37 == 0 ? i % 11 : 0));
+	for (auto i = 0; i <= 255; i++)
+		input.push_back(static_cast<bytes::stream::byte_t>(i));
+
+	// Act
+	auto compressed = compress<compression::tans>(bytes::stream::buffer_t { input });
+	auto huffman_size = compress<compression::huffman>(bytes::stream::buffer_t { input }).size();
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::tans>(std::move(compressed));
+
+	// Assert
+	EXPECT_LT(compressed_size, huffman_size * 3 / 4);
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_tans, decompress_truncated)
+{
+	// Arrange
+	const std::string text = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+	auto compressed = compress<compression::tans>(bytes::stream::buffer_t { text.cbegin(), text.cend() });
+	compressed.resize(compressed.size() / 2);
+
+	bytes::stream input { std::move(compressed) };
+	bytes::stream output {};
+
+	// Act
+	auto is_success = compression::tans::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
+
+TEST(algorithm_tans, decompress_truncated_header)
+{
+	// Arrange
+	bytes::stream input { bytes::stream::buffer_t { 0x7E, 0xFF } };
+	bytes::stream output {};
+
+	// Act
+	auto is_success = compression::tans::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
+
+TEST(algorithm_tans, decompress_impossible_count)
+{
+	// Arrange - a header of two values, where every value takes some bits, claiming far more values than the bits allow
+	compression::histogram freqs {};
+	freqs.add('a', 3);
+	freqs.add('b', 1);
+
+	bytes::stream input {};
+	compression::stored::put_encoded(input);
+	input.put_size(std::size_t { 1 } << 40);
+	compression::ans::put_frequencies(input, compression::ans::normalize(freqs));
+	input.put_word(0, compression::ans::table_log);
+	input.put_word(0, 64);
+	input.seek(0);
+
+	bytes::stream output {};
+
+	// Act
+	auto is_success = compression::tans::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+	EXPECT_EQ(output.buffer().size(), 0);
+}
+
+TEST(algorithm_tans, decompress_single_value_count)
+{
+	// Arrange - a header of a single value with every state, which reads values without bits, claiming 2^36 values
+	bytes::stream input {};
+	compression::stored::put_encoded(input);
+	input.put_size(std::size_t { 1 } << 36);
+	input.put_word(1, 9);
+	input.put_word('a', 8);
+	input.put_word(0, compression::ans::table_log);
+	input.seek(0);
+
+	bytes::stream output {};
+
+	// Act
+	auto is_success = compression::tans::decompress(input, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+	EXPECT_EQ(output.buffer().size(), 0);
+}
+
+TEST(algorithm_tans, compress_decompress_long_single_symbol)
+{
+	// Arrange
+	bytes::stream::buffer_t input(1 << 20, 'a');
+
+	// Act
+	auto compressed = compress<compression::tans>(bytes::stream::buffer_t { input });
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::tans>(std::move(compressed));
+
+	// Assert
+	EXPECT_LT(compressed_size, 128);
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_tans, compress_incompressible)
+{
+	// Arrange - every byte value occurs equally often
+	std::vector<bytes::stream::byte_t> input {};
+	for (auto i = 0; i < 4096; i++)
+		input.push_back(static_cast<bytes::stream::byte_t>((i * 167) ^ (i >> 8)));
+
+	// Act
+	auto compressed = compress<compression::tans>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto compressed_size = compressed.size();
+	auto decompressed = decompress<compression::tans>(std::move(compressed));
+
+	// Assert
+	EXPECT_LE(compressed_size, input.size() + 3);
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_tans, estimate)
+{
+	// Arrange
+	const std::string text = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+	bytes::stream::buffer_t input {};
+	for (auto i = 0; i < 200; i++)
+		input.insert(input.end(), text.cbegin(), text.cend());
+
+	// Act
+	auto estimate = compression::tans::estimate(compression::histogram { bytes::stream { input } });
+	auto compressed = compress<compression::tans>(std::move(input));
+
+	// Assert - within 1% of the actual size
+	EXPECT_LT(compressed.size(), 200 * text.size());
+	EXPECT_NEAR(static_cast<double>(estimate), static_cast<double>(compressed.size()), compressed.size() * 0.01);
+}
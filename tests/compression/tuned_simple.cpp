@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////
+// Tests of the tuned simple algorithm
+///////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <compression/compression.h>
+#include <compression/tuned_simple.h>
+
+TEST(algorithm_tuned_simple, compress_decompress_text)
+{
+	// Arrange
+	const std::string input = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+
+	// Act
+	auto compressed = compress<compression::tuned_simple>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<compression::tuned_simple>(std::move(compressed));
+
+	// Assert
+	bytes::stream::buffer_t expected { input.cbegin(), input.cend() };
+	EXPECT_EQ(decompressed, expected);
+}
+
+TEST(algorithm_tuned_simple, compress_decompress_full_range)
+{
+	// Arrange
+	std::vector<bytes::stream::byte_t> input {};
+	for (auto i = 0; i <= 255; i++)
+		input.push_back(static_cast<bytes::stream::byte_t>(i));
+
+	// Act
+	auto compressed = compress<compression::tuned_simple>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<compression::tuned_simple>(std::move(compressed));
+
+	// Assert
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_tuned_simple, compress_decompress_empty_range)
+{
+	// Arrange
+	std::vector<bytes::stream::byte_t> input {};
+
+	// Act
+	auto compressed = compress<compression::tuned_simple>(bytes::stream::buffer_t { input.cbegin(), input.cend() });
+	auto decompressed = decompress<compression::tuned_simple>(std::move(compressed));
+
+	// Assert
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(algorithm_tuned_simple, best_choice)
+{
+	// Arrange - one dominant byte value favours the shortest short symbols
+	std::vector<bytes::stream::byte_t> dominant(4000, 'a');
+	for (auto i = 0; i < 4000; i += 50)
+		dominant[i] = static_cast<bytes::stream::byte_t>(i);
+
+	// About 30 equally frequent byte values fit the 5 bit short symbols
+	std::vector<bytes::stream::byte_t> uniform {};
+	for (auto i = 0; i < 4000; i++)
+		uniform.push_back(static_cast<bytes::stream::byte_t>('A' + i % 30));
+
+	// Act
+	auto dominant_choice = compression::tuned_simple::best_choice(compression::histogram { bytes::stream { dominant } });
+	auto uniform_choice = compression::tuned_simple::best_choice(compression::histogram { bytes::stream { uniform } });
+
+	// Assert
+	EXPECT_EQ(dominant_choice, 0);
+	EXPECT_EQ(uniform_choice, 4);
+}
+
+TEST(algorithm_tuned_simple, smaller_than_fixed_sizes)
+{
+	// Arrange
+	const std::string text = { "The quick brown fox jumps over the lazy dog. " };
+	bytes::stream::buffer_t input {};
+	for (auto i = 0; i < 50; i++)
+		input.insert(input.end(), text.cbegin(), text.cend());
+
+	// Act
+	auto estimate = compression::tuned_simple::estimate(compression::histogram { bytes::stream { input } });
+	auto tuned = compress<compression::tuned_simple>(bytes::stream::buffer_t { input });
+	std::vector<std::size_t> fixed
+	{
+		compress<compression::simple2>(bytes::stream::buffer_t { input }).size(),
+		compress<compression::simple3>(bytes::stream::buffer_t { input }).size(),
+		compress<compression::simple4>(bytes::stream::buffer_t { input }).size(),
+		compress<compression::simple5>(bytes::stream::buffer_t { input }).size(),
+		compress<compression::simple6>(bytes::stream::buffer_t { input }).size(),
+		compress<compression::simple7>(bytes::stream::buffer_t { input }).size()
+	};
+
+	// Assert
+	EXPECT_EQ(estimate, tuned.size());
+	for (auto size : fixed)
+		EXPECT_LE(tuned.size(), size + 1);
+	EXPECT_EQ(decompress<compression::tuned_simple>(std::move(tuned)), input);
+}
@@ -0,0 +1,23 @@
+///////////////////////////////////////////////////////////////////////
+// Test data shared by the tests
+///////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <string>
+
+namespace test_data
+{
+	// Lines of text of some length, as a string or as a buffer of bytes
+	template <typename Result = std::string>
+	Result lines(std::size_t count)
+	{
+		Result result {};
+		for (std::size_t i = 0; i < count; i++)
+		{
+			auto line = "line " + std::to_string(i) + ": the quick brown fox jumps over the lazy dog\n";
+			result.insert(result.end(), line.cbegin(), line.cend());
+		}
+
+		return result;
+	}
+}
@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////////
+// Tests of the batch runner
+///////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+
+#include <utility/batch_runner.h>
+
+#include <test_data.h>
+
+namespace
+{
+	namespace fs = std::filesystem;
+
+	// Directory in the temporary directory, unique per process and test
+	fs::path directory(const std::string& name)
+	{
+		auto result = fs::path { ::testing::TempDir() } / ("p3_" + std::to_string(::getpid()) + "_" + name);
+		fs::remove_all(result);
+		return result;
+	}
+
+	void write_file(const fs::path& path, const std::string& contents)
+	{
+		fs::create_directories(path.parent_path());
+		std::ofstream { path, std::ios::binary } << contents;
+	}
+
+	std::string read_file(const fs::path& path)
+	{
+		std::ifstream file { path, std::ios::binary };
+		return std::string { std::istreambuf_iterator<char> { file }, std::istreambuf_iterator<char> {} };
+	}
+
+	bool run(const char* mode, const fs::path& input, const fs::path& output, std::size_t threads, std::string& report)
+	{
+		const int argc = 5;
+		const char* argv[argc] { "p3run", "-m", mode, "-a", "huffman" };
+		utility::runsettings settings { argc, argv };
+
+		std::ostringstream stream {};
+		auto is_success = utility::batch_runner::run(settings, input, output, threads, 4096, stream);
+		report = stream.str();
+		return is_success;
+	}
+}
+
+TEST(utility_batch_runner, compress_decompress_tree)
+{
+	// Arrange - a file of many blocks, small files in subdirectories and an empty file
+	auto root = directory("tree");
+	write_file(root / "in" / "large.txt", test_data::lines(5000));
+	write_file(root / "in" / "a" / "small.txt", test_data::lines(3));
+	write_file(root / "in" / "a" / "b" / "other.txt", test_data::lines(100));
+	write_file(root / "in" / "empty.txt", "");
+
+	// Act
+	std::string compress_report {};
+	auto is_compressed = run("compress", root / "in", root / "compressed", 3, compress_report);
+	std::string decompress_report {};
+	auto is_decompressed = run("decompress", root / "compressed", root / "out", 2, decompress_report);
+
+	// Assert
+	EXPECT_TRUE(is_compressed);
+	EXPECT_TRUE(is_decompressed);
+	EXPECT_LT(fs::file_size(root / "compressed" / "large.txt"), fs::file_size(root / "in" / "large.txt"));
+	for (auto name : { "large.txt", "a/small.txt", "a/b/other.txt", "empty.txt" })
+		EXPECT_EQ(read_file(root / "out" / name), read_file(root / "in" / name)) << name;
+
+	EXPECT_NE(compress_report.find("Total: 4 files"), std::string::npos);
+	EXPECT_NE(compress_report.find("large.txt: "), std::string::npos);
+	fs::remove_all(root);
+}
+
+TEST(utility_batch_runner, compress_decompress_large_file)
+{
+	// Arrange - one file of far more blocks than the workers may start before writing them
+	auto root = directory("large");
+	write_file(root / "in" / "large.txt", test_data::lines(20000));
+
+	// Act
+	std::string report {};
+	auto is_compressed = run("compress", root / "in", root / "compressed", 8, report);
+	auto is_decompressed = run("decompress", root / "compressed", root / "out", 8, report);
+
+	// Assert
+	EXPECT_TRUE(is_compressed);
+	EXPECT_TRUE(is_decompressed);
+	EXPECT_EQ(read_file(root / "out" / "large.txt"), read_file(root / "in" / "large.txt"));
+	fs::remove_all(root);
+}
+
+TEST(utility_batch_runner, fail_on_invalid_file)
+{
+	// Arrange
+	auto root = directory("invalid");
+	write_file(root / "in" / "valid.txt", test_data::lines(100));
+	std::string report {};
+	run("compress", root / "in", root / "compressed", 2, report);
+	write_file(root / "compressed" / "invalid.txt", "not compressed data");
+
+	// Act
+	auto is_success = run("decompress", root / "compressed", root / "out", 2, report);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+	EXPECT_NE(report.find("invalid.txt: failed"), std::string::npos);
+	EXPECT_EQ(read_file(root / "out" / "valid.txt"), read_file(root / "in" / "valid.txt"));
+	fs::remove_all(root);
+}
@@ -0,0 +1,128 @@
+///////////////////////////////////////////////////////////////////////
+// Tests of the parallel runner
+///////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+#include <utility/block_frame.h>
+#include <utility/parallel_runner.h>
+
+#include <test_data.h>
+
+namespace
+{
+	// Run the arguments on the data in blocks of 4 KB
+	std::string run(const std::string& data, const char* mode, const char* algorithm, std::size_t threads, bool& is_success)
+	{
+		const int argc = 5;
+		const char* argv[argc] { "p3run", "-m", mode, "-a", algorithm };
+		utility::runsettings settings { argc, argv };
+
+		std::istringstream input { data };
+		std::ostringstream output {};
+		is_success = utility::parallel_runner::run(settings, input, output, threads, 4096);
+		return output.str();
+	}
+}
+
+TEST(utility_parallel_runner, compress_decompress)
+{
+	// Arrange
+	auto text = test_data::lines(3000);
+
+	// Act
+	auto is_compressed = false;
+	auto compressed = run(text, "compress", "huffman", 4, is_compressed);
+	auto is_decompressed = false;
+	auto decompressed = run(compressed, "decompress", "huffman", 3, is_decompressed);
+
+	// Assert
+	EXPECT_TRUE(is_compressed);
+	EXPECT_TRUE(is_decompressed);
+	EXPECT_LT(compressed.size(), text.size());
+	EXPECT_EQ(decompressed, text);
+}
+
+TEST(utility_parallel_runner, same_output_for_any_number_of_threads)
+{
+	// Arrange
+	auto text = test_data::lines(1000);
+
+	// Act
+	auto is_success = false;
+	auto single = run(text, "compress", "rle+simple5", 1, is_success);
+	auto several = run(text, "compress", "rle+simple5", 5, is_success);
+
+	// Assert
+	EXPECT_TRUE(is_success);
+	EXPECT_EQ(single, several);
+}
+
+TEST(utility_parallel_runner, compress_decompress_empty_input)
+{
+	// Act
+	auto is_compressed = false;
+	auto compressed = run({}, "compress", "auto", 2, is_compressed);
+	auto is_decompressed = false;
+	auto decompressed = run(compressed, "decompress", "auto", 2, is_decompressed);
+
+	// Assert
+	EXPECT_TRUE(is_compressed);
+	EXPECT_TRUE(is_decompressed);
+	EXPECT_EQ(decompressed.size(), 0);
+}
+
+TEST(utility_parallel_runner, fail_on_truncated_input)
+{
+	// Arrange
+	auto text = test_data::lines(1000);
+	auto is_success = false;
+	auto compressed = run(text, "compress", "lz_fast", 2, is_success);
+	compressed.resize(compressed.size() - 100);
+
+	// Act
+	auto decompressed = run(compressed, "decompress", "lz_fast", 2, is_success);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+	EXPECT_EQ(decompressed, text.substr(0, decompressed.size()));
+}
+
+TEST(utility_parallel_runner, block_size_for_memory_limit)
+{
+	// Act
+	auto small = utility::parallel_runner::block_size(std::size_t { 1 } << 20, 64);
+	auto medium = utility::parallel_runner::block_size(std::size_t { 64 } << 20, 4);
+	auto large = utility::parallel_runner::block_size(std::size_t { 64 } << 30, 1);
+
+	// Assert - the blocks of all workers fit the limit, within the range of block sizes
+	EXPECT_EQ(small, utility::parallel_runner::min_block_size);
+	EXPECT_LE(medium * 4 * 8, std::size_t { 64 } << 20);
+	EXPECT_GE(medium, std::size_t { 1 } << 20);
+	EXPECT_EQ(large, utility::block_frame::max_block_size);
+}
+
+TEST(utility_parallel_runner, compress_decompress_with_max_memory)
+{
+	// Arrange - blocks of 4 KB, as 1 MB is shared by 32 workers
+	auto text = test_data::lines(2000);
+	const int argc = 9;
+	const char* compress_argv[argc] { "p3run", "-m", "compress", "-a", "lz77", "-t", "32", "--max-memory", "1M" };
+	const char* decompress_argv[argc] { "p3run", "-m", "decompress", "-a", "lz77", "-t", "32", "--max-memory", "1M" };
+	utility::runsettings compress_settings { argc, compress_argv };
+	utility::runsettings decompress_settings { argc, decompress_argv };
+
+	// Act
+	std::istringstream input { text };
+	std::stringstream compressed {};
+	auto is_compressed = utility::parallel_runner::run(compress_settings, input, compressed);
+	std::ostringstream output {};
+	auto is_decompressed = utility::parallel_runner::run(decompress_settings, compressed, output);
+
+	// Assert
+	EXPECT_TRUE(is_compressed);
+	EXPECT_TRUE(is_decompressed);
+	EXPECT_EQ(output.str(), text);
+}
@@ -3,6 +3,9 @@
 ///////////////////////////////////////////////////////////////////////
 #include <gtest/gtest.h>
 
+#include <fstream>
+#include <string>
+
 #include <utility/runsettings.h>
 
 namespace
@@ -116,3 +119,461 @@ TEST(utility_runsettings, set_algorithm_huffman)
 	EXPECT_EQ(settings.algorithm(), rs::settings::algorithm::huffman);
 	EXPECT_TRUE(settings.valid());
 }
+
+TEST(utility_runsettings, set_algorithm_auto)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "-a", "auto" };
+	rs settings { argc, argv };
+
+	EXPECT_EQ(settings.algorithm(), rs::settings::algorithm::automatic);
+	EXPECT_TRUE(settings.valid());
+}
+
+TEST(utility_runsettings, set_speed)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "-s", "7" };
+	rs settings { argc, argv };
+
+	EXPECT_EQ(settings.speed(), 7);
+	EXPECT_TRUE(settings.valid());
+}
+
+TEST(utility_runsettings, set_threads)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "-t", "8" };
+	rs settings { argc, argv };
+
+	EXPECT_EQ(settings.threads(), 8);
+	EXPECT_TRUE(settings.valid());
+}
+
+TEST(utility_runsettings, fail_on_invalid_threads)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "-t", "0" };
+	rs settings { argc, argv };
+
+	EXPECT_FALSE(settings.valid());
+}
+
+TEST(utility_runsettings, set_max_memory)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "--max-memory", "256M" };
+	rs settings { argc, argv };
+
+	EXPECT_EQ(settings.max_memory(), std::size_t { 256 } << 20);
+	EXPECT_TRUE(settings.valid());
+}
+
+TEST(utility_runsettings, fail_on_invalid_max_memory)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "--max-memory", "12X" };
+	rs settings { argc, argv };
+
+	EXPECT_FALSE(settings.valid());
+}
+
+TEST(utility_runsettings, fail_on_max_memory_with_train)
+{
+	const int argc = 7;
+	const char* argv[argc] { "p3run", "-m", "train", "-a", "huffman", "--max-memory", "1G" };
+	rs settings { argc, argv };
+
+	EXPECT_FALSE(settings.valid());
+}
+
+TEST(utility_runsettings, set_connect_forwarding_arguments)
+{
+	const int argc = 7;
+	const char* argv[argc] { "p3run", "-m", "decompress", "--connect", "/tmp/p3.sock", "-a", "huffman" };
+	rs settings { argc, argv };
+
+	const std::vector<std::string> expected { "-m", "decompress", "-a", "huffman" };
+	EXPECT_EQ(settings.connect_path(), "/tmp/p3.sock");
+	EXPECT_EQ(settings.arguments(), expected);
+	EXPECT_TRUE(settings.valid());
+}
+
+TEST(utility_runsettings, fail_on_serve_with_connect)
+{
+	const int argc = 5;
+	const char* argv[argc] { "p3run", "--serve", "/tmp/p3.sock", "--connect", "/tmp/p3.sock" };
+	rs settings { argc, argv };
+
+	EXPECT_FALSE(settings.valid());
+}
+
+TEST(utility_runsettings, set_trees)
+{
+	const int argc = 5;
+	const char* argv[argc] { "p3run", "-r", "in/", "-o", "out/" };
+	rs settings { argc, argv };
+
+	EXPECT_EQ(settings.input_tree(), "in/");
+	EXPECT_EQ(settings.output_tree(), "out/");
+	EXPECT_TRUE(settings.valid());
+}
+
+TEST(utility_runsettings, fail_on_input_tree_without_output)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "-r", "in/" };
+	rs settings { argc, argv };
+
+	EXPECT_FALSE(settings.valid());
+}
+
+TEST(utility_runsettings, fail_on_invalid_speed)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "-s", "10" };
+	rs settings { argc, argv };
+
+	EXPECT_FALSE(settings.valid());
+}
+
+TEST(utility_runsettings, automatic_round_trip)
+{
+	// Arrange
+	const std::string text = { "Hello world! This is a long test string that is being compressed and then decompressed by the algorithm..." };
+	bytes::stream::buffer_t input {};
+	for (auto i = 0; i < 20; i++)
+		input.insert(input.end(), text.cbegin(), text.cend());
+
+	const char* compress_argv[5] { "p3run", "-m", "compress", "-a", "auto" };
+	const char* decompress_argv[5] { "p3run", "-m", "decompress", "-a", "auto" };
+	rs compress_settings { 5, compress_argv };
+	rs decompress_settings { 5, decompress_argv };
+
+	// Act
+	bytes::stream::buffer_t compressed {};
+	bytes::stream::buffer_t decompressed {};
+	auto is_compressed = compress_settings.run(bytes::stream::buffer_t { input }, compressed);
+	auto is_decompressed = decompress_settings.run(bytes::stream::buffer_t { compressed }, decompressed);
+
+	// Assert
+	EXPECT_TRUE(is_compressed);
+	EXPECT_TRUE(is_decompressed);
+	EXPECT_EQ(compressed[0], static_cast<bytes::stream::byte_t>(compress_settings.choose(input)));
+	EXPECT_LT(compressed.size(), input.size());
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(utility_runsettings, automatic_choice)
+{
+	// Arrange
+	bytes::stream::buffer_t uniform {};
+	for (auto i = 0; i < 4096; i++)
+		uniform.push_back(static_cast<bytes::stream::byte_t>(i));
+
+	bytes::stream::buffer_t skewed {};
+	for (auto i = 0; i < 8; i++)
+		skewed.insert(skewed.end(), std::size_t { 2048 } >> std::min(i, 6), static_cast<bytes::stream::byte_t>('a' + i));
+
+	const char* argv[3] { "p3run", "-a", "auto" };
+	rs settings { 3, argv };
+
+	// Act / Assert
+	EXPECT_EQ(settings.choose(uniform), rs::settings::algorithm::identity);
+	EXPECT_EQ(settings.choose(skewed), rs::settings::algorithm::tans);
+}
+
+TEST(utility_runsettings, set_algorithm_simple)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "-a", "simple" };
+	rs settings { argc, argv };
+
+	EXPECT_EQ(settings.algorithm(), rs::settings::algorithm::simple);
+	EXPECT_TRUE(settings.valid());
+}
+
+TEST(utility_runsettings, set_level)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "-l", "2" };
+	rs settings { argc, argv };
+
+	EXPECT_EQ(settings.level(), 2);
+	EXPECT_TRUE(settings.valid());
+}
+
+TEST(utility_runsettings, fail_on_invalid_level)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "-l", "0" };
+	rs settings { argc, argv };
+
+	EXPECT_FALSE(settings.valid());
+}
+
+TEST(utility_runsettings, set_algorithm_adaptive)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "-a", "adaptive" };
+	rs settings { argc, argv };
+
+	EXPECT_EQ(settings.algorithm(), rs::settings::algorithm::adaptive_huffman);
+	EXPECT_TRUE(settings.valid());
+}
+
+TEST(utility_runsettings, set_algorithm_tans)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "-a", "tans" };
+	rs settings { argc, argv };
+
+	EXPECT_EQ(settings.algorithm(), rs::settings::algorithm::tans);
+	EXPECT_TRUE(settings.valid());
+}
+
+TEST(utility_runsettings, set_algorithm_order1)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "-a", "order1" };
+	rs settings { argc, argv };
+
+	EXPECT_EQ(settings.algorithm(), rs::settings::algorithm::order1);
+	EXPECT_TRUE(settings.valid());
+}
+
+TEST(utility_runsettings, set_algorithm_lz77)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "-a", "lz77" };
+	rs settings { argc, argv };
+
+	EXPECT_EQ(settings.algorithm(), rs::settings::algorithm::lz77);
+	EXPECT_TRUE(settings.valid());
+}
+
+TEST(utility_runsettings, set_algorithm_lz_fast)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "-a", "lz_fast" };
+	rs settings { argc, argv };
+
+	EXPECT_EQ(settings.algorithm(), rs::settings::algorithm::lz_fast);
+	EXPECT_TRUE(settings.valid());
+}
+
+TEST(utility_runsettings, set_algorithm_bwt)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "-a", "bwt" };
+	rs settings { argc, argv };
+
+	EXPECT_EQ(settings.algorithm(), rs::settings::algorithm::bwt);
+	EXPECT_TRUE(settings.valid());
+}
+
+TEST(utility_runsettings, set_algorithm_static_json)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "-a", "static_json" };
+	rs settings { argc, argv };
+
+	EXPECT_EQ(settings.algorithm(), rs::settings::algorithm::static_json);
+	EXPECT_TRUE(settings.valid());
+}
+
+TEST(utility_runsettings, set_filtered_algorithm)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "-a", "rle+simple5" };
+	rs settings { argc, argv };
+
+	EXPECT_EQ(settings.filter(), rs::settings::filter::rle);
+	EXPECT_EQ(settings.algorithm(), rs::settings::algorithm::simple5);
+	EXPECT_TRUE(settings.valid());
+}
+
+TEST(utility_runsettings, fail_on_invalid_filter)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "-a", "nothing+simple5" };
+	rs settings { argc, argv };
+
+	EXPECT_FALSE(settings.valid());
+}
+
+TEST(utility_runsettings, fail_on_filtered_automatic)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "-a", "rle+auto" };
+	rs settings { argc, argv };
+
+	EXPECT_FALSE(settings.valid());
+}
+
+TEST(utility_runsettings, set_stride)
+{
+	const int argc = 7;
+	const char* argv[argc] { "p3run", "-a", "delta+huffman", "--width", "4", "--stride", "12" };
+	rs settings { argc, argv };
+
+	EXPECT_EQ(settings.filter(), rs::settings::filter::delta);
+	EXPECT_EQ(settings.options().element_width, 4);
+	EXPECT_EQ(settings.options().stride, 12);
+	EXPECT_FALSE(settings.options().detect_stride);
+	EXPECT_TRUE(settings.valid());
+}
+
+TEST(utility_runsettings, set_stride_auto)
+{
+	const int argc = 7;
+	const char* argv[argc] { "p3run", "-a", "xor+huffman", "--width", "8", "--stride", "auto" };
+	rs settings { argc, argv };
+
+	EXPECT_EQ(settings.filter(), rs::settings::filter::xor_delta);
+	EXPECT_TRUE(settings.options().detect_stride);
+	EXPECT_TRUE(settings.valid());
+}
+
+TEST(utility_runsettings, fail_on_invalid_width)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "--width", "3" };
+	rs settings { argc, argv };
+
+	EXPECT_FALSE(settings.valid());
+}
+
+TEST(utility_runsettings, fail_on_partial_element_stride)
+{
+	const int argc = 5;
+	const char* argv[argc] { "p3run", "--stride", "6", "--width", "4" };
+	rs settings { argc, argv };
+
+	EXPECT_FALSE(settings.valid());
+}
+
+TEST(utility_runsettings, set_dedup)
+{
+	const int argc = 4;
+	const char* argv[argc] { "p3run", "-a", "huffman", "--dedup" };
+	rs settings { argc, argv };
+
+	EXPECT_TRUE(settings.dedup());
+	EXPECT_TRUE(settings.valid());
+}
+
+TEST(utility_runsettings, fail_on_automatic_dedup)
+{
+	const int argc = 4;
+	const char* argv[argc] { "p3run", "--dedup", "-a", "auto" };
+	rs settings { argc, argv };
+
+	EXPECT_FALSE(settings.valid());
+}
+
+TEST(utility_runsettings, run_filtered_algorithm)
+{
+	// Arrange
+	const int argc = 5;
+	const char* compress_argv[argc] { "p3run", "-m", "compress", "-a", "rle+huffman" };
+	const char* decompress_argv[argc] { "p3run", "-m", "decompress", "-a", "rle+huffman" };
+	rs compress_settings { argc, compress_argv };
+	rs decompress_settings { argc, decompress_argv };
+
+	const std::string text = std::string(1000, 'a') + "bccd";
+	bytes::stream::buffer_t input { text.cbegin(), text.cend() };
+
+	// Act
+	bytes::stream::buffer_t compressed {};
+	bytes::stream::buffer_t decompressed {};
+	auto is_compressed = compress_settings.run(bytes::stream::buffer_t { input }, compressed);
+	auto compressed_size = compressed.size();
+	auto is_decompressed = decompress_settings.run(std::move(compressed), decompressed);
+
+	// Assert
+	EXPECT_TRUE(is_compressed);
+	EXPECT_TRUE(is_decompressed);
+	EXPECT_LT(compressed_size, 20);
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(utility_runsettings, fail_on_run_with_invalid_input)
+{
+	// Arrange
+	const int argc = 5;
+	const char* argv[argc] { "p3run", "-m", "decompress", "-a", "huffman" };
+	rs settings { argc, argv };
+
+	// Act
+	bytes::stream::buffer_t output {};
+	auto is_success = settings.run(bytes::stream::buffer_t { 0x7E, 0xFF }, output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
+
+TEST(utility_runsettings, set_mode_train)
+{
+	const int argc = 5;
+	const char* argv[argc] { "p3run", "-m", "train", "-a", "huffman" };
+	rs settings { argc, argv };
+
+	EXPECT_EQ(settings.mode(), rs::settings::mode::train);
+	EXPECT_TRUE(settings.valid());
+}
+
+TEST(utility_runsettings, fail_on_train_without_table)
+{
+	const int argc = 5;
+	const char* argv[argc] { "p3run", "-m", "train", "-a", "lz77" };
+	rs settings { argc, argv };
+
+	EXPECT_FALSE(settings.valid());
+}
+
+TEST(utility_runsettings, fail_on_missing_dictionary)
+{
+	const int argc = 3;
+	const char* argv[argc] { "p3run", "--dict", "/nonexistent/p3.dict" };
+	rs settings { argc, argv };
+
+	EXPECT_FALSE(settings.valid());
+}
+
+TEST(utility_runsettings, run_with_dictionary)
+{
+	// Arrange
+	const std::string corpus_text { "the quick brown fox jumps over the lazy dog, again and again and again" };
+	const int train_argc = 5;
+	const char* train_argv[train_argc] { "p3run", "-m", "train", "-a", "simple" };
+	rs train_settings { train_argc, train_argv };
+	bytes::stream::buffer_t dictionary {};
+	EXPECT_TRUE(train_settings.run(bytes::stream::buffer_t { corpus_text.cbegin(), corpus_text.cend() }, dictionary));
+
+	auto path = testing::TempDir() + "p3_runsettings.dict";
+	std::ofstream { path, std::ios::binary }.write(reinterpret_cast<const char*>(dictionary.data()), static_cast<std::streamsize>(dictionary.size()));
+
+	const int argc = 5;
+	const char* compress_argv[argc] { "p3run", "-m", "compress", "--dict", path.c_str() };
+	const char* decompress_argv[argc] { "p3run", "-m", "decompress", "--dict", path.c_str() };
+	rs compress_settings { argc, compress_argv };
+	rs decompress_settings { argc, decompress_argv };
+
+	const std::string text { "the lazy dog jumps over the quick brown fox, and again" };
+	bytes::stream::buffer_t input { text.cbegin(), text.cend() };
+
+	// Act
+	bytes::stream::buffer_t compressed {};
+	bytes::stream::buffer_t decompressed {};
+	auto is_compressed = compress_settings.run(bytes::stream::buffer_t { input }, compressed);
+	auto compressed_size = compressed.size();
+	auto is_decompressed = decompress_settings.run(std::move(compressed), decompressed);
+
+	// Assert
+	EXPECT_TRUE(is_compressed);
+	EXPECT_TRUE(is_decompressed);
+	EXPECT_TRUE(compress_settings.dictionary().has_value());
+	EXPECT_LT(compressed_size, input.size());
+	EXPECT_EQ(decompressed, input);
+}
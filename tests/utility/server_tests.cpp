@@ -0,0 +1,131 @@
+///////////////////////////////////////////////////////////////////////
+// Tests of the server
+///////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <utility/server.h>
+
+#include <test_data.h>
+
+namespace
+{
+	using buffer_t = bytes::stream::buffer_t;
+
+	// Socket in the temporary directory, unique per process and test
+	std::string socket_path(const std::string& name)
+	{
+		return ::testing::TempDir() + "p3_" + std::to_string(::getpid()) + "_" + name + ".sock";
+	}
+}
+
+TEST(utility_server, compress_decompress)
+{
+	// Arrange
+	auto path = socket_path("compress_decompress");
+	utility::server server { path, 2 };
+	auto input = test_data::lines<buffer_t>(500);
+
+	// Act
+	buffer_t compressed {};
+	auto is_compressed = utility::server::request(path, { "-m", "compress", "-a", "huffman" }, input, compressed);
+	buffer_t decompressed {};
+	auto is_decompressed = utility::server::request(path, { "-m", "decompress", "-a", "huffman" }, compressed, decompressed);
+
+	// Assert
+	EXPECT_TRUE(server.valid());
+	EXPECT_TRUE(is_compressed);
+	EXPECT_TRUE(is_decompressed);
+	EXPECT_LT(compressed.size(), input.size());
+	EXPECT_EQ(decompressed, input);
+}
+
+TEST(utility_server, concurrent_clients)
+{
+	// Arrange
+	auto path = socket_path("concurrent_clients");
+	utility::server server { path, 3 };
+	auto input = test_data::lines<buffer_t>(200);
+	std::vector<int> results(8, 0);
+
+	// Act
+	std::vector<std::thread> clients {};
+	for (std::size_t i = 0; i < results.size(); i++)
+	{
+		clients.emplace_back([&, i]()
+		{
+			for (auto k = 0; k < 10; k++)
+			{
+				buffer_t compressed {};
+				buffer_t decompressed {};
+				if (utility::server::request(path, { "-a", "rle+simple5" }, input, compressed) &&
+					utility::server::request(path, { "-m", "decompress", "-a", "rle+simple5" }, compressed, decompressed) &&
+					decompressed == input)
+					results[i]++;
+			}
+		});
+	}
+
+	for (auto& client : clients)
+		client.join();
+
+	// Assert
+	for (auto result : results)
+		EXPECT_EQ(result, 10);
+}
+
+TEST(utility_server, fail_on_invalid_arguments)
+{
+	// Arrange
+	auto path = socket_path("invalid_arguments");
+	utility::server server { path, 1 };
+
+	// Act
+	buffer_t output {};
+	auto is_invalid_algorithm = utility::server::request(path, { "-a", "unknown" }, test_data::lines<buffer_t>(1), output);
+	auto is_blocks = utility::server::request(path, { "-a", "huffman", "-t", "2" }, test_data::lines<buffer_t>(1), output);
+	auto is_valid = utility::server::request(path, { "-a", "huffman" }, test_data::lines<buffer_t>(1), output);
+
+	// Assert
+	EXPECT_FALSE(is_invalid_algorithm);
+	EXPECT_FALSE(is_blocks);
+	EXPECT_TRUE(is_valid);
+}
+
+TEST(utility_server, fail_on_input_above_limit)
+{
+	// Arrange
+	auto path = socket_path("input_above_limit");
+	auto input = test_data::lines<buffer_t>(100);
+	utility::server server { path, 1, input.size() - 1 };
+
+	// Act
+	buffer_t output {};
+	auto is_above_limit = utility::server::request(path, { "-a", "huffman" }, input, output);
+	auto is_within_limit = utility::server::request(path, { "-a", "huffman" }, test_data::lines<buffer_t>(10), output);
+
+	// Assert
+	EXPECT_FALSE(is_above_limit);
+	EXPECT_TRUE(is_within_limit);
+}
+
+TEST(utility_server, fail_without_server)
+{
+	// Arrange
+	auto path = socket_path("stopped");
+	{
+		utility::server server { path, 1 };
+	}
+
+	// Act
+	buffer_t output {};
+	auto is_success = utility::server::request(path, { "-a", "huffman" }, test_data::lines<buffer_t>(1), output);
+
+	// Assert
+	EXPECT_FALSE(is_success);
+}
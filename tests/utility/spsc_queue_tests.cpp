@@ -0,0 +1,54 @@
+///////////////////////////////////////////////////////////////////////
+// Tests of the single-producer single-consumer queue
+///////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include <utility/spsc_queue.h>
+
+TEST(utility_spsc_queue, push_pop_in_order)
+{
+	// Arrange
+	utility::spsc_queue<int, 4> queue {};
+
+	// Act
+	queue.push(1);
+	queue.push(2);
+	queue.push(3);
+	auto first = queue.pop();
+	auto second = queue.pop();
+	queue.push(4);
+
+	// Assert
+	EXPECT_EQ(first, 1);
+	EXPECT_EQ(second, 2);
+	EXPECT_EQ(queue.pop(), 3);
+	EXPECT_EQ(queue.pop(), 4);
+}
+
+TEST(utility_spsc_queue, pass_between_threads)
+{
+	// Arrange - many more items than fit the queue, so that both sides wait
+	constexpr int count = 100000;
+	utility::spsc_queue<int, 8> queue {};
+	std::vector<int> received {};
+
+	// Act
+	std::thread consumer { [&]()
+	{
+		for (auto i = 0; i < count; i++)
+			received.push_back(queue.pop());
+	} };
+
+	for (auto i = 0; i < count; i++)
+		queue.push(i);
+
+	consumer.join();
+
+	// Assert
+	ASSERT_EQ(received.size(), count);
+	for (auto i = 0; i < count; i++)
+		EXPECT_EQ(received[i], i);
+}
@@ -0,0 +1,124 @@
+///////////////////////////////////////////////////////////////////////
+// Tests of the compressing stream buffers
+///////////////////////////////////////////////////////////////////////
+#include <gtest/gtest.h>
+
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include <utility/streambuf.h>
+
+#include <test_data.h>
+
+namespace
+{
+	using algorithm_t = utility::runsettings::settings::algorithm;
+
+	// Write the text through a compressing buffer, returning the compressed data
+	std::string compress_text(const std::string& text, algorithm_t algorithm, std::size_t block_size)
+	{
+		std::ostringstream compressed {};
+		{
+			utility::compressing_ostreambuf buffer { compressed, algorithm, {}, block_size };
+			std::ostream output { &buffer };
+			output << text;
+		}
+
+		return compressed.str();
+	}
+
+	// Read all text through a decompressing buffer
+	std::string decompress_text(const std::string& data, algorithm_t algorithm, bool& is_valid)
+	{
+		std::istringstream compressed { data };
+		utility::decompressing_istreambuf buffer { compressed, algorithm };
+		std::istream input { &buffer };
+
+		std::string result { std::istreambuf_iterator<char> { input }, std::istreambuf_iterator<char> {} };
+		is_valid = buffer.valid();
+		return result;
+	}
+}
+
+TEST(utility_streambuf, compress_decompress_blocks)
+{
+	// Arrange
+	auto text = test_data::lines(2000);
+
+	// Act
+	auto compressed = compress_text(text, algorithm_t::huffman, 4096);
+	auto is_valid = false;
+	auto decompressed = decompress_text(compressed, algorithm_t::huffman, is_valid);
+
+	// Assert
+	EXPECT_LT(compressed.size(), text.size());
+	EXPECT_TRUE(is_valid);
+	EXPECT_EQ(decompressed, text);
+}
+
+TEST(utility_streambuf, compress_decompress_automatic)
+{
+	// Arrange
+	auto text = test_data::lines(500);
+
+	// Act
+	auto compressed = compress_text(text, algorithm_t::automatic, 1000);
+	auto is_valid = false;
+	auto decompressed = decompress_text(compressed, algorithm_t::automatic, is_valid);
+
+	// Assert
+	EXPECT_TRUE(is_valid);
+	EXPECT_EQ(decompressed, text);
+}
+
+TEST(utility_streambuf, compress_decompress_empty_stream)
+{
+	// Act
+	auto compressed = compress_text({}, algorithm_t::lz77, 1024);
+	auto is_valid = false;
+	auto decompressed = decompress_text(compressed, algorithm_t::lz77, is_valid);
+
+	// Assert
+	EXPECT_EQ(compressed.size(), 0);
+	EXPECT_TRUE(is_valid);
+	EXPECT_EQ(decompressed.size(), 0);
+}
+
+TEST(utility_streambuf, flush_partial_block)
+{
+	// Arrange
+	std::ostringstream compressed {};
+	utility::compressing_ostreambuf buffer { compressed, algorithm_t::simple5 };
+	std::ostream output { &buffer };
+
+	// Act
+	output << "first part" << std::flush;
+	auto flushed = compressed.str().size();
+	output << ", second part" << std::flush;
+
+	auto is_valid = false;
+	auto decompressed = decompress_text(compressed.str(), algorithm_t::simple5, is_valid);
+
+	// Assert
+	EXPECT_GT(flushed, 0);
+	EXPECT_TRUE(is_valid);
+	EXPECT_EQ(decompressed, "first part, second part");
+}
+
+TEST(utility_streambuf, fail_on_truncated_block)
+{
+	// Arrange
+	auto text = test_data::lines(200);
+	auto compressed = compress_text(text, algorithm_t::huffman, 2048);
+	compressed.resize(compressed.size() - 10);
+
+	// Act
+	auto is_valid = true;
+	auto decompressed = decompress_text(compressed, algorithm_t::huffman, is_valid);
+
+	// Assert
+	EXPECT_FALSE(is_valid);
+	EXPECT_LT(decompressed.size(), text.size());
+	EXPECT_EQ(decompressed, text.substr(0, decompressed.size()));
+}